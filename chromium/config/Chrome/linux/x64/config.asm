@@ -202,6 +202,7 @@
 %define HAVE_ES2_GL_H 0
 %define HAVE_GSM_H 0
 %define HAVE_IO_H 0
+%define HAVE_LINUX_MMAN_H 1
 %define HAVE_MACH_MACH_TIME_H 0
 %define HAVE_MACHINE_IOCTL_BT848_H 0
 %define HAVE_MACHINE_IOCTL_METEOR_H 0
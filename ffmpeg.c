@@ -474,6 +474,16 @@ static void ffmpeg_cleanup(int ret)
 
     for (i = 0; i < nb_filtergraphs; i++) {
         FilterGraph *fg = filtergraphs[i];
+        if (do_benchmark && fg->graph) {
+            for (j = 0; j < fg->graph->nb_filters; j++) {
+                AVFilterContext *f = fg->graph->filters[j];
+                int64_t nb_activations, total_time;
+
+                avfilter_get_timing(f, &nb_activations, &total_time);
+                av_log(NULL, AV_LOG_INFO, "bench: filter %s: %"PRId64" activations, time=%0.3fs\n",
+                       f->name, nb_activations, total_time / 1000000.0);
+            }
+        }
         avfilter_graph_free(&fg->graph);
         for (j = 0; j < fg->nb_inputs; j++) {
             while (av_fifo_size(fg->inputs[j]->frame_queue)) {
@@ -600,6 +610,7 @@ static void ffmpeg_cleanup(int ret)
                    av_err2str(AVERROR(errno)));
     }
     av_freep(&vstats_filename);
+    av_freep(&filter_thread_type);
 
     av_freep(&input_streams);
     av_freep(&input_files);
@@ -1003,6 +1003,11 @@ int configure_filtergraph(FilterGraph *fg)
     if (!(fg->graph = avfilter_graph_alloc()))
         return AVERROR(ENOMEM);
 
+    if (filter_thread_type &&
+        (ret = av_opt_set(fg->graph, "thread_type", filter_thread_type, 0)) < 0)
+        goto fail;
+    av_opt_set_int(fg->graph, "timing", do_benchmark, 0);
+
     if (simple) {
         OutputStream *ost = fg->outputs[0]->ost;
         char args[512];
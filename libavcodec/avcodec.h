@@ -1975,7 +1975,12 @@ typedef struct AVCodecContext {
      * When multithreading is used, it may be called from multiple threads
      * at the same time; threads might draw different parts of the same AVFrame,
      * or multiple AVFrames, and there is no guarantee that slices will be drawn
-     * in order.
+     * in order. With frame threading, s is the context of the decoding thread,
+     * which shares opaque with the user context.
+     * Decoders which reorder frames and cannot draw them in display order only
+     * call it if SLICE_FLAG_CODED_ORDER is set in slice_flags or the stream
+     * has no reordering (has_b_frames is 0). The bands of frames which are not
+     * output are not drawn.
      * The function is also used by hardware acceleration APIs.
      * It is called at least once during frame decoding to pass
      * the data needed for hardware render.
@@ -3171,6 +3176,12 @@ typedef struct AVCodecContext {
     int thread_type;
 #define FF_THREAD_FRAME   1 ///< Decode more than one frame at once
 #define FF_THREAD_SLICE   2 ///< Decode more than one part of a single frame at once
+/**
+ * Decode more than one frame at once, returning each as soon as it is
+ * decoded instead of one frame per thread later. Only some decoders
+ * (h264) support it, others ignore this flag.
+ */
+#define FF_THREAD_FRAME_LOW_DELAY 4
 
     /**
      * Which multithreading methods are in use by the codec.
@@ -3644,6 +3655,18 @@ typedef struct AVCodecContext {
      *             AVCodecContext.get_format callback)
      */
     int hwaccel_flags;
+
+    /**
+     * Where the threads used for multithreading come from.
+     * With FF_THREAD_POOL_SHARED, thread_count sets how many frames or slices
+     * of this context are processed at once on a process-wide pool of
+     * threads, one per CPU core, shared by all contexts using it.
+     * - encoding: Set by user, before avcodec_open2().
+     * - decoding: Set by user, before avcodec_open2().
+     */
+    int thread_pool;
+#define FF_THREAD_POOL_PRIVATE 0 ///< Threads owned by this context
+#define FF_THREAD_POOL_SHARED  1 ///< Process-wide shared pool
 } AVCodecContext;
 
 AVRational av_codec_get_pkt_timebase         (const AVCodecContext *avctx);
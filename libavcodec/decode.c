@@ -375,6 +375,12 @@ static int decode_simple_internal(AVCodecContext *avctx, AVFrame *frame)
     if (!pkt->data && !avci->draining) {
         av_packet_unref(pkt);
         ret = ff_decode_get_packet(avctx, pkt);
+        /* low delay frame threads may still be decoding frames for which no
+         * more input is needed, wait for them */
+        if (ret == AVERROR(EAGAIN) && avci->receiving_frame &&
+            HAVE_THREADS && avctx->active_thread_type & FF_THREAD_FRAME &&
+            ff_thread_frames_pending(avctx))
+            ret = 0;
         if (ret < 0 && ret != AVERROR_EOF)
             return ret;
     }
@@ -699,7 +705,9 @@ int attribute_align_arg avcodec_receive_frame(AVCodecContext *avctx, AVFrame *fr
     if (avci->buffer_frame->buf[0]) {
         av_frame_move_ref(frame, avci->buffer_frame);
     } else {
+        avci->receiving_frame = 1;
         ret = decode_receive_frame_internal(avctx, frame);
+        avci->receiving_frame = 0;
         if (ret < 0)
             return ret;
     }
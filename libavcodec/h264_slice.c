@@ -2439,9 +2439,11 @@ static void predict_field_decoding_flag(const H264Context *h, H264SliceContext *
 }
 
 /**
- * Draw edges and report progress for the last MB row.
+ * Get the band of the picture completed by the last MB row.
+ * @return 0 if no lines were completed
  */
-static void decode_finish_row(const H264Context *h, H264SliceContext *sl)
+static int get_finished_band(const H264Context *h, H264SliceContext *sl,
+                             int *ptop, int *pheight)
 {
     int top            = 16 * (sl->mb_y      >> FIELD_PICTURE(h));
     int pic_height     = 16 *  h->mb_height >> FIELD_PICTURE(h);
@@ -2455,7 +2457,7 @@ static void decode_finish_row(const H264Context *h, H264SliceContext *sl)
     }
 
     if (top >= pic_height || (top + height) < 0)
-        return;
+        return 0;
 
     height = FFMIN(height, pic_height - top);
     if (top < 0) {
@@ -2463,7 +2465,39 @@ static void decode_finish_row(const H264Context *h, H264SliceContext *sl)
         top    = 0;
     }
 
-    ff_h264_draw_horiz_band(h, sl, top, height);
+    *ptop    = top;
+    *pheight = height;
+    return 1;
+}
+
+static void draw_finished_band(const H264Context *h, H264SliceContext *sl)
+{
+    int top, height;
+
+    /* the bands of a picture which is not output next would be drawn out of
+     * display order */
+    if (h->avctx->has_b_frames &&
+        !(h->avctx->slice_flags & SLICE_FLAG_CODED_ORDER))
+        return;
+
+    if (get_finished_band(h, sl, &top, &height))
+        ff_h264_draw_horiz_band(h, sl, top, height);
+}
+
+/**
+ * Draw edges and report progress for the last MB row.
+ */
+static void decode_finish_row(const H264Context *h, H264SliceContext *sl)
+{
+    int top, height;
+
+    if (!get_finished_band(h, sl, &top, &height))
+        return;
+
+    /* slices decoded in parallel are drawn once they are all done, in
+     * ff_h264_execute_decode_slices() */
+    if (h->nb_slice_ctx_queued <= 1 && h->avctx->draw_horiz_band)
+        draw_finished_band(h, sl);
 
     if (h->droppable || sl->h264->slice_ctx[0].er.error_occurred)
         return;
@@ -2763,7 +2797,9 @@ int ff_h264_execute_decode_slices(H264Context *h)
                 h->slice_ctx[0].er.error_count += h->slice_ctx[i].er.error_count;
         }
 
-        if (h->postpone_filter) {
+        if (h->postpone_filter || avctx->draw_horiz_band) {
+            int postpone_filter = h->postpone_filter;
+
             h->postpone_filter = 0;
 
             for (i = 0; i < context_count; i++) {
@@ -2775,8 +2811,14 @@ int ff_h264_execute_decode_slices(H264Context *h)
 
                 for (j = sl->resync_mb_y; j < y_end; j += 1 + FIELD_OR_MBAFF_PICTURE(h)) {
                     sl->mb_y = j;
-                    loop_filter(h, sl, j > sl->resync_mb_y ? 0 : sl->resync_mb_x,
-                                j == y_end - 1 ? x_end : h->mb_width);
+                    if (postpone_filter)
+                        loop_filter(h, sl, j > sl->resync_mb_y ? 0 : sl->resync_mb_x,
+                                    j == y_end - 1 ? x_end : h->mb_width);
+                    /* the last row of a slice ending inside it is drawn with
+                     * the next slice */
+                    if (avctx->draw_horiz_band &&
+                        (j != y_end - 1 || x_end == h->mb_width))
+                        draw_finished_band(h, sl);
                 }
             }
         }
@@ -839,13 +839,53 @@ void ff_hevc_deblocking_boundary_strengths(HEVCContext *s, int x0, int y0,
 #undef CB
 #undef CR
 
+/**
+ * Pass lines y to y_end - 1 of the current picture, which are not modified
+ * by the loop filters anymore, to draw_horiz_band().
+ * y and y_end are in coded picture lines, the band is given in lines of the
+ * picture cropped to the conformance window, as it is output.
+ */
+static void draw_horiz_band(HEVCContext *s, int y, int y_end)
+{
+    AVCodecContext *avctx = s->avctx;
+    const HEVCWindow *win = &s->ref->window;
+    const AVFrame *src    = s->ref->frame;
+    int offset[AV_NUM_DATA_POINTERS] = { 0 };
+    int i;
+
+    /* the bands of a picture which is not output next would be drawn out of
+     * display order. HEVC_FRAME_FLAG_OUTPUT of the picture itself is cleared
+     * once it is output, which happens before it is decoded without frame
+     * reordering, so it is checked in hevc_frame_start(). */
+    if (!avctx->draw_horiz_band || !s->ref_output ||
+        (avctx->has_b_frames && !(avctx->slice_flags & SLICE_FLAG_CODED_ORDER)))
+        return;
+
+    y     = FFMAX(y - (int)win->top_offset, 0);
+    y_end = FFMIN(y_end - (int)win->top_offset, avctx->height);
+    if (y >= y_end)
+        return;
+
+    for (i = 0; i < 3; i++) {
+        int hshift = s->ps.sps->hshift[i];
+        int vshift = s->ps.sps->vshift[i];
+
+        offset[i] = ((win->left_offset >> hshift) << s->ps.sps->pixel_shift) +
+                    ((win->top_offset + y) >> vshift) * src->linesize[i];
+    }
+
+    emms_c();
+
+    avctx->draw_horiz_band(avctx, src, offset, y, 3, y_end - y);
+}
+
 void ff_hevc_hls_filter(HEVCContext *s, int x, int y, int ctb_size)
 {
     int x_end = x >= s->ps.sps->width  - ctb_size;
+    int y_end = y >= s->ps.sps->height - ctb_size;
     if (s->avctx->skip_loop_filter < AVDISCARD_ALL)
         deblocking_filter_CTB(s, x, y);
     if (s->ps.sps->sao_enabled) {
-        int y_end = y >= s->ps.sps->height - ctb_size;
         if (y && x)
             sao_filter_CTB(s, x - ctb_size, y - ctb_size);
         if (x && y_end)
@@ -854,14 +894,20 @@ void ff_hevc_hls_filter(HEVCContext *s, int x, int y, int ctb_size)
             sao_filter_CTB(s, x, y - ctb_size);
             if (s->threads_type & FF_THREAD_FRAME )
                 ff_thread_report_progress(&s->ref->tf, y, 0);
+            draw_horiz_band(s, y - ctb_size, y);
         }
         if (x_end && y_end) {
             sao_filter_CTB(s, x , y);
             if (s->threads_type & FF_THREAD_FRAME )
                 ff_thread_report_progress(&s->ref->tf, y + ctb_size, 0);
+            draw_horiz_band(s, y, y + ctb_size);
         }
-    } else if (s->threads_type & FF_THREAD_FRAME && x_end)
-        ff_thread_report_progress(&s->ref->tf, y + ctb_size - 4, 0);
+    } else if (x_end) {
+        if (s->threads_type & FF_THREAD_FRAME)
+            ff_thread_report_progress(&s->ref->tf, y + ctb_size - 4, 0);
+        /* the deblocking of the next CTB row can modify the last 4 lines */
+        draw_horiz_band(s, FFMAX(y - 4, 0), y_end ? y + ctb_size : y + ctb_size - 4);
+    }
 }
 
 void ff_hevc_hls_filters(HEVCContext *s, int x_ctb, int y_ctb, int ctb_size)
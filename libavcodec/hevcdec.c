@@ -2313,6 +2313,37 @@ static void hls_decode_neighbour(HEVCContext *s, int x_ctb, int y_ctb,
     lc->ctb_up_left_flag = ((x_ctb > 0) && (y_ctb > 0)  && (ctb_addr_in_slice-1 >= s->ps.sps->ctb_width) && (s->ps.pps->tile_id[ctb_addr_ts] == s->ps.pps->tile_id[s->ps.pps->ctb_addr_rs_to_ts[ctb_addr_rs-1 - s->ps.sps->ctb_width]]));
 }
 
+static void report_decoded_ctbs(HEVCContext *s, int ctb_addr_ts, int done)
+{
+#if HAVE_THREADS
+    pthread_mutex_lock(&s->filter_mutex);
+    s->ctb_addr_ts_decoded = ctb_addr_ts;
+    s->ctb_decoding_done   = done;
+    pthread_cond_signal(&s->filter_cond);
+    pthread_mutex_unlock(&s->filter_mutex);
+#endif
+}
+
+static int alloc_slice_thread_contexts(HEVCContext *s)
+{
+    int i;
+
+    for (i = 1; i < s->threads_number; i++) {
+        if (s->sList[i])
+            continue;
+        s->sList[i]      = av_malloc(sizeof(HEVCContext));
+        s->HEVClcList[i] = av_mallocz(sizeof(HEVCLocalContext));
+        if (!s->sList[i] || !s->HEVClcList[i]) {
+            av_freep(&s->sList[i]);
+            av_freep(&s->HEVClcList[i]);
+            return AVERROR(ENOMEM);
+        }
+        memcpy(s->sList[i], s, sizeof(HEVCContext));
+        s->sList[i]->HEVClc = s->HEVClcList[i];
+    }
+    return 0;
+}
+
 static int hls_decode_entry(AVCodecContext *avctxt, void *isFilterThread)
 {
     HEVCContext *s  = avctxt->priv_data;
@@ -2353,22 +2384,87 @@ static int hls_decode_entry(AVCodecContext *avctxt, void *isFilterThread)
         more_data = hls_coding_quadtree(s, x_ctb, y_ctb, s->ps.sps->log2_ctb_size, 0);
         if (more_data < 0) {
             s->tab_slice_address[ctb_addr_rs] = -1;
+            if (s->filter_pipelined)
+                report_decoded_ctbs(s, ctb_addr_ts, 0);
             return more_data;
         }
 
 
         ctb_addr_ts++;
         ff_hevc_save_states(s, ctb_addr_ts);
-        ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
+        if (s->filter_pipelined) {
+            /* hand the CTBs over to the filter job one CTB row of the
+             * tile at a time */
+            if (!more_data || x_ctb + ctb_size >= s->HEVClc->end_of_tiles_x ||
+                ctb_addr_ts >= s->ps.sps->ctb_size)
+                report_decoded_ctbs(s, ctb_addr_ts, 0);
+        } else {
+            ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
+        }
     }
 
     if (x_ctb + ctb_size >= s->ps.sps->width &&
-        y_ctb + ctb_size >= s->ps.sps->height)
-        ff_hevc_hls_filter(s, x_ctb, y_ctb, ctb_size);
+        y_ctb + ctb_size >= s->ps.sps->height) {
+        if (s->filter_pipelined)
+            s->final_filter = 1;
+        else
+            ff_hevc_hls_filter(s, x_ctb, y_ctb, ctb_size);
+    }
 
     return ctb_addr_ts;
 }
 
+#if HAVE_THREADS
+/**
+ * Run the loop filters of a slice segment in the order hls_decode_entry()
+ * would, each one as soon as the CTB it follows is reconstructed.
+ */
+static int hls_filter_entry(HEVCContext *s1)
+{
+    HEVCContext *s  = s1->sList[1];
+    int ctb_size    = 1 << s->ps.sps->log2_ctb_size;
+    int ctb_addr_ts = s->ps.pps->ctb_addr_rs_to_ts[s->sh.slice_ctb_addr_rs];
+    int x_ctb       = 0;
+    int y_ctb       = 0;
+    int end, done;
+
+    do {
+        pthread_mutex_lock(&s1->filter_mutex);
+        while (s1->ctb_addr_ts_decoded <= ctb_addr_ts && !s1->ctb_decoding_done)
+            pthread_cond_wait(&s1->filter_cond, &s1->filter_mutex);
+        end  = s1->ctb_addr_ts_decoded;
+        done = s1->ctb_decoding_done;
+        pthread_mutex_unlock(&s1->filter_mutex);
+
+        for (; ctb_addr_ts < end; ctb_addr_ts++) {
+            int ctb_addr_rs = s->ps.pps->ctb_addr_ts_to_rs[ctb_addr_ts];
+
+            x_ctb = (ctb_addr_rs % s->ps.sps->ctb_width) << s->ps.sps->log2_ctb_size;
+            y_ctb = (ctb_addr_rs / s->ps.sps->ctb_width) << s->ps.sps->log2_ctb_size;
+            ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
+        }
+    } while (!done);
+
+    if (s1->final_filter)
+        ff_hevc_hls_filter(s, x_ctb, y_ctb, ctb_size);
+
+    return 0;
+}
+
+static int hls_decode_entry_pipelined(AVCodecContext *avctxt, void *arg, int job, int self_id)
+{
+    HEVCContext *s = avctxt->priv_data;
+    int ret;
+
+    if (job)
+        return hls_filter_entry(s);
+
+    ret = hls_decode_entry(avctxt, NULL);
+    report_decoded_ctbs(s, s->ctb_addr_ts_decoded, 1);
+    return ret;
+}
+#endif
+
 static int hls_slice_data(HEVCContext *s)
 {
     int arg[2];
@@ -2377,6 +2473,25 @@ static int hls_slice_data(HEVCContext *s)
     arg[0] = 0;
     arg[1] = 1;
 
+#if HAVE_THREADS
+    if (s->threads_number > 1) {
+        ret[0] = alloc_slice_thread_contexts(s);
+        if (ret[0] < 0)
+            return ret[0];
+        memcpy(s->sList[1], s, sizeof(HEVCContext));
+        s->sList[1]->HEVClc = s->HEVClcList[1];
+
+        s->filter_pipelined    = 1;
+        s->ctb_addr_ts_decoded = s->ps.pps->ctb_addr_rs_to_ts[s->sh.slice_ctb_addr_rs];
+        s->ctb_decoding_done   = 0;
+        s->final_filter        = 0;
+
+        s->avctx->execute2(s->avctx, hls_decode_entry_pipelined, arg, ret, 2);
+        s->filter_pipelined = 0;
+        return ret[0];
+    }
+#endif
+
     s->avctx->execute(s->avctx, hls_decode_entry, arg, ret , 1, sizeof(int));
     return ret[0];
 }
@@ -2485,14 +2600,9 @@ static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
 
     ff_alloc_entries(s->avctx, s->sh.num_entry_point_offsets + 1);
 
-    if (!s->sList[1]) {
-        for (i = 1; i < s->threads_number; i++) {
-            s->sList[i] = av_malloc(sizeof(HEVCContext));
-            memcpy(s->sList[i], s, sizeof(HEVCContext));
-            s->HEVClcList[i] = av_mallocz(sizeof(HEVCLocalContext));
-            s->sList[i]->HEVClc = s->HEVClcList[i];
-        }
-    }
+    res = alloc_slice_thread_contexts(s);
+    if (res < 0)
+        goto error;
 
     offset = (lc->gb.index >> 3);
 
@@ -2710,6 +2820,7 @@ static int hevc_frame_start(HEVCContext *s)
     ret = ff_hevc_set_new_ref(s, &s->frame, s->poc);
     if (ret < 0)
         goto fail;
+    s->ref_output = !!(s->ref->flags & HEVC_FRAME_FLAG_OUTPUT);
 
     ret = ff_hevc_frame_rps(s);
     if (ret < 0) {
@@ -3176,6 +3287,13 @@ static av_cold int hevc_decode_free(AVCodecContext *avctx)
 
     ff_h2645_packet_uninit(&s->pkt);
 
+#if HAVE_THREADS
+    if (avctx->active_thread_type & FF_THREAD_SLICE) {
+        pthread_mutex_destroy(&s->filter_mutex);
+        pthread_cond_destroy(&s->filter_cond);
+    }
+#endif
+
     return 0;
 }
 
@@ -3186,6 +3304,13 @@ static av_cold int hevc_init_context(AVCodecContext *avctx)
 
     s->avctx = avctx;
 
+#if HAVE_THREADS
+    if (avctx->active_thread_type & FF_THREAD_SLICE) {
+        pthread_mutex_init(&s->filter_mutex, NULL);
+        pthread_cond_init(&s->filter_cond, NULL);
+    }
+#endif
+
     s->HEVClc = av_mallocz(sizeof(HEVCLocalContext));
     if (!s->HEVClc)
         goto fail;
@@ -3395,7 +3520,8 @@ AVCodec ff_hevc_decoder = {
     .update_thread_context = hevc_update_thread_context,
     .init_thread_copy      = hevc_init_thread_copy,
     .capabilities          = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
-                             AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS,
+                             AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS |
+                             AV_CODEC_CAP_DRAW_HORIZ_BAND,
     .caps_internal         = FF_CODEC_CAP_INIT_THREADSAFE,
     .profiles              = NULL_IF_CONFIG_SMALL(ff_hevc_profiles),
 };
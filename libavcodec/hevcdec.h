@@ -26,6 +26,7 @@
 #include <stdatomic.h>
 
 #include "libavutil/buffer.h"
+#include "libavutil/thread.h"
 
 #include "avcodec.h"
 #include "bswapdsp.h"
@@ -432,6 +433,7 @@ typedef struct HEVCContext {
 
     int is_decoded;
     int no_rasl_output_flag;
+    int ref_output;  ///< the current picture is output, set before it can be bumped out of the DPB
 
     HEVCPredContext hpc;
     HEVCDSPContext hevcdsp;
@@ -469,6 +471,18 @@ typedef struct HEVCContext {
     int enable_parallel_tiles;
     atomic_int wpp_err;
 
+    /* Slice segments without WPP are decoded by two jobs when slice threading
+     * is active: one parsing and reconstructing the CTBs, and one running
+     * deblocking and SAO behind it. */
+    int filter_pipelined;
+    int ctb_addr_ts_decoded;    ///< CTBs before this one are reconstructed
+    int ctb_decoding_done;      ///< no more CTBs of the slice segment will be reconstructed
+    int final_filter;           ///< the last CTB of the picture was reconstructed
+#if HAVE_THREADS
+    pthread_mutex_t filter_mutex;
+    pthread_cond_t  filter_cond;
+#endif
+
     const uint8_t *data;
 
     H2645Packet pkt;
@@ -58,6 +58,11 @@
  * skipped due to the skip_frame setting.
  */
 #define FF_CODEC_CAP_SKIP_FRAME_FILL_PARAM  (1 << 3)
+/**
+ * The decoder supports FF_THREAD_FRAME_LOW_DELAY, i.e. frame threading
+ * returning decoded frames without the thread_count - 1 frames of delay.
+ */
+#define FF_CODEC_CAP_LOW_DELAY_FRAME_THREADS (1 << 4)
 
 #ifdef TRACE
 #   define ff_tlog(ctx, ...) av_log(ctx, AV_LOG_TRACE, __VA_ARGS__)
@@ -203,6 +208,10 @@ typedef struct AVCodecInternal {
 
     /* to prevent infinite loop on errors when draining */
     int nb_draining_errors;
+
+    /* set while avcodec_receive_frame() runs, so that frames still being
+     * decoded by low delay frame threads are waited for */
+    int receiving_frame;
 } AVCodecInternal;
 
 struct AVCodecDefault {
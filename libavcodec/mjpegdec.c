@@ -1279,10 +1279,11 @@ static void shift_output(MJpegDecodeContext *s, uint8_t *ptr, int linesize)
     }
 }
 
-static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
-                             int Al, const uint8_t *mb_bitmask,
-                             int mb_bitmask_size,
-                             const AVFrame *reference)
+/* decode the MCUs from mb_start to mb_end (exclusive) in raster order */
+static int mjpeg_decode_scan_mbs(MJpegDecodeContext *s, int nb_components,
+                                 int Ah, int Al, const uint8_t *mb_bitmask,
+                                 const AVFrame *reference,
+                                 int mb_start, int mb_end)
 {
     int i, mb_x, mb_y, chroma_h_shift, chroma_v_shift, chroma_width, chroma_height;
     uint8_t *data[MAX_COMPONENTS];
@@ -1292,11 +1293,8 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
     int bytes_per_pixel = 1 + (s->bits > 8);
 
     if (mb_bitmask) {
-        if (mb_bitmask_size != (s->mb_width * s->mb_height + 7)>>3) {
-            av_log(s->avctx, AV_LOG_ERROR, "mb_bitmask_size mismatches\n");
-            return AVERROR_INVALIDDATA;
-        }
         init_get_bits(&mb_bitmask_gb, mb_bitmask, s->mb_width * s->mb_height);
+        skip_bits_long(&mb_bitmask_gb, mb_start);
     }
 
     s->restart_count = 0;
@@ -1311,11 +1309,11 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
         data[c] = s->picture_ptr->data[c];
         reference_data[c] = reference ? reference->data[c] : NULL;
         linesize[c] = s->linesize[c];
-        s->coefs_finished[c] |= 1;
     }
 
-    for (mb_y = 0; mb_y < s->mb_height; mb_y++) {
-        for (mb_x = 0; mb_x < s->mb_width; mb_x++) {
+    mb_x = mb_start % s->mb_width;
+    for (mb_y = mb_start / s->mb_width; mb_y * s->mb_width < mb_end; mb_y++, mb_x = 0) {
+        for (; mb_x < s->mb_width && mb_y * s->mb_width + mb_x < mb_end; mb_x++) {
             const int copy_mb = mb_bitmask && !get_bits1(&mb_bitmask_gb);
 
             if (s->restart_interval && !s->restart_count)
@@ -1400,6 +1398,144 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
     return 0;
 }
 
+typedef struct ScanSliceArgs {
+    int nb_components, Ah, Al;
+    const uint8_t *mb_bitmask;
+    const AVFrame *reference;
+    int nb_jobs;
+    int nb_segments;
+} ScanSliceArgs;
+
+/* index of the first restart interval decoded by a job, the leftover
+ * segments being spread over the jobs */
+static int first_segment(const ScanSliceArgs *a, int jobnr)
+{
+    return jobnr * a->nb_segments / a->nb_jobs;
+}
+
+static int mjpeg_decode_scan_slice(AVCodecContext *avctx, void *arg,
+                                   int jobnr, int threadnr)
+{
+    MJpegDecodeContext *s = avctx->priv_data;
+    MJpegDecodeContext *sc = &s->slice_ctx[jobnr];
+    const ScanSliceArgs *a = arg;
+    int mb_count = s->mb_width * s->mb_height;
+    int mb_start = first_segment(a, jobnr) * s->restart_interval;
+    int mb_end   = FFMIN(first_segment(a, jobnr + 1) * s->restart_interval,
+                         mb_count);
+
+    return mjpeg_decode_scan_mbs(sc, a->nb_components, a->Ah, a->Al,
+                                 a->mb_bitmask, a->reference, mb_start, mb_end);
+}
+
+/**
+ * Decode a scan with slice threading, each job starting at a restart marker.
+ * @return 0 on success, a negative value if the scan has to be decoded
+ *         serially instead, e.g. because its markers do not match the
+ *         restart interval
+ */
+static int mjpeg_decode_scan_threaded(MJpegDecodeContext *s, int nb_components,
+                                      int Ah, int Al, const uint8_t *mb_bitmask,
+                                      const AVFrame *reference)
+{
+    AVCodecContext *avctx = s->avctx;
+    int mb_count    = s->mb_width * s->mb_height;
+    int nb_segments = (mb_count + s->restart_interval - 1) / s->restart_interval;
+    int start       = get_bits_count(&s->gb) >> 3;
+    const int *restart_pos = s->restart_pos;
+    int nb_restart_pos     = s->nb_restart_pos;
+    ScanSliceArgs a = { nb_components, Ah, Al, mb_bitmask, reference };
+    int i, j;
+
+    if (nb_segments < 2)
+        return AVERROR(EINVAL);
+
+    /* skip the markers of a previous field */
+    while (nb_restart_pos && *restart_pos <= start) {
+        restart_pos++;
+        nb_restart_pos--;
+    }
+    if (nb_restart_pos < nb_segments - 1)
+        return AVERROR_INVALIDDATA;
+
+    if (!s->slice_ctx) {
+        s->slice_ctx = av_malloc_array(avctx->thread_count, sizeof(*s->slice_ctx));
+        s->slice_ret = av_malloc_array(avctx->thread_count, sizeof(*s->slice_ret));
+        if (!s->slice_ctx || !s->slice_ret) {
+            av_freep(&s->slice_ctx);
+            av_freep(&s->slice_ret);
+            return AVERROR(ENOMEM);
+        }
+    }
+
+    a.nb_jobs     = FFMIN(avctx->thread_count, nb_segments);
+    a.nb_segments = nb_segments;
+
+    for (i = 0; i < a.nb_jobs; i++) {
+        MJpegDecodeContext *sc = &s->slice_ctx[i];
+
+        memcpy(sc, s, sizeof(*sc));
+        if (i) {
+            int pos = restart_pos[first_segment(&a, i) - 1];
+            skip_bits_long(&sc->gb, 8 * pos - get_bits_count(&sc->gb));
+        }
+        for (j = 0; j < nb_components; j++)
+            sc->last_dc[j] = 4 << s->bits;
+    }
+
+    avctx->execute2(avctx, mjpeg_decode_scan_slice, &a, s->slice_ret, a.nb_jobs);
+
+    /* each job must have stopped right after the marker the next one
+     * started at, as the serial decoder would have */
+    for (i = 0; i < a.nb_jobs; i++) {
+        if (s->slice_ret[i] < 0)
+            return s->slice_ret[i];
+        if (i < a.nb_jobs - 1 &&
+            get_bits_count(&s->slice_ctx[i].gb) !=
+            8 * restart_pos[first_segment(&a, i + 1) - 1])
+            return AVERROR_INVALIDDATA;
+    }
+
+    s->gb = s->slice_ctx[a.nb_jobs - 1].gb;
+    return 0;
+}
+
+static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
+                             int Al, const uint8_t *mb_bitmask,
+                             int mb_bitmask_size,
+                             const AVFrame *reference)
+{
+    int i;
+
+    if (mb_bitmask) {
+        if (mb_bitmask_size != (s->mb_width * s->mb_height + 7)>>3) {
+            av_log(s->avctx, AV_LOG_ERROR, "mb_bitmask_size mismatches\n");
+            return AVERROR_INVALIDDATA;
+        }
+    }
+
+    /* set here rather than by the slice jobs, which work on copies of the
+     * context */
+    for (i = 0; i < nb_components; i++) {
+        int c = s->comp_index[i];
+        s->coefs_finished[c] |= 1;
+    }
+
+    if (s->restart_interval && s->avctx->active_thread_type & FF_THREAD_SLICE &&
+        s->avctx->thread_count > 1) {
+        int ret = mjpeg_decode_scan_threaded(s, nb_components, Ah, Al,
+                                             mb_bitmask, reference);
+        if (ret >= 0)
+            return ret;
+        if (ret == AVERROR_INVALIDDATA)
+            av_log(s->avctx, AV_LOG_DEBUG,
+                   "Restart markers not usable, decoding the scan serially\n");
+    }
+
+    return mjpeg_decode_scan_mbs(s, nb_components, Ah, Al, mb_bitmask, reference,
+                                 0, s->mb_width * s->mb_height);
+}
+
 static int mjpeg_decode_scan_progressive_ac(MJpegDecodeContext *s, int ss,
                                             int se, int Ah, int Al)
 {
@@ -1968,6 +2104,18 @@ found:
     return val;
 }
 
+/* remember where a scan can be resumed, for slice threading */
+static int add_restart_pos(MJpegDecodeContext *s, int pos)
+{
+    int *restart_pos = av_fast_realloc(s->restart_pos, &s->restart_pos_size,
+                                       (s->nb_restart_pos + 1) * sizeof(*restart_pos));
+    if (!restart_pos)
+        return AVERROR(ENOMEM);
+    s->restart_pos = restart_pos;
+    s->restart_pos[s->nb_restart_pos++] = pos;
+    return 0;
+}
+
 int ff_mjpeg_find_marker(MJpegDecodeContext *s,
                          const uint8_t **buf_ptr, const uint8_t *buf_end,
                          const uint8_t **unescaped_buf_ptr,
@@ -1986,6 +2134,8 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
         const uint8_t *ptr = src;
         uint8_t *dst = s->buffer;
 
+        s->nb_restart_pos = 0;
+
         #define copy_data_segment(skip) do {       \
             ptrdiff_t length = (ptr - src) - (skip);  \
             if (length > 0) {                         \
@@ -2023,6 +2173,9 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
                         copy_data_segment(1);
                         if (x)
                             break;
+                    } else if (s->avctx->active_thread_type & FF_THREAD_SLICE) {
+                        if (add_restart_pos(s, dst - s->buffer + (ptr - src)) < 0)
+                            return AVERROR(ENOMEM);
                     }
                 }
             }
@@ -2117,6 +2270,10 @@ int ff_mjpeg_decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
                                           &unescaped_buf_size);
         /* EOF */
         if (start_code < 0) {
+            if (start_code == AVERROR(ENOMEM)) {
+                ret = start_code;
+                goto fail;
+            }
             break;
         } else if (unescaped_buf_size > INT_MAX / 8) {
             av_log(avctx, AV_LOG_ERROR,
@@ -2528,6 +2685,9 @@ av_cold int ff_mjpeg_decode_end(AVCodecContext *avctx)
     av_freep(&s->buffer);
     av_freep(&s->stereo3d);
     av_freep(&s->ljpeg_buffer);
+    av_freep(&s->restart_pos);
+    av_freep(&s->slice_ctx);
+    av_freep(&s->slice_ret);
     s->ljpeg_buffer_size = 0;
 
     for (i = 0; i < 3; i++) {
@@ -2574,7 +2734,7 @@ AVCodec ff_mjpeg_decoder = {
     .close          = ff_mjpeg_decode_end,
     .decode         = ff_mjpeg_decode_frame,
     .flush          = decode_flush,
-    .capabilities   = AV_CODEC_CAP_DR1,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_SLICE_THREADS,
     .max_lowres     = 3,
     .priv_class     = &mjpegdec_class,
     .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE |
@@ -110,6 +110,12 @@ typedef struct MJpegDecodeContext {
 
     int restart_interval;
     int restart_count;
+    int *restart_pos;               ///< offsets in buffer after each RSTn marker of the current scan
+    unsigned int restart_pos_size;
+    int nb_restart_pos;
+
+    struct MJpegDecodeContext *slice_ctx; ///< context copies for the slice threading jobs
+    int *slice_ret;
 
     int buggy_avid;
     int cs_itu601;
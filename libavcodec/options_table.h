@@ -531,6 +531,10 @@ static const AVOption avcodec_options[] = {
 {"thread_type", "select multithreading type", OFFSET(thread_type), AV_OPT_TYPE_FLAGS, {.i64 = FF_THREAD_SLICE|FF_THREAD_FRAME }, 0, INT_MAX, V|A|E|D, "thread_type"},
 {"slice", NULL, 0, AV_OPT_TYPE_CONST, {.i64 = FF_THREAD_SLICE }, INT_MIN, INT_MAX, V|E|D, "thread_type"},
 {"frame", NULL, 0, AV_OPT_TYPE_CONST, {.i64 = FF_THREAD_FRAME }, INT_MIN, INT_MAX, V|E|D, "thread_type"},
+{"frame_low_delay", NULL, 0, AV_OPT_TYPE_CONST, {.i64 = FF_THREAD_FRAME_LOW_DELAY }, INT_MIN, INT_MAX, V|D, "thread_type"},
+{"thread_pool", "select where the threads come from", OFFSET(thread_pool), AV_OPT_TYPE_INT, {.i64 = FF_THREAD_POOL_PRIVATE }, 0, 1, V|A|E|D, "thread_pool"},
+{"private", "threads owned by the context", 0, AV_OPT_TYPE_CONST, {.i64 = FF_THREAD_POOL_PRIVATE }, INT_MIN, INT_MAX, V|E|D, "thread_pool"},
+{"shared", "process-wide shared pool", 0, AV_OPT_TYPE_CONST, {.i64 = FF_THREAD_POOL_SHARED }, INT_MIN, INT_MAX, V|E|D, "thread_pool"},
 {"audio_service_type", "audio service type", OFFSET(audio_service_type), AV_OPT_TYPE_INT, {.i64 = AV_AUDIO_SERVICE_TYPE_MAIN }, 0, AV_AUDIO_SERVICE_TYPE_NB-1, A|E, "audio_service_type"},
 {"ma", "Main Audio Service", 0, AV_OPT_TYPE_CONST, {.i64 = AV_AUDIO_SERVICE_TYPE_MAIN },              INT_MIN, INT_MAX, A|E, "audio_service_type"},
 {"ef", "Effects",            0, AV_OPT_TYPE_CONST, {.i64 = AV_AUDIO_SERVICE_TYPE_EFFECTS },           INT_MIN, INT_MAX, A|E, "audio_service_type"},
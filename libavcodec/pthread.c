@@ -40,6 +40,8 @@
  * Threading requires more than one thread.
  * Frame threading requires entire frames to be passed to the codec,
  * and introduces extra decoding delay, so is incompatible with low_delay.
+ * FF_THREAD_FRAME_LOW_DELAY selects frame threading without the delay, for
+ * codecs which can return each frame as soon as it is decoded.
  *
  * @param avctx The context.
  */
@@ -49,8 +51,14 @@ static void validate_thread_parameters(AVCodecContext *avctx)
                                 && !(avctx->flags  & AV_CODEC_FLAG_TRUNCATED)
                                 && !(avctx->flags  & AV_CODEC_FLAG_LOW_DELAY)
                                 && !(avctx->flags2 & AV_CODEC_FLAG2_CHUNKS);
+    int low_delay_frame_threading = (avctx->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)
+                                && (avctx->codec->caps_internal & FF_CODEC_CAP_LOW_DELAY_FRAME_THREADS)
+                                && !(avctx->flags  & AV_CODEC_FLAG_TRUNCATED)
+                                && !(avctx->flags2 & AV_CODEC_FLAG2_CHUNKS);
     if (avctx->thread_count == 1) {
         avctx->active_thread_type = 0;
+    } else if (low_delay_frame_threading && (avctx->thread_type & FF_THREAD_FRAME_LOW_DELAY)) {
+        avctx->active_thread_type = FF_THREAD_FRAME;
     } else if (frame_threading_supported && (avctx->thread_type & FF_THREAD_FRAME)) {
         avctx->active_thread_type = FF_THREAD_FRAME;
     } else if (avctx->codec->capabilities & AV_CODEC_CAP_SLICE_THREADS &&
@@ -44,6 +44,7 @@
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
 
 enum {
     ///< Set when the thread is awaiting a packet.
@@ -107,6 +108,9 @@ typedef struct PerThreadContext {
 
     int hwaccel_serializing;
     int async_serializing;
+
+    ThreadPoolTask task;            ///< Decoding task, when running on the shared pool.
+    int task_submitted;             ///< Set once task has been submitted.
 } PerThreadContext;
 
 /**
@@ -133,6 +137,11 @@ typedef struct FrameThreadContext {
                                     * Set for the first N packets, where N is the number of threads.
                                     * While it is set, ff_thread_en/decode_frame won't return any results.
                                     */
+
+    int low_delay;                 ///< Set when frames are returned as soon as they are decoded.
+    int nb_pending;                ///< Number of frames submitted in low delay mode and not yet returned.
+
+    ThreadPoolClient *pool;        ///< Shared pool running the decoding tasks, if used instead of threads.
 } FrameThreadContext;
 
 #define THREAD_SAFE_CALLBACKS(avctx) \
@@ -157,81 +166,104 @@ static void async_unlock(FrameThreadContext *fctx)
 }
 
 /**
- * Codec worker thread.
+ * Decode the packet submitted to a codec thread.
  *
  * Automatically calls ff_thread_finish_setup() if the codec does
  * not provide an update_thread_context method, or if the codec returns
  * before calling it.
+ *
+ * Must be called with p->mutex locked.
  */
-static attribute_align_arg void *frame_worker_thread(void *arg)
+static void frame_worker_decode(PerThreadContext *p)
 {
-    PerThreadContext *p = arg;
     AVCodecContext *avctx = p->avctx;
     const AVCodec *codec = avctx->codec;
 
-    pthread_mutex_lock(&p->mutex);
-    while (1) {
-        while (atomic_load(&p->state) == STATE_INPUT_READY && !p->die)
-            pthread_cond_wait(&p->input_cond, &p->mutex);
+    if (!codec->update_thread_context && THREAD_SAFE_CALLBACKS(avctx))
+        ff_thread_finish_setup(avctx);
 
-        if (p->die) break;
+    /* If a decoder supports hwaccel, then it must call ff_get_format().
+     * Since that call must happen before ff_thread_finish_setup(), the
+     * decoder is required to implement update_thread_context() and call
+     * ff_thread_finish_setup() manually. Therefore the above
+     * ff_thread_finish_setup() call did not happen and hwaccel_serializing
+     * cannot be true here. */
+    av_assert0(!p->hwaccel_serializing);
+
+    /* if the previous thread uses hwaccel then we take the lock to ensure
+     * the threads don't run concurrently */
+    if (avctx->hwaccel) {
+        pthread_mutex_lock(&p->parent->hwaccel_mutex);
+        p->hwaccel_serializing = 1;
+    }
 
-        if (!codec->update_thread_context && THREAD_SAFE_CALLBACKS(avctx))
-            ff_thread_finish_setup(avctx);
-
-        /* If a decoder supports hwaccel, then it must call ff_get_format().
-         * Since that call must happen before ff_thread_finish_setup(), the
-         * decoder is required to implement update_thread_context() and call
-         * ff_thread_finish_setup() manually. Therefore the above
-         * ff_thread_finish_setup() call did not happen and hwaccel_serializing
-         * cannot be true here. */
-        av_assert0(!p->hwaccel_serializing);
-
-        /* if the previous thread uses hwaccel then we take the lock to ensure
-         * the threads don't run concurrently */
-        if (avctx->hwaccel) {
-            pthread_mutex_lock(&p->parent->hwaccel_mutex);
-            p->hwaccel_serializing = 1;
-        }
+    av_frame_unref(p->frame);
+    p->got_frame = 0;
+    p->result = codec->decode(avctx, p->frame, &p->got_frame, &p->avpkt);
 
+    if ((p->result < 0 || !p->got_frame) && p->frame->buf[0]) {
+        if (avctx->internal->allocate_progress)
+            av_log(avctx, AV_LOG_ERROR, "A frame threaded decoder did not "
+                   "free the frame on failure. This is a bug, please report it.\n");
         av_frame_unref(p->frame);
-        p->got_frame = 0;
-        p->result = codec->decode(avctx, p->frame, &p->got_frame, &p->avpkt);
+    }
 
-        if ((p->result < 0 || !p->got_frame) && p->frame->buf[0]) {
-            if (avctx->internal->allocate_progress)
-                av_log(avctx, AV_LOG_ERROR, "A frame threaded decoder did not "
-                       "free the frame on failure. This is a bug, please report it.\n");
-            av_frame_unref(p->frame);
-        }
+    if (atomic_load(&p->state) == STATE_SETTING_UP)
+        ff_thread_finish_setup(avctx);
+
+    if (p->hwaccel_serializing) {
+        p->hwaccel_serializing = 0;
+        pthread_mutex_unlock(&p->parent->hwaccel_mutex);
+    }
 
-        if (atomic_load(&p->state) == STATE_SETTING_UP)
-            ff_thread_finish_setup(avctx);
+    if (p->async_serializing) {
+        p->async_serializing = 0;
 
-        if (p->hwaccel_serializing) {
-            p->hwaccel_serializing = 0;
-            pthread_mutex_unlock(&p->parent->hwaccel_mutex);
-        }
+        async_unlock(p->parent);
+    }
 
-        if (p->async_serializing) {
-            p->async_serializing = 0;
+    pthread_mutex_lock(&p->progress_mutex);
 
-            async_unlock(p->parent);
-        }
+    atomic_store(&p->state, STATE_INPUT_READY);
 
-        pthread_mutex_lock(&p->progress_mutex);
+    pthread_cond_broadcast(&p->progress_cond);
+    pthread_cond_signal(&p->output_cond);
+    pthread_mutex_unlock(&p->progress_mutex);
+}
 
-        atomic_store(&p->state, STATE_INPUT_READY);
+/**
+ * Codec worker thread.
+ */
+static attribute_align_arg void *frame_worker_thread(void *arg)
+{
+    PerThreadContext *p = arg;
 
-        pthread_cond_broadcast(&p->progress_cond);
-        pthread_cond_signal(&p->output_cond);
-        pthread_mutex_unlock(&p->progress_mutex);
+    pthread_mutex_lock(&p->mutex);
+    while (1) {
+        while (atomic_load(&p->state) == STATE_INPUT_READY && !p->die)
+            pthread_cond_wait(&p->input_cond, &p->mutex);
+
+        if (p->die) break;
+
+        frame_worker_decode(p);
     }
     pthread_mutex_unlock(&p->mutex);
 
     return NULL;
 }
 
+/**
+ * Decoding task run by the shared pool.
+ */
+static void frame_worker_job(void *arg, int jobnr, int threadnr)
+{
+    PerThreadContext *p = arg;
+
+    pthread_mutex_lock(&p->mutex);
+    frame_worker_decode(p);
+    pthread_mutex_unlock(&p->mutex);
+}
+
 /**
  * Update the next thread's AVCodecContext with values from the reference thread's context.
  *
@@ -302,7 +334,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
     }
 
     if (for_user) {
-        dst->delay       = src->thread_count - 1;
+        PerThreadContext *p = src->internal->thread_ctx;
+        dst->delay       = p->parent->low_delay ? 0 : src->thread_count - 1;
 #if FF_API_CODED_FRAME
 FF_DISABLE_DEPRECATION_WARNINGS
         dst->coded_frame = src->coded_frame;
@@ -391,6 +424,10 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
     if (!avpkt->size && !(codec->capabilities & AV_CODEC_CAP_DELAY))
         return 0;
 
+    /* a thread holds its mutex while decoding, a task may not have started */
+    if (fctx->pool && p->task_submitted)
+        avpriv_threadpool_wait_task(fctx->pool, &p->task);
+
     pthread_mutex_lock(&p->mutex);
 
     ret = update_context_from_user(p->avctx, user_avctx);
@@ -426,8 +463,14 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
     }
 
     atomic_store(&p->state, STATE_SETTING_UP);
-    pthread_cond_signal(&p->input_cond);
-    pthread_mutex_unlock(&p->mutex);
+    if (fctx->pool) {
+        pthread_mutex_unlock(&p->mutex);
+        avpriv_threadpool_submit(fctx->pool, &p->task);
+        p->task_submitted = 1;
+    } else {
+        pthread_cond_signal(&p->input_cond);
+        pthread_mutex_unlock(&p->mutex);
+    }
 
     /*
      * If the client doesn't have a thread-safe get_buffer(),
@@ -469,6 +512,94 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
     return 0;
 }
 
+/**
+ * Return the output of the oldest thread which has not been returned yet,
+ * waiting for it to finish decoding if needed.
+ */
+static int return_oldest_frame(AVCodecContext *avctx,
+                               AVFrame *picture, int *got_picture_ptr)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+    PerThreadContext *p = &fctx->threads[fctx->next_finished];
+    int err;
+
+    if (atomic_load(&p->state) != STATE_INPUT_READY) {
+        pthread_mutex_lock(&p->progress_mutex);
+        while (atomic_load_explicit(&p->state, memory_order_relaxed) != STATE_INPUT_READY)
+            pthread_cond_wait(&p->output_cond, &p->progress_mutex);
+        pthread_mutex_unlock(&p->progress_mutex);
+    }
+
+    av_frame_move_ref(picture, p->frame);
+    *got_picture_ptr = p->got_frame;
+    picture->pkt_dts = p->avpkt.dts;
+    err = p->result;
+
+    p->got_frame = 0;
+    p->result = 0;
+
+    update_context_from_thread(avctx, p->avctx, 1);
+
+    if (++fctx->next_finished >= avctx->thread_count)
+        fctx->next_finished = 0;
+    fctx->nb_pending--;
+
+    return err;
+}
+
+/**
+ * Low delay variant of ff_thread_decode_frame().
+ *
+ * A packet is submitted as soon as a thread is free, so that its decoding
+ * starts once the previous frame has called ff_thread_finish_setup(), but
+ * frames are never held back to fill the pipeline: a finished frame is
+ * returned by the next call, and an empty packet outside of draining waits
+ * for the oldest frame still being decoded. This is what
+ * avcodec_receive_frame() does when no input is left.
+ */
+static int decode_frame_low_delay(AVCodecContext *avctx,
+                                  AVFrame *picture, int *got_picture_ptr,
+                                  AVPacket *avpkt)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+    int err = 0, ret;
+
+    *got_picture_ptr = 0;
+
+    if (!avpkt->size) {
+        /* skip threads that didn't output a frame/error, so that draining
+         * doesn't stop before all submitted frames have been returned */
+        while (fctx->nb_pending && !*got_picture_ptr && err >= 0)
+            err = return_oldest_frame(avctx, picture, got_picture_ptr);
+        if (*got_picture_ptr || err < 0 || !avctx->internal->draining ||
+            !(avctx->codec->capabilities & AV_CODEC_CAP_DELAY))
+            return err;
+    } else if (fctx->nb_pending == avctx->thread_count) {
+        /* all threads are busy, the oldest one hands over its frame
+         * before taking the packet */
+        err = return_oldest_frame(avctx, picture, got_picture_ptr);
+    }
+
+    ret = submit_packet(&fctx->threads[fctx->next_decoding], avctx, avpkt);
+    if (ret < 0) {
+        av_frame_unref(picture);
+        *got_picture_ptr = 0;
+        return ret;
+    }
+    if (fctx->next_decoding >= avctx->thread_count)
+        fctx->next_decoding = 0;
+    fctx->nb_pending++;
+
+    /* when draining, the decoder outputs its remaining frames from the empty
+     * packet, otherwise only a frame which is already complete is returned */
+    if (!*got_picture_ptr && err >= 0 &&
+        (!avpkt->size ||
+         atomic_load(&fctx->threads[fctx->next_finished].state) == STATE_INPUT_READY))
+        err = return_oldest_frame(avctx, picture, got_picture_ptr);
+
+    return err;
+}
+
 int ff_thread_decode_frame(AVCodecContext *avctx,
                            AVFrame *picture, int *got_picture_ptr,
                            AVPacket *avpkt)
@@ -482,6 +613,13 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
      * go forward while we are in this function */
     async_unlock(fctx);
 
+    if (fctx->low_delay) {
+        err = decode_frame_low_delay(avctx, picture, got_picture_ptr, avpkt);
+        if (err >= 0)
+            err = avpkt->size;
+        goto finish;
+    }
+
     /*
      * Submit a packet to the next decoding thread.
      */
@@ -644,6 +782,9 @@ static void park_frame_worker_threads(FrameThreadContext *fctx, int thread_count
         p->got_frame = 0;
     }
 
+    if (fctx->pool)
+        avpriv_threadpool_wait(fctx->pool);
+
     async_lock(fctx);
 }
 
@@ -662,6 +803,8 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
             fctx->threads->avctx->internal->is_copy = 1;
         }
 
+    avpriv_threadpool_client_free(&fctx->pool);
+
     for (i = 0; i < thread_count; i++) {
         PerThreadContext *p = &fctx->threads[i];
 
@@ -763,6 +906,8 @@ int ff_frame_thread_init(AVCodecContext *avctx)
 
     fctx->async_lock = 1;
     fctx->delaying = 1;
+    fctx->low_delay = (avctx->thread_type & FF_THREAD_FRAME_LOW_DELAY) &&
+                      (avctx->codec->caps_internal & FF_CODEC_CAP_LOW_DELAY_FRAME_THREADS);
 
     for (i = 0; i < thread_count; i++) {
         AVCodecContext *copy = av_malloc(sizeof(AVCodecContext));
@@ -823,12 +968,27 @@ int ff_frame_thread_init(AVCodecContext *avctx)
 
         if (err) goto error;
 
+        if (avctx->thread_pool == FF_THREAD_POOL_SHARED) {
+            p->task.func    = frame_worker_job;
+            p->task.priv    = p;
+            p->task.nb_jobs = 1;
+            continue;
+        }
+
         err = AVERROR(pthread_create(&p->thread, NULL, frame_worker_thread, p));
         p->thread_init= !err;
         if(!p->thread_init)
             goto error;
     }
 
+    if (avctx->thread_pool == FF_THREAD_POOL_SHARED) {
+        err = avpriv_threadpool_client_alloc(&fctx->pool, thread_count);
+        if (err < 0) {
+            i = thread_count - 1;
+            goto error;
+        }
+    }
+
     return 0;
 
 error:
@@ -852,6 +1012,7 @@ void ff_thread_flush(AVCodecContext *avctx)
 
     fctx->next_decoding = fctx->next_finished = 0;
     fctx->delaying = 1;
+    fctx->nb_pending = 0;
     fctx->prev_thread = NULL;
     for (i = 0; i < avctx->thread_count; i++) {
         PerThreadContext *p = &fctx->threads[i];
@@ -867,6 +1028,13 @@ void ff_thread_flush(AVCodecContext *avctx)
     }
 }
 
+int ff_thread_frames_pending(AVCodecContext *avctx)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+
+    return fctx->nb_pending;
+}
+
 int ff_thread_can_start_frame(AVCodecContext *avctx)
 {
     PerThreadContext *p = avctx->internal->thread_ctx;
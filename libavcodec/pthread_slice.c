@@ -34,6 +34,7 @@
 #include "libavutil/cpu.h"
 #include "libavutil/mem.h"
 #include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
 
 typedef int (action_func)(AVCodecContext *c, void *arg);
 typedef int (action_func2)(AVCodecContext *c, void *arg, int jobnr, int threadnr);
@@ -59,6 +60,8 @@ typedef struct SliceThreadContext {
     int thread_count;
     pthread_cond_t *progress_cond;
     pthread_mutex_t *progress_mutex;
+
+    ThreadPoolClient *pool;     ///< set when running on the shared pool instead of workers
 } SliceThreadContext;
 
 static void* attribute_align_arg worker(void *v)
@@ -105,15 +108,19 @@ void ff_slice_thread_free(AVCodecContext *avctx)
     SliceThreadContext *c = avctx->internal->thread_ctx;
     int i;
 
-    pthread_mutex_lock(&c->current_job_lock);
-    c->done = 1;
-    pthread_cond_broadcast(&c->current_job_cond);
-    for (i = 0; i < c->thread_count; i++)
-        pthread_cond_broadcast(&c->progress_cond[i]);
-    pthread_mutex_unlock(&c->current_job_lock);
+    if (c->pool) {
+        avpriv_threadpool_client_free(&c->pool);
+    } else {
+        pthread_mutex_lock(&c->current_job_lock);
+        c->done = 1;
+        pthread_cond_broadcast(&c->current_job_cond);
+        for (i = 0; i < c->thread_count; i++)
+            pthread_cond_broadcast(&c->progress_cond[i]);
+        pthread_mutex_unlock(&c->current_job_lock);
 
-    for (i=0; i<avctx->thread_count; i++)
-         pthread_join(c->workers[i], NULL);
+        for (i=0; i<avctx->thread_count; i++)
+             pthread_join(c->workers[i], NULL);
+    }
 
     for (i = 0; i < c->thread_count; i++) {
         pthread_mutex_destroy(&c->progress_mutex[i]);
@@ -139,6 +146,18 @@ static av_always_inline void thread_park_workers(SliceThreadContext *c, int thre
     pthread_mutex_unlock(&c->current_job_lock);
 }
 
+static void pool_job(void *priv, int jobnr, int threadnr)
+{
+    AVCodecContext *avctx = priv;
+    SliceThreadContext *c = avctx->internal->thread_ctx;
+    int ret;
+
+    ret = c->func ? c->func(avctx, (char*)c->args + jobnr*c->job_size):
+                    c->func2(avctx, c->args, jobnr, threadnr);
+    if (c->rets)
+        c->rets[jobnr] = ret;
+}
+
 static int thread_execute(AVCodecContext *avctx, action_func* func, void *arg, int *ret, int job_count, int job_size)
 {
     SliceThreadContext *c = avctx->internal->thread_ctx;
@@ -149,6 +168,17 @@ static int thread_execute(AVCodecContext *avctx, action_func* func, void *arg, i
     if (job_count <= 0)
         return 0;
 
+    if (c->pool) {
+        ThreadPoolTask task = { .func = pool_job, .priv = avctx, .nb_jobs = job_count };
+
+        c->job_size = job_size;
+        c->args = arg;
+        c->func = func;
+        c->rets = ret;
+        avpriv_threadpool_execute(c->pool, &task);
+        return 0;
+    }
+
     pthread_mutex_lock(&c->current_job_lock);
 
     c->current_job = avctx->thread_count;
@@ -222,6 +252,19 @@ int ff_slice_thread_init(AVCodecContext *avctx)
     pthread_cond_init(&c->current_job_cond, NULL);
     pthread_cond_init(&c->last_job_cond, NULL);
     pthread_mutex_init(&c->current_job_lock, NULL);
+
+    if (avctx->thread_pool == FF_THREAD_POOL_SHARED) {
+        int err = avpriv_threadpool_client_alloc(&c->pool, thread_count);
+        if (err < 0) {
+            avctx->thread_count = 0;
+            ff_thread_free(avctx);
+            return err;
+        }
+        avctx->execute = thread_execute;
+        avctx->execute2 = thread_execute2;
+        return 0;
+    }
+
     pthread_mutex_lock(&c->current_job_lock);
     for (i=0; i<thread_count; i++) {
         if(pthread_create(&c->workers[i], NULL, worker, avctx)) {
@@ -56,11 +56,22 @@ void ff_thread_flush(AVCodecContext *avctx);
  * compatibility with avcodec_decode_video2(). This means the decoder
  * has to consume the full packet.
  *
+ * With FF_THREAD_FRAME_LOW_DELAY, a frame is
+ * returned as soon as it is decoded instead of after thread_count - 1 more
+ * packets, and an empty packet outside of draining waits for the oldest
+ * frame which is still being decoded.
+ *
  * Parameters are the same as avcodec_decode_video2().
  */
 int ff_thread_decode_frame(AVCodecContext *avctx, AVFrame *picture,
                            int *got_picture_ptr, AVPacket *avpkt);
 
+/**
+ * Return the number of frames submitted in low delay mode which have not
+ * been returned by ff_thread_decode_frame() yet.
+ */
+int ff_thread_frames_pending(AVCodecContext *avctx);
+
 /**
  * If the codec defines update_thread_context(), call this
  * when they are ready for the next thread to start decoding
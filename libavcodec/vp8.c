@@ -2493,6 +2493,31 @@ static void vp8_filter_mb_row(AVCodecContext *avctx, void *tdata,
     filter_mb_row(avctx, tdata, jobnr, threadnr, 0);
 }
 
+/**
+ * Pass the lines completed by decoding and filtering MB row mb_y to
+ * draw_horiz_band().
+ */
+static void vp8_draw_horiz_band(AVCodecContext *avctx, VP8Context *s, int mb_y)
+{
+    const AVFrame *src = s->curframe->tf.f;
+    int offset[AV_NUM_DATA_POINTERS] = { 0 };
+    /* filtering a row also modifies the bottom of the one above */
+    int y     = FFMAX(16 * (mb_y - s->deblock_filter), 0);
+    int y_end = mb_y == s->mb_height - 1 ? avctx->height :
+                16 * (mb_y + 1 - s->deblock_filter);
+
+    if (s->invisible || y >= y_end)
+        return;
+
+    offset[0] = y * src->linesize[0];
+    offset[1] =
+    offset[2] = (y >> 1) * src->linesize[1];
+
+    emms_c();
+
+    avctx->draw_horiz_band(avctx, src, offset, y, 3, y_end - y);
+}
+
 static av_always_inline
 int vp78_decode_mb_row_sliced(AVCodecContext *avctx, void *tdata, int jobnr,
                               int threadnr, int is_vp7)
@@ -2518,6 +2543,9 @@ int vp78_decode_mb_row_sliced(AVCodecContext *avctx, void *tdata, int jobnr,
             s->filter_mb_row(avctx, tdata, jobnr, threadnr);
         update_pos(td, mb_y, INT_MAX & 0xFFFF);
 
+        if (avctx->draw_horiz_band)
+            vp8_draw_horiz_band(avctx, s, mb_y);
+
         td->mv_bounds.mv_min.y -= 64 * num_jobs;
         td->mv_bounds.mv_max.y -= 64 * num_jobs;
 
@@ -2854,7 +2882,7 @@ AVCodec ff_vp7_decoder = {
     .init                  = vp7_decode_init,
     .close                 = ff_vp8_decode_free,
     .decode                = vp7_decode_frame,
-    .capabilities          = AV_CODEC_CAP_DR1,
+    .capabilities          = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DRAW_HORIZ_BAND,
     .flush                 = vp8_decode_flush,
 };
 #endif /* CONFIG_VP7_DECODER */
@@ -2870,7 +2898,7 @@ AVCodec ff_vp8_decoder = {
     .close                 = ff_vp8_decode_free,
     .decode                = ff_vp8_decode_frame,
     .capabilities          = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
-                             AV_CODEC_CAP_SLICE_THREADS,
+                             AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_DRAW_HORIZ_BAND,
     .flush                 = vp8_decode_flush,
     .init_thread_copy      = ONLY_IF_THREADS_ENABLED(vp8_decode_init_thread_copy),
     .update_thread_context = ONLY_IF_THREADS_ENABLED(vp8_decode_update_thread_context),
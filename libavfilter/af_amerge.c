@@ -33,6 +33,7 @@
 #include "avfilter.h"
 #include "audio.h"
 #include "bufferqueue.h"
+#include "filters.h"
 #include "internal.h"
 
 #define SWR_CH_MAX 64
@@ -192,7 +193,7 @@ static int request_frame(AVFilterLink *outlink)
     for (i = 0; i < s->nb_inputs; i++)
         if (!s->in[i].nb_samples ||
             /* detect EOF immediately */
-            (ctx->inputs[i]->status_in && !ctx->inputs[i]->status_out))
+            ff_inlink_status_pending(ctx->inputs[i]))
             if ((ret = ff_request_frame(ctx->inputs[i])) < 0)
                 return ret;
     return 0;
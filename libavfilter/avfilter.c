@@ -33,6 +33,7 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/rational.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/time.h"
 
 #define FF_INTERNAL_FIELDS 1
 #include "framequeue.h"
@@ -188,16 +189,47 @@ int avfilter_link_get_channels(AVFilterLink *link)
     return link->channels;
 }
 
-void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
+/**
+ * Tell if filters of the graph may run concurrently, so that the state they
+ * share must be locked, see AVFilterGraphInternal.lock.
+ */
+static int graph_locked(AVFilterGraph *graph)
+{
+    return graph && graph->thread_type & (AVFILTER_THREAD_BRANCH | AVFILTER_THREAD_PIPELINE) &&
+           graph->internal->thread_execute;
+}
+
+static void filter_lock(AVFilterContext *filter)
+{
+    if (graph_locked(filter->graph))
+        ff_mutex_lock(&filter->graph->internal->lock);
+}
+
+static void filter_unlock(AVFilterContext *filter)
+{
+    if (graph_locked(filter->graph))
+        ff_mutex_unlock(&filter->graph->internal->lock);
+}
+
+/* The functions below with a _locked suffix expect the graph lock held. */
+
+static void filter_set_ready_locked(AVFilterContext *filter, unsigned priority)
 {
     filter->ready = FFMAX(filter->ready, priority);
 }
 
+void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
+{
+    filter_lock(filter);
+    filter_set_ready_locked(filter, priority);
+    filter_unlock(filter);
+}
+
 /**
  * Clear frame_blocked_in on all outputs.
  * This is necessary whenever something changes on input.
  */
-static void filter_unblock(AVFilterContext *filter)
+static void filter_unblock_locked(AVFilterContext *filter)
 {
     unsigned i;
 
@@ -205,8 +237,36 @@ static void filter_unblock(AVFilterContext *filter)
         filter->outputs[i]->frame_blocked_in = 0;
 }
 
+static void filter_unblock(AVFilterContext *filter)
+{
+    filter_lock(filter);
+    filter_unblock_locked(filter);
+    filter_unlock(filter);
+}
 
-void ff_avfilter_link_set_in_status(AVFilterLink *link, int status, int64_t pts)
+/**
+ * Tell if the filters on both ends of the link may run concurrently.
+ */
+static int link_pipelined(AVFilterLink *link)
+{
+    AVFilterGraph *graph = link->dst->graph;
+
+    return graph && graph->thread_type & AVFILTER_THREAD_PIPELINE &&
+           graph->internal->thread_execute;
+}
+
+static void update_link_current_pts_locked(AVFilterLink *link, int64_t pts)
+{
+    if (pts == AV_NOPTS_VALUE)
+        return;
+    link->current_pts = pts;
+    link->current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
+    /* TODO use duration */
+    if (link->graph && link->age_index >= 0)
+        ff_avfilter_graph_update_heap(link->graph, link);
+}
+
+static void link_set_in_status_locked(AVFilterLink *link, int status, int64_t pts)
 {
     if (link->status_in == status)
         return;
@@ -214,20 +274,48 @@ void ff_avfilter_link_set_in_status(AVFilterLink *link, int status, int64_t pts)
     link->status_in = status;
     link->status_in_pts = pts;
     link->frame_wanted_out = 0;
+    link->frame_wanted_ahead = 0;
     link->frame_blocked_in = 0;
-    filter_unblock(link->dst);
-    ff_filter_set_ready(link->dst, 200);
+    filter_unblock_locked(link->dst);
+    filter_set_ready_locked(link->dst, 200);
 }
 
-void ff_avfilter_link_set_out_status(AVFilterLink *link, int status, int64_t pts)
+void ff_avfilter_link_set_in_status(AVFilterLink *link, int status, int64_t pts)
+{
+    filter_lock(link->dst);
+    link_set_in_status_locked(link, status, pts);
+    filter_unlock(link->dst);
+}
+
+static void link_set_out_status_locked(AVFilterLink *link, int status, int64_t pts)
 {
     av_assert0(!link->frame_wanted_out);
     av_assert0(!link->status_out);
     link->status_out = status;
     if (pts != AV_NOPTS_VALUE)
-        ff_update_link_current_pts(link, pts);
-    filter_unblock(link->dst);
-    ff_filter_set_ready(link->src, 200);
+        update_link_current_pts_locked(link, pts);
+    filter_unblock_locked(link->dst);
+    filter_set_ready_locked(link->src, 200);
+}
+
+/**
+ * Withdraw a request made by request_ahead_locked(): the destination filter
+ * closing its input did not ask for a frame itself.
+ */
+static void cancel_request_ahead_locked(AVFilterLink *link)
+{
+    if (link->frame_wanted_ahead) {
+        link->frame_wanted_out   = 0;
+        link->frame_wanted_ahead = 0;
+    }
+}
+
+void ff_avfilter_link_set_out_status(AVFilterLink *link, int status, int64_t pts)
+{
+    filter_lock(link->dst);
+    cancel_request_ahead_locked(link);
+    link_set_out_status_locked(link, status, pts);
+    filter_unlock(link->dst);
 }
 
 void avfilter_link_set_closed(AVFilterLink *link, int closed)
@@ -402,11 +490,8 @@ void ff_tlog_link(void *ctx, AVFilterLink *link, int end)
     }
 }
 
-int ff_request_frame(AVFilterLink *link)
+static int request_frame_locked(AVFilterLink *link)
 {
-    FF_TPRINTF_START(NULL, request_frame); ff_tlog_link(NULL, link, 1);
-
-    av_assert1(!link->dst->filter->activate);
     if (link->status_out)
         return link->status_out;
     if (link->status_in) {
@@ -418,29 +503,47 @@ int ff_request_frame(AVFilterLink *link)
             /* Acknowledge status change. Filters using ff_request_frame() will
                handle the change automatically. Filters can also check the
                status directly but none do yet. */
-            ff_avfilter_link_set_out_status(link, link->status_in, link->status_in_pts);
+            link_set_out_status_locked(link, link->status_in, link->status_in_pts);
             return link->status_out;
         }
     }
     link->frame_wanted_out = 1;
-    ff_filter_set_ready(link->src, 100);
+    link->frame_wanted_ahead = 0;
+    filter_set_ready_locked(link->src, 100);
     return 0;
 }
 
+int ff_request_frame(AVFilterLink *link)
+{
+    int ret;
+
+    FF_TPRINTF_START(NULL, request_frame); ff_tlog_link(NULL, link, 1);
+
+    av_assert1(!link->dst->filter->activate);
+    filter_lock(link->dst);
+    ret = request_frame_locked(link);
+    filter_unlock(link->dst);
+    return ret;
+}
+
 static int ff_request_frame_to_filter(AVFilterLink *link)
 {
     int ret = -1;
 
     FF_TPRINTF_START(NULL, request_frame_to_filter); ff_tlog_link(NULL, link, 1);
     /* Assume the filter is blocked, let the method clear it if not */
+    filter_lock(link->src);
     link->frame_blocked_in = 1;
+    filter_unlock(link->src);
     if (link->srcpad->request_frame)
         ret = link->srcpad->request_frame(link);
     else if (link->src->inputs[0])
         ret = ff_request_frame(link->src->inputs[0]);
     if (ret < 0) {
+        filter_lock(link->src);
         if (ret != AVERROR(EAGAIN) && ret != link->status_in)
-            ff_avfilter_link_set_in_status(link, ret, AV_NOPTS_VALUE);
+            link_set_in_status_locked(link, ret, AV_NOPTS_VALUE);
+        filter_unlock(link->src);
         if (ret == AVERROR_EOF)
             ret = 0;
     }
@@ -525,13 +628,9 @@ static int set_enable_expr(AVFilterContext *ctx, const char *expr)
 
 void ff_update_link_current_pts(AVFilterLink *link, int64_t pts)
 {
-    if (pts == AV_NOPTS_VALUE)
-        return;
-    link->current_pts = pts;
-    link->current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
-    /* TODO use duration */
-    if (link->graph && link->age_index >= 0)
-        ff_avfilter_graph_update_heap(link->graph, link);
+    filter_lock(link->dst);
+    update_link_current_pts_locked(link, pts);
+    filter_unlock(link->dst);
 }
 
 int avfilter_process_command(AVFilterContext *filter, const char *cmd, const char *arg, char *res, int res_len, int flags)
@@ -835,6 +934,13 @@ int ff_filter_get_nb_threads(AVFilterContext *ctx)
      return ctx->graph->nb_threads;
 }
 
+int ff_filter_get_nb_jobs(AVFilterContext *ctx, int max_jobs)
+{
+    int nb_threads = ff_filter_get_nb_threads(ctx);
+
+    return FFMIN(nb_threads > 1 ? 4 * nb_threads : 1, max_jobs);
+}
+
 static int process_options(AVFilterContext *ctx, AVDictionary **options,
                            const char *args)
 {
@@ -1157,15 +1263,19 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
         }
     }
 
+    filter_lock(link->dst);
     link->frame_blocked_in = link->frame_wanted_out = 0;
+    link->frame_wanted_ahead = 0;
     link->frame_count_in++;
-    filter_unblock(link->dst);
+    filter_unblock_locked(link->dst);
     ret = ff_framequeue_add(&link->fifo, frame);
+    if (ret >= 0)
+        filter_set_ready_locked(link->dst, 300);
+    filter_unlock(link->dst);
     if (ret < 0) {
         av_frame_free(&frame);
         return ret;
     }
-    ff_filter_set_ready(link->dst, 300);
     return 0;
 
 error:
@@ -1180,8 +1290,8 @@ static int samples_ready(AVFilterLink *link, unsigned min)
             link->status_in);
 }
 
-static int take_samples(AVFilterLink *link, unsigned min, unsigned max,
-                        AVFrame **rframe)
+static int take_samples_locked(AVFilterLink *link, unsigned min, unsigned max,
+                               AVFrame **rframe)
 {
     AVFrame *frame0, *frame, *buf;
     unsigned nb_samples, nb_frames, i, p;
@@ -1246,7 +1356,6 @@ static int ff_filter_frame_to_filter(AVFilterLink *link)
     AVFilterContext *dst = link->dst;
     int ret;
 
-    av_assert1(ff_framequeue_queued_frames(&link->fifo));
     ret = link->min_samples ?
           ff_inlink_consume_samples(link, link->min_samples, link->max_samples, &frame) :
           ff_inlink_consume_frame(link, &frame);
@@ -1306,27 +1415,55 @@ static int forward_status_change(AVFilterContext *filter, AVFilterLink *in)
 
 #define FFERROR_NOT_READY FFERRTAG('N','R','D','Y')
 
-static int ff_filter_activate_default(AVFilterContext *filter)
+enum DefaultAction {
+    ACTION_NONE,
+    ACTION_FILTER_FRAME,
+    ACTION_FORWARD_STATUS,
+    ACTION_REQUEST_FRAME,
+};
+
+static enum DefaultAction default_action_locked(AVFilterContext *filter,
+                                                AVFilterLink **link)
 {
     unsigned i;
 
     for (i = 0; i < filter->nb_inputs; i++) {
         if (samples_ready(filter->inputs[i], filter->inputs[i]->min_samples)) {
-            return ff_filter_frame_to_filter(filter->inputs[i]);
+            *link = filter->inputs[i];
+            return ACTION_FILTER_FRAME;
         }
     }
     for (i = 0; i < filter->nb_inputs; i++) {
         if (filter->inputs[i]->status_in && !filter->inputs[i]->status_out) {
             av_assert1(!ff_framequeue_queued_frames(&filter->inputs[i]->fifo));
-            return forward_status_change(filter, filter->inputs[i]);
+            *link = filter->inputs[i];
+            return ACTION_FORWARD_STATUS;
         }
     }
     for (i = 0; i < filter->nb_outputs; i++) {
         if (filter->outputs[i]->frame_wanted_out &&
             !filter->outputs[i]->frame_blocked_in) {
-            return ff_request_frame_to_filter(filter->outputs[i]);
+            *link = filter->outputs[i];
+            return ACTION_REQUEST_FRAME;
         }
     }
+    return ACTION_NONE;
+}
+
+static int ff_filter_activate_default(AVFilterContext *filter)
+{
+    AVFilterLink *link = NULL;
+    enum DefaultAction action;
+
+    filter_lock(filter);
+    action = default_action_locked(filter, &link);
+    filter_unlock(filter);
+
+    switch (action) {
+    case ACTION_FILTER_FRAME:    return ff_filter_frame_to_filter(link);
+    case ACTION_FORWARD_STATUS:  return forward_status_change(filter, link);
+    case ACTION_REQUEST_FRAME:   return ff_request_frame_to_filter(link);
+    }
     return FFERROR_NOT_READY;
 }
 
@@ -1467,20 +1604,37 @@ static int ff_filter_activate_default(AVFilterContext *filter)
 
 int ff_filter_activate(AVFilterContext *filter)
 {
+    int64_t start = 0;
     int ret;
 
     /* Generic timeline support is not yet implemented but should be easy */
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
+    filter_lock(filter);
     filter->ready = 0;
+    filter_unlock(filter);
+    if (filter->graph->timing)
+        start = av_gettime_relative();
     ret = filter->filter->activate ? filter->filter->activate(filter) :
           ff_filter_activate_default(filter);
+    if (filter->graph->timing)
+        filter->internal->activate_time += av_gettime_relative() - start;
+    filter->internal->nb_activations++;
     if (ret == FFERROR_NOT_READY)
         ret = 0;
     return ret;
 }
 
-int ff_inlink_acknowledge_status(AVFilterLink *link, int *rstatus, int64_t *rpts)
+void avfilter_get_timing(const AVFilterContext *ctx,
+                         int64_t *nb_activations, int64_t *total_time)
+{
+    if (nb_activations)
+        *nb_activations = ctx->internal->nb_activations;
+    if (total_time)
+        *total_time = ctx->internal->activate_time;
+}
+
+static int acknowledge_status_locked(AVFilterLink *link, int *rstatus, int64_t *rpts)
 {
     *rpts = link->current_pts;
     if (ff_framequeue_queued_frames(&link->fifo))
@@ -1490,23 +1644,76 @@ int ff_inlink_acknowledge_status(AVFilterLink *link, int *rstatus, int64_t *rpts
     if (!link->status_in)
         return *rstatus = 0;
     *rstatus = link->status_out = link->status_in;
-    ff_update_link_current_pts(link, link->status_in_pts);
+    update_link_current_pts_locked(link, link->status_in_pts);
     *rpts = link->current_pts;
     return 1;
 }
 
+int ff_inlink_acknowledge_status(AVFilterLink *link, int *rstatus, int64_t *rpts)
+{
+    int ret;
+
+    filter_lock(link->dst);
+    ret = acknowledge_status_locked(link, rstatus, rpts);
+    filter_unlock(link->dst);
+    return ret;
+}
+
 int ff_inlink_check_available_frame(AVFilterLink *link)
 {
-    return ff_framequeue_queued_frames(&link->fifo) > 0;
+    int ret;
+
+    filter_lock(link->dst);
+    ret = ff_framequeue_queued_frames(&link->fifo) > 0;
+    filter_unlock(link->dst);
+    return ret;
 }
 
-int ff_inlink_check_available_samples(AVFilterLink *link, unsigned min)
+static int check_available_samples_locked(AVFilterLink *link, unsigned min)
 {
     uint64_t samples = ff_framequeue_queued_samples(&link->fifo);
     av_assert1(min);
     return samples >= min || (link->status_in && samples);
 }
 
+int ff_inlink_check_available_samples(AVFilterLink *link, unsigned min)
+{
+    int ret;
+
+    filter_lock(link->dst);
+    ret = check_available_samples_locked(link, min);
+    filter_unlock(link->dst);
+    return ret;
+}
+
+/**
+ * In pipelined graphs, ask for the next frame as soon as the queue is empty,
+ * so that the source filter produces it while this one is processed.
+ * Frames are only asked for ahead while a frame is wanted on an output of
+ * the destination filter, i.e. while the frame just taken answers a request
+ * from downstream, which bounds the number of frames in flight to about one
+ * per link. Sinks always ask for the next frame once the application took
+ * one.
+ */
+static void request_ahead_locked(AVFilterLink *link)
+{
+    AVFilterContext *dst = link->dst;
+    unsigned i;
+
+    if (!link_pipelined(link) ||
+        ff_framequeue_queued_frames(&link->fifo) ||
+        link->frame_wanted_out || link->status_in || link->status_out)
+        return;
+    for (i = 0; i < dst->nb_outputs; i++)
+        if (dst->outputs[i]->frame_wanted_out > 0)
+            break;
+    if (dst->nb_outputs && i == dst->nb_outputs)
+        return;
+    link->frame_wanted_out = 1;
+    link->frame_wanted_ahead = 1;
+    filter_set_ready_locked(link->src, 100);
+}
+
 static void consume_update(AVFilterLink *link, const AVFrame *frame)
 {
     ff_update_link_current_pts(link, frame->pts);
@@ -1520,9 +1727,14 @@ int ff_inlink_consume_frame(AVFilterLink *link, AVFrame **rframe)
     AVFrame *frame;
 
     *rframe = NULL;
-    if (!ff_inlink_check_available_frame(link))
+    filter_lock(link->dst);
+    if (!ff_framequeue_queued_frames(&link->fifo)) {
+        filter_unlock(link->dst);
         return 0;
+    }
     frame = ff_framequeue_take(&link->fifo);
+    request_ahead_locked(link);
+    filter_unlock(link->dst);
     consume_update(link, frame);
     *rframe = frame;
     return 1;
@@ -1536,11 +1748,17 @@ int ff_inlink_consume_samples(AVFilterLink *link, unsigned min, unsigned max,
 
     av_assert1(min);
     *rframe = NULL;
-    if (!ff_inlink_check_available_samples(link, min))
+    filter_lock(link->dst);
+    if (!check_available_samples_locked(link, min)) {
+        filter_unlock(link->dst);
         return 0;
+    }
     if (link->status_in)
         min = FFMIN(min, ff_framequeue_queued_samples(&link->fifo));
-    ret = take_samples(link, min, link->max_samples, &frame);
+    ret = take_samples_locked(link, min, link->max_samples, &frame);
+    if (ret >= 0)
+        request_ahead_locked(link);
+    filter_unlock(link->dst);
     if (ret < 0)
         return ret;
     consume_update(link, frame);
@@ -1632,10 +1850,63 @@ int ff_inlink_evaluate_timeline_at_frame(AVFilterLink *link, const AVFrame *fram
 
 void ff_inlink_request_frame(AVFilterLink *link)
 {
+    filter_lock(link->dst);
     av_assert1(!link->status_in);
     av_assert1(!link->status_out);
     link->frame_wanted_out = 1;
-    ff_filter_set_ready(link->src, 100);
+    link->frame_wanted_ahead = 0;
+    filter_set_ready_locked(link->src, 100);
+    filter_unlock(link->dst);
+}
+
+size_t ff_inlink_queued_frames(AVFilterLink *link)
+{
+    size_t ret;
+
+    filter_lock(link->dst);
+    ret = ff_framequeue_queued_frames(&link->fifo);
+    filter_unlock(link->dst);
+    return ret;
+}
+
+int ff_inlink_frame_wanted(AVFilterLink *link)
+{
+    int ret;
+
+    filter_lock(link->dst);
+    ret = link->frame_wanted_out;
+    filter_unlock(link->dst);
+    return ret;
+}
+
+int ff_inlink_status_pending(AVFilterLink *link)
+{
+    int ret;
+
+    filter_lock(link->dst);
+    ret = link->status_in && !link->status_out;
+    filter_unlock(link->dst);
+    return ret;
+}
+
+int ff_inlink_get_status(AVFilterLink *link)
+{
+    int ret;
+
+    filter_lock(link->dst);
+    ret = link->status_out;
+    filter_unlock(link->dst);
+    return ret;
+}
+
+int ff_outlink_get_status(AVFilterLink *link)
+{
+    int ret;
+
+    filter_lock(link->dst);
+    ret = link->status_in;
+    filter_unlock(link->dst);
+    return ret;
 }
 
 const AVClass *avfilter_get_class(void)
@@ -317,6 +317,19 @@ typedef struct AVFilter {
  */
 #define AVFILTER_THREAD_SLICE (1 << 0)
 
+/**
+ * Run filters on independent branches of a graph concurrently, e.g. the
+ * outputs of split or asplit. Only meaningful for AVFilterGraph.thread_type.
+ */
+#define AVFILTER_THREAD_BRANCH (1 << 1)
+
+/**
+ * Run the filters of a graph concurrently on different frames, each filter
+ * processing the next frame while the following filters process the previous
+ * ones. Only meaningful for AVFilterGraph.thread_type.
+ */
+#define AVFILTER_THREAD_PIPELINE (1 << 2)
+
 typedef struct AVFilterInternal AVFilterInternal;
 
 /** An instance of a filter */
@@ -611,6 +624,13 @@ struct AVFilterLink {
      */
     int status_out;
 
+    /**
+     * Set while frame_wanted_out was only set by libavfilter to have the
+     * source produce the next frame ahead in a pipelined graph, and not by
+     * the destination filter.
+     */
+    int frame_wanted_ahead;
+
 #endif /* FF_INTERNAL_FIELDS */
 
 };
@@ -662,6 +682,18 @@ int avfilter_config_links(AVFilterContext *filter);
  */
 int avfilter_process_command(AVFilterContext *filter, const char *cmd, const char *arg, char *res, int res_len, int flags);
 
+/**
+ * Get the time spent processing in a filter instance.
+ *
+ * @param nb_activations if not NULL, set to the number of times the filter
+ *                       was activated by the graph
+ * @param total_time     if not NULL, set to the total time spent in those
+ *                       activations, in microseconds; only measured if the
+ *                       "timing" option of the graph is set, 0 otherwise
+ */
+void avfilter_get_timing(const AVFilterContext *ctx,
+                         int64_t *nb_activations, int64_t *total_time);
+
 /** Initialize the filter system. Register all builtin filters. */
 void avfilter_register_all(void);
 
@@ -907,6 +939,34 @@ typedef struct AVFilterGraph {
     int sink_links_count;
 
     unsigned disable_auto_convert;
+
+    /**
+     * Where the threads used by filters in this graph come from, one of the
+     * AVFILTER_THREAD_POOL_* values. With AVFILTER_THREAD_POOL_SHARED,
+     * nb_threads sets how many jobs of this graph run at once on a
+     * process-wide pool of threads, one per CPU core, shared with other
+     * graphs and codec contexts.
+     *
+     * With AVFILTER_THREAD_BRANCH or AVFILTER_THREAD_PIPELINE, filters
+     * running at the same time can only use slice threading with
+     * AVFILTER_THREAD_POOL_SHARED. The private threads are all busy running
+     * the filters then, and their slices run serially.
+     *
+     * May be set by the caller before adding any filters to the filtergraph.
+     * Access ONLY through AVOptions.
+     */
+    int thread_pool;
+#define AVFILTER_THREAD_POOL_PRIVATE 0 ///< threads owned by the graph
+#define AVFILTER_THREAD_POOL_SHARED  1 ///< process-wide shared pool
+
+    /**
+     * If nonzero, measure the time spent in each filter activation, as
+     * reported by avfilter_get_timing(). Off by default, since it reads the
+     * clock twice per activation.
+     *
+     * Access ONLY through AVOptions.
+     */
+    int timing;
 } AVFilterGraph;
 
 /**
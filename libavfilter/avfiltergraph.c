@@ -47,8 +47,16 @@ static const AVOption filtergraph_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
         { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, FLAGS, "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = FLAGS, .unit = "thread_type" },
+        { "branch", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_BRANCH }, .flags = FLAGS, .unit = "thread_type" },
+        { "pipeline", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_PIPELINE }, .flags = FLAGS, .unit = "thread_type" },
     { "threads",     "Maximum number of threads", OFFSET(nb_threads),
         AV_OPT_TYPE_INT,   { .i64 = 0 }, 0, INT_MAX, FLAGS },
+    { "thread_pool", "Where the threads come from", OFFSET(thread_pool),
+        AV_OPT_TYPE_INT,   { .i64 = AVFILTER_THREAD_POOL_PRIVATE }, 0, 1, FLAGS, "thread_pool" },
+        { "private", "threads owned by the graph", 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_POOL_PRIVATE }, .flags = FLAGS, .unit = "thread_pool" },
+        { "shared",  "process-wide shared pool",   0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_POOL_SHARED  }, .flags = FLAGS, .unit = "thread_pool" },
+    { "timing",      "Measure the time spent in each filter", OFFSET(timing),
+        AV_OPT_TYPE_BOOL,  { .i64 = 0 }, 0, 1, FLAGS },
     {"scale_sws_opts"       , "default scale filter options"        , OFFSET(scale_sws_opts)        ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, FLAGS },
     {"aresample_swr_opts"   , "default aresample filter options"    , OFFSET(aresample_swr_opts)    ,
@@ -75,6 +83,11 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     graph->nb_threads  = 1;
     return 0;
 }
+
+int ff_graph_run_pipeline(AVFilterGraph *graph)
+{
+    return AVERROR(ENOSYS);
+}
 #endif
 
 AVFilterGraph *avfilter_graph_alloc(void)
@@ -92,6 +105,7 @@ AVFilterGraph *avfilter_graph_alloc(void)
     ret->av_class = &filtergraph_class;
     av_opt_set_defaults(ret);
     ff_framequeue_global_init(&ret->internal->frame_queues);
+    ff_mutex_init(&ret->internal->lock, NULL);
 
     return ret;
 }
@@ -132,6 +146,7 @@ void avfilter_graph_free(AVFilterGraph **graph)
     av_freep(&(*graph)->resample_lavr_opts);
 #endif
     av_freep(&(*graph)->filters);
+    ff_mutex_destroy(&(*graph)->internal->lock);
     av_freep(&(*graph)->internal);
     av_freep(graph);
 }
@@ -1434,6 +1449,71 @@ int avfilter_graph_request_oldest(AVFilterGraph *graph)
     return 0;
 }
 
+#define MAX_BRANCHES 16
+
+typedef struct BranchJobs {
+    AVFilterContext *filters[MAX_BRANCHES];
+    int nb_filters;
+} BranchJobs;
+
+static int filters_adjacent(AVFilterContext *a, AVFilterContext *b)
+{
+    unsigned i;
+
+    for (i = 0; i < a->nb_inputs; i++)
+        if (a->inputs[i] && a->inputs[i]->src == b)
+            return 1;
+    for (i = 0; i < a->nb_outputs; i++)
+        if (a->outputs[i] && a->outputs[i]->dst == b)
+            return 1;
+    return 0;
+}
+
+static int activate_branch(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BranchJobs *b = arg;
+
+    return ff_filter_activate(b->filters[jobnr]);
+}
+
+/**
+ * Activate the ready filter with the highest priority, along with other
+ * ready filters not linked to it nor to each other, e.g. filters on the
+ * different outputs of a split. Filters only touch their own links, so
+ * non-adjacent filters can run concurrently; the state they may share
+ * through a common neighbour is protected by the graph lock.
+ */
+static int run_branches(AVFilterGraph *graph, AVFilterContext *first)
+{
+    BranchJobs b;
+    int rets[MAX_BRANCHES];
+    int max = FFMIN(graph->nb_threads, MAX_BRANCHES);
+    unsigned i;
+    int j;
+
+    b.filters[0]  = first;
+    b.nb_filters = 1;
+    for (i = 0; i < graph->nb_filters && b.nb_filters < max; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        if (!f->ready || f == first)
+            continue;
+        for (j = 0; j < b.nb_filters; j++)
+            if (filters_adjacent(f, b.filters[j]))
+                break;
+        if (j == b.nb_filters)
+            b.filters[b.nb_filters++] = f;
+    }
+    if (b.nb_filters == 1)
+        return ff_filter_activate(first);
+
+    graph->internal->thread_execute(first, activate_branch, &b, rets, b.nb_filters);
+    for (j = 0; j < b.nb_filters; j++)
+        if (rets[j] < 0)
+            return rets[j];
+    return 0;
+}
+
 int ff_filter_graph_run_once(AVFilterGraph *graph)
 {
     AVFilterContext *filter;
@@ -1446,5 +1526,11 @@ int ff_filter_graph_run_once(AVFilterGraph *graph)
             filter = graph->filters[i];
     if (!filter->ready)
         return AVERROR(EAGAIN);
+    if (graph->thread_type & AVFILTER_THREAD_PIPELINE &&
+        graph->internal->thread_execute)
+        return ff_graph_run_pipeline(graph);
+    if (graph->thread_type & AVFILTER_THREAD_BRANCH &&
+        graph->internal->thread_execute)
+        return run_branches(graph, filter);
     return ff_filter_activate(filter);
 }
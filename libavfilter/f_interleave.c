@@ -32,6 +32,7 @@
 
 #include "avfilter.h"
 #include "bufferqueue.h"
+#include "filters.h"
 #include "formats.h"
 #include "internal.h"
 #include "audio.h"
@@ -63,7 +64,7 @@ inline static int push_frame(AVFilterContext *ctx)
     for (i = 0; i < ctx->nb_inputs; i++) {
         struct FFBufQueue *q = &s->queues[i];
 
-        if (!q->available && !ctx->inputs[i]->status_out)
+        if (!q->available && !ff_inlink_get_status(ctx->inputs[i]))
             return 0;
         if (q->available) {
             frame = ff_bufqueue_peek(q, 0);
@@ -194,7 +195,7 @@ static int request_frame(AVFilterLink *outlink)
     int i, ret;
 
     for (i = 0; i < ctx->nb_inputs; i++) {
-        if (!s->queues[i].available && !ctx->inputs[i]->status_out) {
+        if (!s->queues[i].available && !ff_inlink_get_status(ctx->inputs[i])) {
             ret = ff_request_frame(ctx->inputs[i]);
             if (ret != AVERROR_EOF)
                 return ret;
@@ -23,6 +23,10 @@
 
 /**
  * Filters implementation helper functions
+ *
+ * In graphs running with AVFILTER_THREAD_PIPELINE, the filters on both ends
+ * of a link run concurrently: the frame queue and the status fields of a
+ * link must then only be accessed through the functions below.
  */
 
 #include "avfilter.h"
@@ -134,4 +138,32 @@ int ff_inlink_acknowledge_status(AVFilterLink *link, int *rstatus, int64_t *rpts
  */
 void ff_inlink_request_frame(AVFilterLink *link);
 
+/**
+ * Get the number of frames queued on the link.
+ */
+size_t ff_inlink_queued_frames(AVFilterLink *link);
+
+/**
+ * Test if a frame was requested on the link and not yet sent.
+ */
+int ff_inlink_frame_wanted(AVFilterLink *link);
+
+/**
+ * Test if a status change was queued on the link by the source filter and
+ * not yet acknowledged by the destination filter.
+ */
+int ff_inlink_status_pending(AVFilterLink *link);
+
+/**
+ * Get the status of the link as acknowledged by the destination filter.
+ * @return  0 while the link is open, EOF or an error code otherwise
+ */
+int ff_inlink_get_status(AVFilterLink *link);
+
+/**
+ * Get the status of an output link, as set by the filter itself.
+ * @return  0 while the link is open, EOF or an error code otherwise
+ */
+int ff_outlink_get_status(AVFilterLink *link);
+
 #endif /* AVFILTER_FILTERS_H */
@@ -24,6 +24,7 @@
 #include "libavutil/avassert.h"
 #include "avfilter.h"
 #include "bufferqueue.h"
+#include "filters.h"
 #include "framesync.h"
 #include "internal.h"
 
@@ -328,8 +329,8 @@ int ff_framesync_request_frame(FFFrameSync *fs, AVFilterLink *outlink)
     input = fs->in_request;
     /* Detect status change early */
     for (i = 0; i < fs->nb_in; i++)
-        if (!ff_framequeue_queued_frames(&ctx->inputs[i]->fifo) &&
-            ctx->inputs[i]->status_in && !ctx->inputs[i]->status_out)
+        if (!ff_inlink_queued_frames(ctx->inputs[i]) &&
+            ff_inlink_status_pending(ctx->inputs[i]))
             input = i;
     ret = ff_request_frame(ctx->inputs[input]);
     if (ret == AVERROR_EOF) {
@@ -25,6 +25,7 @@
  */
 
 #include "libavutil/internal.h"
+#include "libavutil/thread.h"
 #include "avfilter.h"
 #include "avfiltergraph.h"
 #include "formats.h"
@@ -149,10 +150,20 @@ struct AVFilterGraphInternal {
     void *thread;
     avfilter_execute_func *thread_execute;
     FFFrameQueueGlobal frame_queues;
+    /**
+     * Protects the state shared by neighbouring filters (ready, the state and
+     * frame queues of links and the sink heap) while filters run on several
+     * threads. Only taken in graphs running with AVFILTER_THREAD_BRANCH or
+     * AVFILTER_THREAD_PIPELINE.
+     */
+    AVMutex lock;
 };
 
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+    int64_t nb_activations;
+    int64_t activate_time;      ///< total time spent in activate, in microseconds
+    int running;                ///< being activated, protected by the graph lock
 };
 
 /**
@@ -419,4 +430,13 @@ static inline int ff_norm_qscale(int qscale, int type)
  */
 int ff_filter_get_nb_threads(AVFilterContext *ctx);
 
+/**
+ * Get the number of jobs to split some work into for slice threading.
+ * Several jobs per thread are used, so that threads finishing their jobs
+ * early can take over jobs of the others when the cost per job is uneven.
+ *
+ * @param max_jobs maximum useful number of jobs, e.g. the number of rows
+ */
+int ff_filter_get_nb_jobs(AVFilterContext *ctx, int max_jobs);
+
 #endif /* AVFILTER_INTERNAL_H */
@@ -27,16 +27,41 @@
 #include "libavutil/cpu.h"
 #include "libavutil/mem.h"
 #include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
 
 #include "avfilter.h"
 #include "internal.h"
 #include "thread.h"
 
+/**
+ * Jobs not started yet of one thread. A thread runs the jobs of its range in
+ * order and steals the upper half of the largest other range once its own
+ * range is empty, so that threads given cheap jobs help the others.
+ */
+typedef struct JobRange {
+    struct ThreadContext *c;    ///< passed to the worker thread of this range
+    pthread_mutex_t lock;
+    int next;
+    int end;
+} JobRange;
+
+/**
+ * A thread inside an execute() of the graph, as its caller or running one of
+ * its jobs. Entries live on the stack of their thread, the most recent entry
+ * of a thread being the closest to the head of the list.
+ */
+typedef struct ThreadEntry {
+    pthread_t thread;
+    int depth;                  ///< number of execute() calls the thread is in
+    struct ThreadEntry *next;
+} ThreadEntry;
+
 typedef struct ThreadContext {
     AVFilterGraph *graph;
 
     int nb_threads;
-    pthread_t *workers;
+    pthread_t *workers;         ///< nb_threads - 1 workers, the caller of execute() runs too
+    JobRange *ranges;           ///< one per thread, the caller's is last
     avfilter_action_func *func;
 
     /* per-execute parameters */
@@ -48,46 +73,172 @@ typedef struct ThreadContext {
     pthread_cond_t last_job_cond;
     pthread_cond_t current_job_cond;
     pthread_mutex_t current_job_lock;
-    int current_job;
+    int nb_created;             ///< number of workers created, only used by the creator
+    int nb_finished;            ///< workers done with the current execute
     unsigned int current_execute;
     int done;
+
+    /* only one execute() at a time runs on the workers */
+    pthread_mutex_t execute_lock;
+
+    pthread_mutex_t threads_lock;
+    ThreadEntry *threads;       ///< threads inside an execute(), protected by threads_lock
+
+    /**
+     * Set when running on the shared pool instead of workers. The jobs of
+     * execute() calls made outside any execute() of the graph, e.g. branch
+     * or pipeline jobs, run for pool[0], and the jobs of calls made from
+     * those jobs, e.g. by filters activated on a branch, for pool[1], so that
+     * jobs never wait for thread slots held by their parents.
+     */
+    ThreadPoolClient *pool[2];
 } ThreadContext;
 
-static void* attribute_align_arg worker(void *v)
+typedef struct PoolExecute {
+    ThreadContext *c;
+    AVFilterContext *ctx;
+    avfilter_action_func *func;
+    void *arg;
+    int *rets;
+    int nb_jobs;
+    int depth;                  ///< depth of the threads running the jobs
+} PoolExecute;
+
+static void enter_thread(ThreadContext *c, ThreadEntry *e, int depth)
 {
-    ThreadContext *c = v;
-    int our_job      = c->nb_jobs;
-    int nb_threads   = c->nb_threads;
-    unsigned int last_execute = 0;
-    int ret, self_id;
+    e->thread = pthread_self();
+    e->depth  = depth;
+    pthread_mutex_lock(&c->threads_lock);
+    e->next    = c->threads;
+    c->threads = e;
+    pthread_mutex_unlock(&c->threads_lock);
+}
 
-    pthread_mutex_lock(&c->current_job_lock);
-    self_id = c->current_job++;
+static void leave_thread(ThreadContext *c, ThreadEntry *e)
+{
+    ThreadEntry **p;
+
+    pthread_mutex_lock(&c->threads_lock);
+    for (p = &c->threads; *p != e; p = &(*p)->next)
+        ;
+    *p = e->next;
+    pthread_mutex_unlock(&c->threads_lock);
+}
+
+/**
+ * @return the number of execute() calls the calling thread is in, 0 if it is
+ *         not running inside an execute() of the graph
+ */
+static int thread_depth(ThreadContext *c)
+{
+    pthread_t self = pthread_self();
+    ThreadEntry *e;
+    int depth = 0;
+
+    pthread_mutex_lock(&c->threads_lock);
+    for (e = c->threads; e; e = e->next) {
+        if (pthread_equal(e->thread, self)) {
+            depth = e->depth;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&c->threads_lock);
+    return depth;
+}
+
+static int take_job(JobRange *r)
+{
+    int job = -1;
+
+    pthread_mutex_lock(&r->lock);
+    if (r->next < r->end)
+        job = r->next++;
+    pthread_mutex_unlock(&r->lock);
+    return job;
+}
 
+static int steal_jobs(ThreadContext *c, JobRange *own)
+{
     for (;;) {
-        while (our_job >= c->nb_jobs) {
-            if (c->current_job == nb_threads + c->nb_jobs)
-                pthread_cond_signal(&c->last_job_cond);
-
-            while (last_execute == c->current_execute && !c->done)
-                pthread_cond_wait(&c->current_job_cond, &c->current_job_lock);
-            last_execute = c->current_execute;
-            our_job = self_id;
-
-            if (c->done) {
-                pthread_mutex_unlock(&c->current_job_lock);
-                return NULL;
+        JobRange *victim = NULL;
+        int i, start, end, left = 0;
+
+        for (i = 0; i < c->nb_threads; i++) {
+            JobRange *r = &c->ranges[i];
+            int n;
+
+            pthread_mutex_lock(&r->lock);
+            n = r->end - r->next;
+            pthread_mutex_unlock(&r->lock);
+            if (n > left) {
+                left   = n;
+                victim = r;
             }
         }
+        if (!victim)
+            return 0;
+
+        pthread_mutex_lock(&victim->lock);
+        left  = victim->end - victim->next;
+        end   = victim->end;
+        start = end - (left + 1) / 2;
+        if (left > 0)
+            victim->end = start;
+        pthread_mutex_unlock(&victim->lock);
+
+        if (left > 0) {
+            pthread_mutex_lock(&own->lock);
+            own->next = start;
+            own->end  = end;
+            pthread_mutex_unlock(&own->lock);
+            return 1;
+        }
+    }
+}
+
+static void run_jobs(ThreadContext *c, int self)
+{
+    JobRange *own = &c->ranges[self];
+
+    do {
+        int job, ret;
+
+        while ((job = take_job(own)) >= 0) {
+            ret = c->func(c->ctx, c->arg, job, c->nb_jobs);
+            if (c->rets)
+                c->rets[job] = ret;
+        }
+    } while (steal_jobs(c, own));
+}
+
+static void* attribute_align_arg worker(void *v)
+{
+    JobRange *range = v;
+    ThreadContext *c = range->c;
+    unsigned int last_execute = 0;
+    int self_id = range - c->ranges;
+    ThreadEntry entry;
+
+    pthread_mutex_lock(&c->current_job_lock);
+    for (;;) {
+        while (last_execute == c->current_execute && !c->done)
+            pthread_cond_wait(&c->current_job_cond, &c->current_job_lock);
+        if (c->done)
+            break;
+        last_execute = c->current_execute;
         pthread_mutex_unlock(&c->current_job_lock);
 
-        ret = c->func(c->ctx, c->arg, our_job, c->nb_jobs);
-        if (c->rets)
-            c->rets[our_job % c->nb_jobs] = ret;
+        enter_thread(c, &entry, 1);
+        run_jobs(c, self_id);
+        leave_thread(c, &entry);
 
         pthread_mutex_lock(&c->current_job_lock);
-        our_job = c->current_job++;
+        if (++c->nb_finished == c->nb_threads - 1)
+            pthread_cond_signal(&c->last_job_cond);
     }
+    pthread_mutex_unlock(&c->current_job_lock);
+
+    return NULL;
 }
 
 static void slice_thread_uninit(ThreadContext *c)
@@ -99,51 +250,184 @@ static void slice_thread_uninit(ThreadContext *c)
     pthread_cond_broadcast(&c->current_job_cond);
     pthread_mutex_unlock(&c->current_job_lock);
 
-    for (i = 0; i < c->nb_threads; i++)
+    for (i = 0; i < c->nb_created; i++)
          pthread_join(c->workers[i], NULL);
 
+    for (i = 0; i < c->nb_threads; i++)
+        pthread_mutex_destroy(&c->ranges[i].lock);
     pthread_mutex_destroy(&c->current_job_lock);
+    pthread_mutex_destroy(&c->execute_lock);
+    pthread_mutex_destroy(&c->threads_lock);
     pthread_cond_destroy(&c->current_job_cond);
     pthread_cond_destroy(&c->last_job_cond);
+    av_freep(&c->ranges);
     av_freep(&c->workers);
 }
 
-static void slice_thread_park_workers(ThreadContext *c)
+static int execute_serial(AVFilterContext *ctx, avfilter_action_func *func,
+                          void *arg, int *ret, int nb_jobs)
 {
-    while (c->current_job != c->nb_threads + c->nb_jobs)
-        pthread_cond_wait(&c->last_job_cond, &c->current_job_lock);
-    pthread_mutex_unlock(&c->current_job_lock);
+    int i;
+
+    for (i = 0; i < nb_jobs; i++) {
+        int r = func(ctx, arg, i, nb_jobs);
+        if (ret)
+            ret[i] = r;
+    }
+    return 0;
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
                           void *arg, int *ret, int nb_jobs)
 {
     ThreadContext *c = ctx->graph->internal->thread;
+    ThreadEntry entry;
+    int i;
 
     if (nb_jobs <= 0)
         return 0;
 
+    /* the workers are busy with the jobs of the outer call when nested, e.g.
+     * for a filter activated on a graph branch */
+    if (nb_jobs == 1 || thread_depth(c))
+        return execute_serial(ctx, func, arg, ret, nb_jobs);
+
+    pthread_mutex_lock(&c->execute_lock);
+    enter_thread(c, &entry, 1);
     pthread_mutex_lock(&c->current_job_lock);
 
-    c->current_job = c->nb_threads;
     c->nb_jobs     = nb_jobs;
     c->ctx         = ctx;
     c->arg         = arg;
     c->func        = func;
     c->rets        = ret;
+    for (i = 0; i < c->nb_threads; i++) {
+        c->ranges[i].next = (int64_t)nb_jobs *  i      / c->nb_threads;
+        c->ranges[i].end  = (int64_t)nb_jobs * (i + 1) / c->nb_threads;
+    }
+    c->nb_finished = 0;
     c->current_execute++;
 
     pthread_cond_broadcast(&c->current_job_cond);
+    pthread_mutex_unlock(&c->current_job_lock);
+
+    run_jobs(c, c->nb_threads - 1);
+
+    pthread_mutex_lock(&c->current_job_lock);
+    while (c->nb_finished < c->nb_threads - 1)
+        pthread_cond_wait(&c->last_job_cond, &c->current_job_lock);
+    pthread_mutex_unlock(&c->current_job_lock);
 
-    slice_thread_park_workers(c);
+    leave_thread(c, &entry);
+    pthread_mutex_unlock(&c->execute_lock);
 
     return 0;
 }
 
-static int thread_init_internal(ThreadContext *c, int nb_threads)
+static void pool_job(void *priv, int jobnr, int threadnr)
 {
-    int i, ret;
+    PoolExecute *e = priv;
+    ThreadEntry entry;
+    int ret;
+
+    enter_thread(e->c, &entry, e->depth);
+    ret = e->func(e->ctx, e->arg, jobnr, e->nb_jobs);
+    if (e->rets)
+        e->rets[jobnr] = ret;
+    leave_thread(e->c, &entry);
+}
+
+static int pool_execute(AVFilterContext *ctx, avfilter_action_func *func,
+                        void *arg, int *ret, int nb_jobs)
+{
+    ThreadContext *c = ctx->graph->internal->thread;
+    int depth = thread_depth(c);
+    PoolExecute e = {
+        .c       = c,
+        .ctx     = ctx,
+        .func    = func,
+        .arg     = arg,
+        .rets    = ret,
+        .nb_jobs = nb_jobs,
+        .depth   = depth + 1,
+    };
+    ThreadPoolTask task = { .func = pool_job, .priv = &e, .nb_jobs = nb_jobs };
+
+    /* calls from different threads share the pool, but jobs nested twice
+     * would wait for thread slots held by their parents */
+    if (nb_jobs == 1 || depth >= FF_ARRAY_ELEMS(c->pool))
+        return execute_serial(ctx, func, arg, ret, nb_jobs);
+
+    avpriv_threadpool_execute(c->pool[depth], &task);
+
+    return 0;
+}
+
+typedef struct PipelineRun {
+    AVFilterGraph *graph;
+    int ret;
+} PipelineRun;
+
+static AVFilterContext *next_ready_filter(AVFilterGraph *graph)
+{
+    AVFilterContext *filter = NULL;
+    unsigned i;
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        if (f->ready && !f->internal->running &&
+            (!filter || f->ready > filter->ready))
+            filter = f;
+    }
+    return filter;
+}
+
+/**
+ * Activate ready filters until none is left that is not already running.
+ * A worker never waits for the activations running on other threads: the
+ * thread finishing an activation looks for more work itself, so that once
+ * all workers returned no filter is ready. This keeps the jobs from holding
+ * threads of a shared pool while idle.
+ */
+static int pipeline_worker(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PipelineRun *run = arg;
+    AVFilterGraph *graph = run->graph;
+    AVMutex *lock = &graph->internal->lock;
+    AVFilterContext *filter;
+
+    ff_mutex_lock(lock);
+    while (!run->ret && (filter = next_ready_filter(graph))) {
+        int ret;
+
+        filter->internal->running = 1;
+        ff_mutex_unlock(lock);
 
+        ret = ff_filter_activate(filter);
+
+        ff_mutex_lock(lock);
+        filter->internal->running = 0;
+        if (ret < 0 && !run->ret)
+            run->ret = ret;
+    }
+    ff_mutex_unlock(lock);
+
+    return 0;
+}
+
+int ff_graph_run_pipeline(AVFilterGraph *graph)
+{
+    PipelineRun run = { .graph = graph };
+
+    graph->internal->thread_execute(graph->filters[0], pipeline_worker, &run,
+                                    NULL, graph->nb_threads);
+
+    return run.ret;
+}
+
+static int get_nb_threads(int nb_threads)
+{
     if (!nb_threads) {
         int nb_cpus = av_cpu_count();
         // use number of cores + 1 as thread count if there is more than one
@@ -152,36 +436,50 @@ static int thread_init_internal(ThreadContext *c, int nb_threads)
         else
             nb_threads = 1;
     }
+    return nb_threads;
+}
 
+static int thread_init_internal(ThreadContext *c, int nb_threads)
+{
+    int i, ret;
+
+    nb_threads = get_nb_threads(nb_threads);
     if (nb_threads <= 1)
         return 1;
 
     c->nb_threads = nb_threads;
-    c->workers = av_mallocz_array(sizeof(*c->workers), nb_threads);
-    if (!c->workers)
+    c->workers = av_mallocz_array(sizeof(*c->workers), nb_threads - 1);
+    c->ranges  = av_mallocz_array(sizeof(*c->ranges),  nb_threads);
+    if (!c->workers || !c->ranges) {
+        av_freep(&c->workers);
+        av_freep(&c->ranges);
         return AVERROR(ENOMEM);
+    }
 
-    c->current_job = 0;
+    c->nb_created  = 0;
     c->nb_jobs     = 0;
     c->done        = 0;
 
+    for (i = 0; i < nb_threads; i++) {
+        c->ranges[i].c = c;
+        pthread_mutex_init(&c->ranges[i].lock, NULL);
+    }
     pthread_cond_init(&c->current_job_cond, NULL);
     pthread_cond_init(&c->last_job_cond,    NULL);
-
     pthread_mutex_init(&c->current_job_lock, NULL);
-    pthread_mutex_lock(&c->current_job_lock);
-    for (i = 0; i < nb_threads; i++) {
-        ret = pthread_create(&c->workers[i], NULL, worker, c);
+    pthread_mutex_init(&c->execute_lock, NULL);
+    pthread_mutex_init(&c->threads_lock, NULL);
+
+    for (i = 0; i < nb_threads - 1; i++) {
+        ret = pthread_create(&c->workers[i], NULL, worker, &c->ranges[i]);
         if (ret) {
-           pthread_mutex_unlock(&c->current_job_lock);
-           c->nb_threads = i;
+           /* only join the threads created so far */
            slice_thread_uninit(c);
            return AVERROR(ret);
         }
+        c->nb_created = i + 1;
     }
 
-    slice_thread_park_workers(c);
-
     return c->nb_threads;
 }
 
@@ -202,6 +500,28 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     if (!graph->internal->thread)
         return AVERROR(ENOMEM);
 
+    if (graph->thread_pool == AVFILTER_THREAD_POOL_SHARED) {
+        ThreadContext *c = graph->internal->thread;
+
+        c->nb_threads = get_nb_threads(graph->nb_threads);
+        if (c->nb_threads > 1) {
+            int i;
+
+            for (i = 0; i < FF_ARRAY_ELEMS(c->pool); i++) {
+                ret = avpriv_threadpool_client_alloc(&c->pool[i], c->nb_threads);
+                if (ret < 0) {
+                    avpriv_threadpool_client_free(&c->pool[0]);
+                    av_freep(&graph->internal->thread);
+                    return ret;
+                }
+            }
+            pthread_mutex_init(&c->threads_lock, NULL);
+            graph->nb_threads = c->nb_threads;
+            graph->internal->thread_execute = pool_execute;
+            return 0;
+        }
+    }
+
     ret = thread_init_internal(graph->internal->thread, graph->nb_threads);
     if (ret <= 1) {
         av_freep(&graph->internal->thread);
@@ -218,7 +538,13 @@ int ff_graph_thread_init(AVFilterGraph *graph)
 
 void ff_graph_thread_free(AVFilterGraph *graph)
 {
-    if (graph->internal->thread)
-        slice_thread_uninit(graph->internal->thread);
+    ThreadContext *c = graph->internal->thread;
+
+    if (c && c->pool[0]) {
+        avpriv_threadpool_client_free(&c->pool[0]);
+        avpriv_threadpool_client_free(&c->pool[1]);
+        pthread_mutex_destroy(&c->threads_lock);
+    } else if (c)
+        slice_thread_uninit(c);
     av_freep(&graph->internal->thread);
 }
@@ -25,4 +25,12 @@ int ff_graph_thread_init(AVFilterGraph *graph);
 
 void ff_graph_thread_free(AVFilterGraph *graph);
 
+/**
+ * Activate the ready filters of a graph on all its threads, running any
+ * filter not already running, until no filter is ready any more.
+ *
+ * @return 0 or the first error returned by a filter
+ */
+int ff_graph_run_pipeline(AVFilterGraph *graph);
+
 #endif /* AVFILTER_THREAD_H */
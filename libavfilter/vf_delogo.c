@@ -53,12 +53,15 @@
  * @param show   show a rectangle around the processed area, useful for
  *               parameters tweaking
  * @param direct if non-zero perform in-place processing
+ * @param slice_start first row of the image to process
+ * @param slice_end   row after the last one to process
  */
 static void apply_delogo(uint8_t *dst, int dst_linesize,
                          uint8_t *src, int src_linesize,
                          int w, int h, AVRational sar,
                          int logo_x, int logo_y, int logo_w, int logo_h,
-                         unsigned int band, int show, int direct)
+                         unsigned int band, int show, int direct,
+                         int slice_start, int slice_end)
 {
     int x, y;
     uint64_t interp, weightl, weightr, weightt, weightb, weight;
@@ -68,6 +71,7 @@ static void apply_delogo(uint8_t *dst, int dst_linesize,
     unsigned int left_sample, right_sample;
     int xclipl, xclipr, yclipt, yclipb;
     int logo_x1, logo_x2, logo_y1, logo_y2;
+    int y_start, y_end;
 
     xclipl = FFMAX(-logo_x, 0);
     xclipr = FFMAX(logo_x+logo_w-w, 0);
@@ -84,12 +88,19 @@ static void apply_delogo(uint8_t *dst, int dst_linesize,
     botleft  = src+logo_y2 * src_linesize+logo_x1;
 
     if (!direct)
-        av_image_copy_plane(dst, dst_linesize, src, src_linesize, w, h);
+        av_image_copy_plane(dst + slice_start * dst_linesize, dst_linesize,
+                            src + slice_start * src_linesize, src_linesize,
+                            w, slice_end - slice_start);
 
-    dst += (logo_y1 + 1) * dst_linesize;
-    src += (logo_y1 + 1) * src_linesize;
+    /* the rows and columns around the logo are only read, so that the
+     * slices do not depend on each other, even in-place */
+    y_start = FFMAX(logo_y1 + 1, slice_start);
+    y_end   = FFMIN(logo_y2,     slice_end);
 
-    for (y = logo_y1+1; y < logo_y2; y++) {
+    dst += y_start * dst_linesize;
+    src += y_start * src_linesize;
+
+    for (y = y_start; y < y_end; y++) {
         left_sample = topleft[src_linesize*(y-logo_y1)]   +
                       topleft[src_linesize*(y-logo_y1-1)] +
                       topleft[src_linesize*(y-logo_y1+1)];
@@ -240,16 +251,51 @@ static int config_input(AVFilterLink *inlink)
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    const AVPixFmtDescriptor *desc;
+    AVRational sar;
+    int direct;
+} ThreadData;
+
+static int delogo_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DelogoContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    int hsub0 = td->desc->log2_chroma_w;
+    int vsub0 = td->desc->log2_chroma_h;
+    int plane;
+
+    for (plane = 0; plane < td->desc->nb_components; plane++) {
+        int hsub = plane == 1 || plane == 2 ? hsub0 : 0;
+        int vsub = plane == 1 || plane == 2 ? vsub0 : 0;
+        int h    = AV_CEIL_RSHIFT(in->height, vsub);
+
+        apply_delogo(out->data[plane], out->linesize[plane],
+                     in ->data[plane], in ->linesize[plane],
+                     AV_CEIL_RSHIFT(in->width, hsub), h,
+                     td->sar, s->x>>hsub, s->y>>vsub,
+                     /* Up and left borders were rounded down, inject lost bits
+                      * into width and height to avoid error accumulation */
+                     AV_CEIL_RSHIFT(s->w + (s->x & ((1<<hsub)-1)), hsub),
+                     AV_CEIL_RSHIFT(s->h + (s->y & ((1<<vsub)-1)), vsub),
+                     s->band>>FFMIN(hsub, vsub),
+                     s->show, td->direct,
+                     (h * jobnr) / nb_jobs, (h * (jobnr + 1)) / nb_jobs);
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
-    DelogoContext *s = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+    ThreadData td;
     AVFrame *out;
-    int hsub0 = desc->log2_chroma_w;
-    int vsub0 = desc->log2_chroma_h;
     int direct = 0;
-    int plane;
     AVRational sar;
 
     if (av_frame_is_writable(in)) {
@@ -270,22 +316,13 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     if (!sar.num)
         sar.num = sar.den = 1;
 
-    for (plane = 0; plane < desc->nb_components; plane++) {
-        int hsub = plane == 1 || plane == 2 ? hsub0 : 0;
-        int vsub = plane == 1 || plane == 2 ? vsub0 : 0;
-
-        apply_delogo(out->data[plane], out->linesize[plane],
-                     in ->data[plane], in ->linesize[plane],
-                     AV_CEIL_RSHIFT(inlink->w, hsub),
-                     AV_CEIL_RSHIFT(inlink->h, vsub),
-                     sar, s->x>>hsub, s->y>>vsub,
-                     /* Up and left borders were rounded down, inject lost bits
-                      * into width and height to avoid error accumulation */
-                     AV_CEIL_RSHIFT(s->w + (s->x & ((1<<hsub)-1)), hsub),
-                     AV_CEIL_RSHIFT(s->h + (s->y & ((1<<vsub)-1)), vsub),
-                     s->band>>FFMIN(hsub, vsub),
-                     s->show, direct);
-    }
+    td.in     = in;
+    td.out    = out;
+    td.desc   = desc;
+    td.sar    = sar;
+    td.direct = direct;
+    ctx->internal->execute(ctx, delogo_slice, &td, NULL,
+                           FFMIN(in->height, ff_filter_get_nb_threads(ctx)));
 
     if (!direct)
         av_frame_free(&in);
@@ -320,5 +357,5 @@ AVFilter ff_vf_delogo = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_delogo_inputs,
     .outputs       = avfilter_vf_delogo_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
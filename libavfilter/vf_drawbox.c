@@ -207,14 +207,32 @@ fail:
     return ret;
 }
 
-static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
+/**
+ * Get the first row of a slice of [y0, y1). Slices start on chroma rows, so
+ * that no chroma sample is written by two jobs.
+ */
+static int slice_row(DrawBoxContext *s, int y0, int y1, int jobnr, int nb_jobs)
 {
-    DrawBoxContext *s = inlink->dst->priv;
+    if (!jobnr)
+        return y0;
+    if (jobnr == nb_jobs)
+        return y1;
+    return av_clip(((y0 + (y1 - y0) * jobnr / nb_jobs) >> s->vsub) << s->vsub, y0, y1);
+}
+
+static int drawbox_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DrawBoxContext *s = ctx->priv;
+    AVFrame *frame = arg;
     int plane, x, y, xb = s->x, yb = s->y;
+    const int y0 = FFMAX(yb, 0);
+    const int y1 = FFMIN(yb + s->h, frame->height);
+    const int slice_start = slice_row(s, y0, y1, jobnr,     nb_jobs);
+    const int slice_end   = slice_row(s, y0, y1, jobnr + 1, nb_jobs);
     unsigned char *row[4];
 
     if (s->have_alpha) {
-        for (y = FFMAX(yb, 0); y < frame->height && y < (yb + s->h); y++) {
+        for (y = slice_start; y < slice_end; y++) {
             row[0] = frame->data[0] + y * frame->linesize[0];
             row[3] = frame->data[3] + y * frame->linesize[3];
 
@@ -240,7 +258,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
             }
         }
     } else {
-        for (y = FFMAX(yb, 0); y < frame->height && y < (yb + s->h); y++) {
+        for (y = slice_start; y < slice_end; y++) {
             row[0] = frame->data[0] + y * frame->linesize[0];
 
             for (plane = 1; plane < 3; plane++)
@@ -267,7 +285,20 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
         }
     }
 
-    return ff_filter_frame(inlink->dst->outputs[0], frame);
+    return 0;
+}
+
+static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
+{
+    AVFilterContext *ctx = inlink->dst;
+    DrawBoxContext *s = ctx->priv;
+    int h = FFMIN(s->y + s->h, frame->height) - FFMAX(s->y, 0);
+
+    if (h > 0)
+        ctx->internal->execute(ctx, drawbox_slice, frame, NULL,
+                               FFMIN(h, ff_filter_get_nb_threads(ctx)));
+
+    return ff_filter_frame(ctx->outputs[0], frame);
 }
 
 #define OFFSET(x) offsetof(DrawBoxContext, x)
@@ -319,7 +350,7 @@ AVFilter ff_vf_drawbox = {
     .query_formats = query_formats,
     .inputs        = drawbox_inputs,
     .outputs       = drawbox_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif /* CONFIG_DRAWBOX_FILTER */
 
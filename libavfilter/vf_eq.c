@@ -64,9 +64,6 @@ static void apply_lut(EQParameters *param, uint8_t *dst, int dst_stride,
 {
     int x, y;
 
-    if (!param->lut_clean)
-        create_lut(param);
-
     for (y = 0; y < h; y++) {
         for (x = 0; x < w; x++) {
             dst[y * dst_stride + x] = param->lut[src[y * src_stride + x]];
@@ -248,11 +245,52 @@ static int query_formats(AVFilterContext *ctx)
 
 #define TS2T(ts, tb) ((ts) == AV_NOPTS_VALUE ? NAN : (double)(ts) * av_q2d(tb))
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    const AVPixFmtDescriptor *desc;
+} ThreadData;
+
+static int eq_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    EQContext *eq = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    const AVPixFmtDescriptor *desc = td->desc;
+    int i;
+
+    for (i = 0; i < desc->nb_components; i++) {
+        int w = in->width;
+        int h = in->height;
+        int slice_start, slice_end;
+        uint8_t *dst;
+        const uint8_t *src;
+
+        if (i == 1 || i == 2) {
+            w = AV_CEIL_RSHIFT(w, desc->log2_chroma_w);
+            h = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
+        }
+        slice_start = (h *  jobnr     ) / nb_jobs;
+        slice_end   = (h * (jobnr + 1)) / nb_jobs;
+        dst = out->data[i] + slice_start * out->linesize[i];
+        src = in ->data[i] + slice_start *  in->linesize[i];
+
+        if (eq->param[i].adjust)
+            eq->param[i].adjust(&eq->param[i], dst, out->linesize[i],
+                                src, in->linesize[i], w, slice_end - slice_start);
+        else
+            av_image_copy_plane(dst, out->linesize[i],
+                                src, in->linesize[i], w, slice_end - slice_start);
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     EQContext *eq = ctx->priv;
+    ThreadData td;
     AVFrame *out;
     int64_t pos = in->pkt_pos;
     const AVPixFmtDescriptor *desc;
@@ -276,22 +314,16 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         set_saturation(eq);
     }
 
-    for (i = 0; i < desc->nb_components; i++) {
-        int w = inlink->w;
-        int h = inlink->h;
+    /* the tables are shared by the slices, build them beforehand */
+    for (i = 0; i < desc->nb_components; i++)
+        if (eq->param[i].adjust == apply_lut && !eq->param[i].lut_clean)
+            create_lut(&eq->param[i]);
 
-        if (i == 1 || i == 2) {
-            w = AV_CEIL_RSHIFT(w, desc->log2_chroma_w);
-            h = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
-        }
-
-        if (eq->param[i].adjust)
-            eq->param[i].adjust(&eq->param[i], out->data[i], out->linesize[i],
-                                 in->data[i], in->linesize[i], w, h);
-        else
-            av_image_copy_plane(out->data[i], out->linesize[i],
-                                in->data[i], in->linesize[i], w, h);
-    }
+    td.in   = in;
+    td.out  = out;
+    td.desc = desc;
+    ctx->internal->execute(ctx, eq_slice, &td, NULL,
+                           FFMIN(in->height, ff_filter_get_nb_threads(ctx)));
 
     av_frame_free(&in);
     return ff_filter_frame(outlink, out);
@@ -385,5 +417,5 @@ AVFilter ff_vf_eq = {
     .query_formats   = query_formats,
     .init            = initialize,
     .uninit          = uninit,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
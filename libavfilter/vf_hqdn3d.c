@@ -155,18 +155,94 @@ static int denoise_depth(HQDN3DContext *s,
 
 #define denoise(...)                                                          \
     do {                                                                      \
-        int ret = AVERROR_BUG;                                                \
+        ret = AVERROR_BUG;                                                    \
         switch (s->depth) {                                                   \
             case  8: ret = denoise_depth(__VA_ARGS__,  8); break;             \
             case  9: ret = denoise_depth(__VA_ARGS__,  9); break;             \
             case 10: ret = denoise_depth(__VA_ARGS__, 10); break;             \
             case 16: ret = denoise_depth(__VA_ARGS__, 16); break;             \
         }                                                                     \
-        if (ret < 0) {                                                        \
-            av_frame_free(&out);                                              \
-            if (!direct)                                                      \
-                av_frame_free(&in);                                           \
-            return ret;                                                       \
+    } while (0)
+
+/* The functions below run the same filter on parts of a plane, for slice
+ * threading. The spatial filter is recursive along the rows and along the
+ * columns, but the horizontal pass does not depend on the previous rows:
+ * it runs on bands of rows first, storing its output in hpass, then the
+ * vertical and temporal passes run on bands of columns, each one carrying
+ * the previous line state of its columns in line_ant. */
+
+av_always_inline
+static void init_frame_ant(uint8_t *src, uint16_t *frame_ant,
+                           int w, int h, int sstride, int depth)
+{
+    long x, y;
+
+    for (y = 0; y < h; y++, src += sstride, frame_ant += w)
+        for (x = 0; x < w; x++)
+            frame_ant[x] = LOAD(x);
+}
+
+av_always_inline
+static void denoise_hpass(uint8_t *src, uint16_t *hpass,
+                          int w, int h, int first_line, int sstride,
+                          int16_t *spatial, int depth)
+{
+    long x, y;
+    uint32_t pixel_ant;
+
+    spatial += 256 << LUT_BITS;
+
+    for (y = 0; y < h; y++) {
+        pixel_ant = LOAD(0);
+        /* as in denoise_spatial(), the first pixel is only filtered on the
+         * first line */
+        if (first_line && !y)
+            pixel_ant = lowpass(pixel_ant, LOAD(0), spatial, depth);
+        hpass[0] = pixel_ant;
+        for (x = 1; x < w; x++)
+            hpass[x] = pixel_ant = lowpass(pixel_ant, LOAD(x), spatial, depth);
+        src   += sstride;
+        hpass += w;
+    }
+}
+
+av_always_inline
+static void denoise_vpass(uint8_t *dst, uint16_t *hpass,
+                          uint16_t *line_ant, uint16_t *frame_ant,
+                          int w, int h, int x0, int x1, int dstride,
+                          int16_t *spatial, int16_t *temporal, int depth)
+{
+    long x, y;
+    uint32_t tmp;
+
+    spatial  += 256 << LUT_BITS;
+    temporal += 256 << LUT_BITS;
+
+    for (x = x0; x < x1; x++) {
+        line_ant[x] = tmp = hpass[x];
+        frame_ant[x] = tmp = lowpass(frame_ant[x], tmp, temporal, depth);
+        STORE(x, tmp);
+    }
+
+    for (y = 1; y < h; y++) {
+        dst       += dstride;
+        hpass     += w;
+        frame_ant += w;
+        for (x = x0; x < x1; x++) {
+            line_ant[x] = tmp = lowpass(line_ant[x], hpass[x], spatial, depth);
+            frame_ant[x] = tmp = lowpass(frame_ant[x], tmp, temporal, depth);
+            STORE(x, tmp);
+        }
+    }
+}
+
+#define call_depth(func, ...)                                                 \
+    do {                                                                      \
+        switch (s->depth) {                                                   \
+            case  8: func(__VA_ARGS__,  8); break;                            \
+            case  9: func(__VA_ARGS__,  9); break;                            \
+            case 10: func(__VA_ARGS__, 10); break;                            \
+            case 16: func(__VA_ARGS__, 16); break;                            \
         }                                                                     \
     } while (0)
 
@@ -223,10 +299,15 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->coefs[1]);
     av_freep(&s->coefs[2]);
     av_freep(&s->coefs[3]);
-    av_freep(&s->line);
+    av_freep(&s->line[0]);
+    av_freep(&s->line[1]);
+    av_freep(&s->line[2]);
     av_freep(&s->frame_prev[0]);
     av_freep(&s->frame_prev[1]);
     av_freep(&s->frame_prev[2]);
+    av_freep(&s->hpass[0]);
+    av_freep(&s->hpass[1]);
+    av_freep(&s->hpass[2]);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -261,19 +342,32 @@ static int query_formats(AVFilterContext *ctx)
 
 static int config_input(AVFilterLink *inlink)
 {
-    HQDN3DContext *s = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    HQDN3DContext *s = ctx->priv;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
     int i;
 
-    uninit(inlink->dst);
+    uninit(ctx);
 
     s->hsub  = desc->log2_chroma_w;
     s->vsub  = desc->log2_chroma_h;
     s->depth = desc->comp[0].depth;
 
-    s->line = av_malloc_array(inlink->w, sizeof(*s->line));
-    if (!s->line)
-        return AVERROR(ENOMEM);
+    for (i = 0; i < 3; i++) {
+        s->line[i] = av_malloc_array(inlink->w, sizeof(*s->line[i]));
+        if (!s->line[i])
+            return AVERROR(ENOMEM);
+    }
+
+    if (ctx->thread_type & AVFILTER_THREAD_SLICE && ff_filter_get_nb_threads(ctx) > 1) {
+        for (i = 0; i < 3; i++) {
+            s->hpass[i] = av_malloc_array(AV_CEIL_RSHIFT(inlink->w, !!i * s->hsub),
+                                          AV_CEIL_RSHIFT(inlink->h, !!i * s->vsub) *
+                                          sizeof(*s->hpass[i]));
+            if (!s->hpass[i])
+                return AVERROR(ENOMEM);
+        }
+    }
 
     for (i = 0; i < 4; i++) {
         s->coefs[i] = precalc_coefs(s->strength[i], s->depth);
@@ -287,6 +381,91 @@ static int config_input(AVFilterLink *inlink)
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int init_prev[3];           ///< frame_prev of the plane must be initialized
+} ThreadData;
+
+static int denoise_rows(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    HQDN3DContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    int c;
+
+    for (c = 0; c < 3; c++) {
+        int16_t *spatial  = s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL];
+        int16_t *temporal = s->coefs[c ? CHROMA_TMP     : LUMA_TMP];
+        const int w  = AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub));
+        const int h  = AV_CEIL_RSHIFT(in->height, (!!c * s->vsub));
+        const int y0 = (h *  jobnr     ) / nb_jobs;
+        const int y1 = (h * (jobnr + 1)) / nb_jobs;
+        uint8_t *src = in->data[c] + y0 * in->linesize[c];
+        uint16_t *frame_ant = s->frame_prev[c] + y0 * w;
+
+        if (td->init_prev[c])
+            call_depth(init_frame_ant, src, frame_ant, w, y1 - y0, in->linesize[c]);
+        if (spatial[0])
+            call_depth(denoise_hpass, src, s->hpass[c] + y0 * w, w, y1 - y0, !y0,
+                       in->linesize[c], spatial);
+        else
+            call_depth(denoise_temporal, src, out->data[c] + y0 * out->linesize[c],
+                       frame_ant, w, y1 - y0, in->linesize[c], out->linesize[c],
+                       temporal);
+    }
+    return 0;
+}
+
+static int denoise_columns(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    HQDN3DContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    int c;
+
+    for (c = 0; c < 3; c++) {
+        int16_t *spatial  = s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL];
+        int16_t *temporal = s->coefs[c ? CHROMA_TMP     : LUMA_TMP];
+        const int w  = AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub));
+        const int h  = AV_CEIL_RSHIFT(in->height, (!!c * s->vsub));
+        /* keep the columns of different jobs in different cache lines */
+        const int x0 = FFMIN(FFALIGN((w *  jobnr     ) / nb_jobs, 32), w);
+        const int x1 = FFMIN(FFALIGN((w * (jobnr + 1)) / nb_jobs, 32), w);
+
+        if (!spatial[0])
+            continue;
+        call_depth(denoise_vpass, out->data[c], s->hpass[c], s->line[c],
+                   s->frame_prev[c], w, h, x0, x1, out->linesize[c],
+                   spatial, temporal);
+    }
+    return 0;
+}
+
+static int denoise_threaded(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+{
+    HQDN3DContext *s = ctx->priv;
+    ThreadData td = { .in = in, .out = out };
+    int c;
+
+    for (c = 0; c < 3; c++) {
+        if (s->frame_prev[c])
+            continue;
+        s->frame_prev[c] = av_malloc_array(AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub)),
+                                           AV_CEIL_RSHIFT(in->height, (!!c * s->vsub)) *
+                                           sizeof(*s->frame_prev[c]));
+        if (!s->frame_prev[c])
+            return AVERROR(ENOMEM);
+        td.init_prev[c] = 1;
+    }
+
+    ctx->internal->execute(ctx, denoise_rows, &td, NULL,
+                           ff_filter_get_nb_jobs(ctx, AV_CEIL_RSHIFT(in->height, s->vsub)));
+    if (s->coefs[LUMA_SPATIAL][0] || s->coefs[CHROMA_SPATIAL][0])
+        ctx->internal->execute(ctx, denoise_columns, &td, NULL,
+                               ff_filter_get_nb_jobs(ctx, FFMAX(AV_CEIL_RSHIFT(in->width, s->hsub) / 32, 1)));
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx  = inlink->dst;
@@ -294,7 +473,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     AVFilterLink *outlink = ctx->outputs[0];
 
     AVFrame *out;
-    int c, direct = av_frame_is_writable(in) && !ctx->is_disabled;
+    int c, ret = 0, direct = av_frame_is_writable(in) && !ctx->is_disabled;
 
     if (direct) {
         out = in;
@@ -308,14 +487,24 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         av_frame_copy_props(out, in);
     }
 
-    for (c = 0; c < 3; c++) {
-        denoise(s, in->data[c], out->data[c],
-                s->line, &s->frame_prev[c],
-                AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub)),
-                AV_CEIL_RSHIFT(in->height, (!!c * s->vsub)),
-                in->linesize[c], out->linesize[c],
-                s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL],
-                s->coefs[c ? CHROMA_TMP     : LUMA_TMP]);
+    if (s->hpass[0]) {
+        ret = denoise_threaded(ctx, in, out);
+    } else {
+        for (c = 0; c < 3 && ret >= 0; c++) {
+            denoise(s, in->data[c], out->data[c],
+                    s->line[c], &s->frame_prev[c],
+                    AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub)),
+                    AV_CEIL_RSHIFT(in->height, (!!c * s->vsub)),
+                    in->linesize[c], out->linesize[c],
+                    s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL],
+                    s->coefs[c ? CHROMA_TMP     : LUMA_TMP]);
+        }
+    }
+    if (ret < 0) {
+        if (!direct)
+            av_frame_free(&out);
+        av_frame_free(&in);
+        return ret;
     }
 
     if (ctx->is_disabled) {
@@ -370,5 +559,5 @@ AVFilter ff_vf_hqdn3d = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_hqdn3d_inputs,
     .outputs       = avfilter_vf_hqdn3d_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -424,7 +424,7 @@ static int nlmeans_plane(AVFilterContext *ctx, int w, int h, int p, int r,
                                            src, src_linesize,
                                            offx, offy, e, w, h);
                 ctx->internal->execute(ctx, nlmeans_slice, &td, NULL,
-                                       FFMIN(td.endy - td.starty, ff_filter_get_nb_threads(ctx)));
+                                       ff_filter_get_nb_jobs(ctx, td.endy - td.starty));
             }
         }
     }
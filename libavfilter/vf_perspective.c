@@ -479,7 +479,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
                          .h = s->height[plane],
                          .hsub = hsub,
                          .vsub = vsub };
-        ctx->internal->execute(ctx, s->perspective, &td, NULL, FFMIN(td.h, ff_filter_get_nb_threads(ctx)));
+        ctx->internal->execute(ctx, s->perspective, &td, NULL, ff_filter_get_nb_jobs(ctx, td.h));
     }
 
     av_frame_free(&frame);
@@ -546,6 +546,20 @@ static unsigned compute_bit_depth(uint16_t mask)
     return av_popcount(mask);
 }
 
+/* large enough for all the keys and values set on a frame */
+#define METADATA_ARENA_SIZE 2048
+
+/*
+ * Copy the about 30 metadata entries set on each frame into a single block
+ * rather than allocating each key and value. On failure, or if the frame
+ * already has metadata, they are allocated as usual.
+ */
+static void alloc_metadata_arena(AVFrame *out)
+{
+    if (!av_dict_count(out->metadata))
+        av_frame_alloc_side_data_arena(out, METADATA_ARENA_SIZE);
+}
+
 static int filter_frame8(AVFilterLink *link, AVFrame *in)
 {
     AVFilterContext *ctx = link->dst;
@@ -710,6 +724,8 @@ static int filter_frame8(AVFilterLink *link, AVFrame *in)
     av_frame_free(&s->frame_prev);
     s->frame_prev = av_frame_clone(in);
 
+    alloc_metadata_arena(out);
+
 #define SET_META(key, fmt, val) do {                                \
     snprintf(metabuf, sizeof(metabuf), fmt, val);                   \
     av_dict_set(&out->metadata, "lavfi.signalstats." key, metabuf, 0);   \
@@ -932,6 +948,8 @@ static int filter_frame16(AVFilterLink *link, AVFrame *in)
     av_frame_free(&s->frame_prev);
     s->frame_prev = av_frame_clone(in);
 
+    alloc_metadata_arena(out);
+
     SET_META("YMIN",    "%d", miny);
     SET_META("YLOW",    "%d", lowy);
     SET_META("YAVG",    "%g", 1.0 * toty / s->fs);
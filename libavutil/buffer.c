@@ -16,14 +16,27 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "config.h"
+
 #include <stdatomic.h>
 #include <stdint.h>
 #include <string.h>
+#if HAVE_MMAP && HAVE_LINUX_MMAN_H
+#include <sys/mman.h>
+/* the kernel header has the Linux specific flags without _DEFAULT_SOURCE */
+#include <linux/mman.h>
+#endif
+#if HAVE_MMAP && HAVE_LINUX_MMAN_H && defined(MAP_ANONYMOUS)
+#define MAP_HUGEPAGES 1
+#else
+#define MAP_HUGEPAGES 0
+#endif
 
 #include "buffer_internal.h"
 #include "common.h"
 #include "mem.h"
 #include "thread.h"
+#include "time.h"
 
 AVBufferRef *av_buffer_create(uint8_t *data, int size,
                               void (*free)(void *opaque, uint8_t *data),
@@ -64,12 +77,168 @@ void av_buffer_default_free(void *opaque, uint8_t *data)
     av_free(data);
 }
 
-AVBufferRef *av_buffer_alloc(int size)
+/*
+ * Buffers allocated with a custom allocator are preceded by this header, so
+ * that they can be freed with the allocator they were allocated with even if
+ * another one was set in the meantime.
+ */
+typedef struct BufferAllocHeader {
+    void (*free)(void *opaque, void *ptr, size_t size);
+    void *opaque;
+    size_t size;
+} BufferAllocHeader;
+
+#define BUFFER_ALLOC_HEADER_SIZE 64
+
+static AVBufferAllocator buffer_allocator;
+
+static atomic_intptr_t alloc_nb_allocs;
+static atomic_intptr_t alloc_nb_frees;
+static atomic_intptr_t alloc_bytes;
+static atomic_intptr_t alloc_peak_bytes;
+
+void av_buffer_set_allocator(const AVBufferAllocator *allocator)
+{
+    if (allocator)
+        buffer_allocator = *allocator;
+    else
+        memset(&buffer_allocator, 0, sizeof(buffer_allocator));
+}
+
+void av_buffer_get_alloc_stats(AVBufferAllocStats *stats)
+{
+    stats->nb_allocs  = atomic_load_explicit(&alloc_nb_allocs,  memory_order_relaxed);
+    stats->nb_frees   = atomic_load_explicit(&alloc_nb_frees,   memory_order_relaxed);
+    stats->bytes      = atomic_load_explicit(&alloc_bytes,      memory_order_relaxed);
+    stats->peak_bytes = atomic_load_explicit(&alloc_peak_bytes, memory_order_relaxed);
+}
+
+static void buffer_custom_free(void *opaque, uint8_t *data)
+{
+    BufferAllocHeader *hdr = (BufferAllocHeader *)(data - BUFFER_ALLOC_HEADER_SIZE);
+    size_t size = hdr->size;
+
+    hdr->free(hdr->opaque, hdr, size);
+
+    atomic_fetch_add_explicit(&alloc_nb_frees, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&alloc_bytes, -(intptr_t)size, memory_order_relaxed);
+}
+
+static AVBufferRef *buffer_custom_alloc(const AVBufferAllocator *allocator,
+                                        int size, int zero)
+{
+    BufferAllocHeader *hdr;
+    AVBufferRef *ret;
+    size_t total = (size_t)size + BUFFER_ALLOC_HEADER_SIZE;
+    intptr_t bytes, peak;
+
+    hdr = allocator->alloc(allocator->opaque, total);
+    if (!hdr)
+        return NULL;
+
+    hdr->free   = allocator->free;
+    hdr->opaque = allocator->opaque;
+    hdr->size   = total;
+
+    /* memory which is already zeroed is not written here, so that its pages
+     * are placed by the thread which first uses them */
+    if (zero && !(allocator->flags & AV_BUFFER_ALLOCATOR_FLAG_ZEROED))
+        memset((uint8_t *)hdr + BUFFER_ALLOC_HEADER_SIZE, 0, size);
+
+    ret = av_buffer_create((uint8_t *)hdr + BUFFER_ALLOC_HEADER_SIZE, size,
+                           buffer_custom_free, NULL, 0);
+    if (!ret) {
+        allocator->free(allocator->opaque, hdr, total);
+        return NULL;
+    }
+
+    atomic_fetch_add_explicit(&alloc_nb_allocs, 1, memory_order_relaxed);
+    bytes = atomic_fetch_add_explicit(&alloc_bytes, total, memory_order_relaxed) + total;
+    peak  = atomic_load_explicit(&alloc_peak_bytes, memory_order_relaxed);
+    while (peak < bytes &&
+           !atomic_compare_exchange_weak_explicit(&alloc_peak_bytes, &peak, bytes,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+        ;
+
+    return ret;
+}
+
+#define HUGEPAGE_SIZE (2 << 20)
+
+/*
+ * Try explicit 2 MiB huge pages first, and fall back to a mapping aligned on
+ * a huge page boundary which the kernel may back with transparent huge pages.
+ * The size of explicit huge pages is requested rather than taken from the
+ * system default, which may be 1 GiB, so that both kinds of mappings can be
+ * unmapped with the same length.
+ * Nothing is written to the mapping, so its pages are only placed when first
+ * touched, by default on the NUMA node of the thread that uses them.
+ */
+static void *hugepage_alloc(void *opaque, size_t size)
+{
+#if MAP_HUGEPAGES
+    size_t len = FFALIGN(size, HUGEPAGE_SIZE);
+    uint8_t *ptr, *aligned;
+
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_2MB)
+    ptr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+    if (ptr != MAP_FAILED)
+        return ptr;
+#endif
+
+    ptr = mmap(NULL, len + HUGEPAGE_SIZE, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED)
+        return NULL;
+
+    aligned = (uint8_t *)FFALIGN((uintptr_t)ptr, HUGEPAGE_SIZE);
+    if (aligned > ptr)
+        munmap(ptr, aligned - ptr);
+    munmap(aligned + len, ptr + HUGEPAGE_SIZE - aligned);
+#ifdef MADV_HUGEPAGE
+    /* posix_madvise() passes other advice through to madvise() on Linux */
+    posix_madvise(aligned, len, MADV_HUGEPAGE);
+#endif
+
+    return aligned;
+#else
+    return av_malloc(size);
+#endif
+}
+
+static void hugepage_free(void *opaque, void *ptr, size_t size)
+{
+#if MAP_HUGEPAGES
+    munmap(ptr, FFALIGN(size, HUGEPAGE_SIZE));
+#else
+    av_free(ptr);
+#endif
+}
+
+static const AVBufferAllocator hugepage_allocator = {
+    .alloc    = hugepage_alloc,
+    .free     = hugepage_free,
+    .min_size = HUGEPAGE_SIZE,
+    .flags    = MAP_HUGEPAGES ? AV_BUFFER_ALLOCATOR_FLAG_ZEROED : 0,
+};
+
+const AVBufferAllocator *av_buffer_hugepage_allocator(void)
+{
+    return &hugepage_allocator;
+}
+
+static AVBufferRef *buffer_alloc(int size, int zero)
 {
     AVBufferRef *ret = NULL;
     uint8_t    *data = NULL;
 
-    data = av_malloc(size);
+    if (buffer_allocator.alloc && size >= 0 &&
+        (size_t)size >= buffer_allocator.min_size)
+        return buffer_custom_alloc(&buffer_allocator, size, zero);
+
+    data = zero ? av_mallocz(size) : av_malloc(size);
     if (!data)
         return NULL;
 
@@ -80,16 +249,72 @@ AVBufferRef *av_buffer_alloc(int size)
     return ret;
 }
 
+AVBufferRef *av_buffer_alloc(int size)
+{
+    return buffer_alloc(size, 0);
+}
+
 AVBufferRef *av_buffer_allocz(int size)
 {
-    AVBufferRef *ret = av_buffer_alloc(size);
+    return buffer_alloc(size, 1);
+}
+
+/* the arena header only holds the offset of the first unused byte */
+#define BUFFER_ARENA_HEADER_SIZE 16
+
+AVBufferRef *ff_buffer_arena_alloc(int size)
+{
+    AVBufferRef *arena;
+
+    if (size < 0 || size > INT_MAX - BUFFER_ARENA_HEADER_SIZE)
+        return NULL;
+
+    arena = av_buffer_alloc(BUFFER_ARENA_HEADER_SIZE + size);
+    if (!arena)
+        return NULL;
+
+    *(int *)arena->data = BUFFER_ARENA_HEADER_SIZE;
+    return arena;
+}
+
+uint8_t *ff_buffer_arena_get(AVBufferRef *arena, int size, int align)
+{
+    int *used  = (int *)arena->buffer->data;
+    int offset = FFALIGN(*used, align);
+
+    if (size < 0 || offset > arena->buffer->size ||
+        size > arena->buffer->size - offset)
+        return NULL;
+
+    *used = offset + size;
+    return arena->buffer->data + offset;
+}
+
+AVBufferRef *ff_buffer_arena_get_ref(AVBufferRef *arena, int size)
+{
+    AVBufferRef *ret;
+    uint8_t *data = ff_buffer_arena_get(arena, size, 16);
+
+    if (!data)
+        return NULL;
+
+    ret = av_buffer_ref(arena);
     if (!ret)
         return NULL;
 
-    memset(ret->data, 0, size);
+    ret->data = data;
+    ret->size = size;
     return ret;
 }
 
+int ff_buffer_arena_owns(const AVBufferRef *arena, const void *ptr)
+{
+    const uint8_t *p = ptr;
+
+    return p >= arena->buffer->data + BUFFER_ARENA_HEADER_SIZE &&
+           p <  arena->buffer->data + arena->buffer->size;
+}
+
 AVBufferRef *av_buffer_ref(AVBufferRef *buf)
 {
     AVBufferRef *ret = av_mallocz(sizeof(*ret));
@@ -215,54 +440,93 @@ int av_buffer_realloc(AVBufferRef **pbuf, int size)
     return 0;
 }
 
-AVBufferPool *av_buffer_pool_init2(int size, void *opaque,
+AVBufferPool *av_buffer_pool_init3(int size, void *opaque,
                                    AVBufferRef* (*alloc)(void *opaque, int size),
-                                   void (*pool_free)(void *opaque))
+                                   void (*pool_free)(void *opaque), int flags)
 {
     AVBufferPool *pool = av_mallocz(sizeof(*pool));
     if (!pool)
         return NULL;
 
+    if (flags & AV_BUFFER_POOL_FLAG_LOCKLESS) {
+        pool->caches = av_mallocz_array(BUFFER_POOL_CACHES, sizeof(*pool->caches));
+        if (!pool->caches) {
+            av_freep(&pool);
+            return NULL;
+        }
+    }
+
     ff_mutex_init(&pool->mutex, NULL);
 
     pool->size      = size;
     pool->opaque    = opaque;
     pool->alloc2    = alloc;
+    pool->alloc     = av_buffer_alloc;
     pool->pool_free = pool_free;
+    pool->flags     = flags;
 
     atomic_init(&pool->refcount, 1);
+    atomic_init(&pool->free_list, 0);
+    atomic_init(&pool->max_idle, 0);
+    atomic_init(&pool->track_released, 0);
+    atomic_init(&pool->nb_allocated, 0);
+    atomic_init(&pool->nb_idle, 0);
 
     return pool;
 }
 
+AVBufferPool *av_buffer_pool_init2(int size, void *opaque,
+                                   AVBufferRef* (*alloc)(void *opaque, int size),
+                                   void (*pool_free)(void *opaque))
+{
+    return av_buffer_pool_init3(size, opaque, alloc, pool_free, 0);
+}
+
 AVBufferPool *av_buffer_pool_init(int size, AVBufferRef* (*alloc)(int size))
 {
-    AVBufferPool *pool = av_mallocz(sizeof(*pool));
+    AVBufferPool *pool = av_buffer_pool_init3(size, NULL, NULL, NULL, 0);
     if (!pool)
         return NULL;
 
-    ff_mutex_init(&pool->mutex, NULL);
-
-    pool->size     = size;
-    pool->alloc    = alloc ? alloc : av_buffer_alloc;
-
-    atomic_init(&pool->refcount, 1);
+    pool->alloc = alloc ? alloc : av_buffer_alloc;
 
     return pool;
 }
 
+static void pool_entry_free(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    buf->free(buf->opaque, buf->data);
+    av_free(buf);
+    atomic_fetch_add_explicit(&pool->nb_allocated, -1, memory_order_relaxed);
+}
+
 /*
  * This function gets called when the pool has been uninited and
  * all the buffers returned to it.
  */
 static void buffer_pool_free(AVBufferPool *pool)
 {
+    if (pool->caches) {
+        int i, j;
+        for (i = 0; i < BUFFER_POOL_CACHES; i++) {
+            for (j = 0; j < BUFFER_POOL_CACHE_SLOTS; j++) {
+                BufferPoolEntry *buf = (BufferPoolEntry *)
+                    atomic_load_explicit(&pool->caches[i].slot[j],
+                                         memory_order_relaxed);
+                if (buf)
+                    pool_entry_free(pool, buf);
+            }
+        }
+        av_freep(&pool->caches);
+    }
+
+    pool->pool = (BufferPoolEntry *)atomic_load_explicit(&pool->free_list,
+                                                         memory_order_relaxed);
     while (pool->pool) {
         BufferPoolEntry *buf = pool->pool;
         pool->pool = buf->next;
 
-        buf->free(buf->opaque, buf->data);
-        av_freep(&buf);
+        pool_entry_free(pool, buf);
     }
     ff_mutex_destroy(&pool->mutex);
 
@@ -285,18 +549,190 @@ void av_buffer_pool_uninit(AVBufferPool **ppool)
         buffer_pool_free(pool);
 }
 
-static void pool_release_buffer(void *opaque, uint8_t *data)
+/*
+ * Each thread gets its own cache index on first use, handed out in turn, so
+ * that up to BUFFER_POOL_CACHES threads use distinct caches of every pool;
+ * further threads share them and then only contend on their slots. Without
+ * thread local storage, the caches are picked by hashing the address of the
+ * thread stack instead.
+ */
+#if HAVE_PTHREADS || HAVE_W32THREADS
+static atomic_uint next_cache_index;
+static AVOnce cache_key_once = AV_ONCE_INIT;
+static int cache_key_ok;
+#if HAVE_PTHREADS
+static pthread_key_t cache_key;
+#else
+static DWORD cache_key;
+#endif
+
+static void cache_key_init(void)
 {
-    BufferPoolEntry *buf = opaque;
-    AVBufferPool *pool = buf->pool;
+#if HAVE_PTHREADS
+    cache_key_ok = !pthread_key_create(&cache_key, NULL);
+#else
+    cache_key    = TlsAlloc();
+    cache_key_ok = cache_key != TLS_OUT_OF_INDEXES;
+#endif
+}
+#endif
 
-    if(CONFIG_MEMORY_POISONING)
-        memset(buf->data, FF_MEMORY_POISON, pool->size);
+static unsigned pool_cache_index(void)
+{
+    char local;
+    uintptr_t id;
+
+#if HAVE_PTHREADS || HAVE_W32THREADS
+    ff_thread_once(&cache_key_once, cache_key_init);
+    if (cache_key_ok) {
+        /* stored plus one, as unset keys read as NULL */
+#if HAVE_PTHREADS
+        id = (uintptr_t)pthread_getspecific(cache_key);
+#else
+        id = (uintptr_t)TlsGetValue(cache_key);
+#endif
+        if (!id) {
+            id = atomic_fetch_add_explicit(&next_cache_index, 1,
+                                           memory_order_relaxed) % BUFFER_POOL_CACHES + 1;
+#if HAVE_PTHREADS
+            pthread_setspecific(cache_key, (void *)id);
+#else
+            TlsSetValue(cache_key, (void *)id);
+#endif
+        }
+        return id - 1;
+    }
+#endif
+
+    id  = (uintptr_t)&local >> 16;
+    id ^= id >> 5;
+    return (uint32_t)(id * 2654435761U) >> 28 & (BUFFER_POOL_CACHES - 1);
+}
+
+static BufferPoolEntry *pool_cache_get(AVBufferPool *pool)
+{
+    BufferPoolCache *cache = &pool->caches[pool_cache_index()];
+    int i;
+
+    for (i = 0; i < BUFFER_POOL_CACHE_SLOTS; i++) {
+        intptr_t buf;
+
+        if (!atomic_load_explicit(&cache->slot[i], memory_order_relaxed))
+            continue;
+        buf = atomic_exchange_explicit(&cache->slot[i], 0,
+                                       memory_order_acquire);
+        if (buf)
+            return (BufferPoolEntry *)buf;
+    }
+
+    return NULL;
+}
+
+static int pool_cache_put(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    BufferPoolCache *cache = &pool->caches[pool_cache_index()];
+    int i;
+
+    for (i = 0; i < BUFFER_POOL_CACHE_SLOTS; i++) {
+        intptr_t expected = 0;
+
+        if (atomic_load_explicit(&cache->slot[i], memory_order_relaxed))
+            continue;
+        if (atomic_compare_exchange_strong_explicit(&cache->slot[i], &expected,
+                                                    (intptr_t)buf,
+                                                    memory_order_release,
+                                                    memory_order_relaxed))
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * The lock-free list of free entries of pools with caches is only ever
+ * emptied as a whole with an atomic exchange, and entries are only added
+ * with a compare and swap of the head that does not depend on the entry it
+ * points to, so the list can't suffer from ABA issues.
+ */
+static void pool_list_push(AVBufferPool *pool, BufferPoolEntry *first,
+                           BufferPoolEntry *last)
+{
+    intptr_t head = atomic_load_explicit(&pool->free_list, memory_order_relaxed);
+
+    do {
+        last->next = (BufferPoolEntry *)head;
+    } while (!atomic_compare_exchange_weak_explicit(&pool->free_list, &head,
+                                                    (intptr_t)first,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+static BufferPoolEntry *pool_list_take(AVBufferPool *pool)
+{
+    return (BufferPoolEntry *)atomic_exchange_explicit(&pool->free_list, 0,
+                                                       memory_order_acquire);
+}
+
+/*
+ * Take the first entry of the list and put the other ones back. Another
+ * thread finding the list empty meanwhile allocates a new buffer, which is
+ * harmless.
+ */
+static BufferPoolEntry *pool_list_pop(AVBufferPool *pool)
+{
+    BufferPoolEntry *buf = pool_list_take(pool), *rest, *last;
+    intptr_t expected = 0;
+
+    if (!buf || !(rest = buf->next))
+        return buf;
+
+    /* the list is usually still empty, then the rest is put back as is */
+    if (!atomic_compare_exchange_strong_explicit(&pool->free_list, &expected,
+                                                 (intptr_t)rest,
+                                                 memory_order_release,
+                                                 memory_order_relaxed)) {
+        for (last = rest; last->next; last = last->next)
+            ;
+        pool_list_push(pool, rest, last);
+    }
+
+    return buf;
+}
+
+static void pool_put_entry(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    atomic_fetch_add_explicit(&pool->nb_idle, 1, memory_order_relaxed);
+
+    if (pool->caches) {
+        if (!pool_cache_put(pool, buf))
+            pool_list_push(pool, buf, buf);
+        return;
+    }
 
     ff_mutex_lock(&pool->mutex);
     buf->next = pool->pool;
     pool->pool = buf;
     ff_mutex_unlock(&pool->mutex);
+}
+
+static void pool_release_buffer(void *opaque, uint8_t *data)
+{
+    BufferPoolEntry *buf = opaque;
+    AVBufferPool *pool = buf->pool;
+
+    int max_idle = atomic_load_explicit(&pool->max_idle, memory_order_relaxed);
+
+    if (max_idle &&
+        atomic_load_explicit(&pool->nb_idle, memory_order_relaxed) >= max_idle) {
+        pool_entry_free(pool, buf);
+    } else {
+        if(CONFIG_MEMORY_POISONING)
+            memset(buf->data, FF_MEMORY_POISON, pool->size);
+
+        if (atomic_load_explicit(&pool->track_released, memory_order_relaxed))
+            buf->released = av_gettime_relative();
+        pool_put_entry(pool, buf);
+    }
 
     if (atomic_fetch_add_explicit(&pool->refcount, -1, memory_order_acq_rel) == 1)
         buffer_pool_free(pool);
@@ -328,6 +764,10 @@ static AVBufferRef *pool_alloc_buffer(AVBufferPool *pool)
     ret->buffer->opaque = buf;
     ret->buffer->free   = pool_release_buffer;
 
+    atomic_fetch_add_explicit(&pool->nb_allocated, 1, memory_order_relaxed);
+    pool->peak = FFMAX(pool->peak,
+                       atomic_load_explicit(&pool->nb_allocated, memory_order_relaxed));
+
     return ret;
 }
 
@@ -336,6 +776,20 @@ AVBufferRef *av_buffer_pool_get(AVBufferPool *pool)
     AVBufferRef *ret;
     BufferPoolEntry *buf;
 
+    if (pool->caches &&
+        ((buf = pool_cache_get(pool)) || (buf = pool_list_pop(pool)))) {
+        ret = av_buffer_create(buf->data, pool->size, pool_release_buffer,
+                               buf, 0);
+        atomic_fetch_add_explicit(&pool->nb_idle, -1, memory_order_relaxed);
+        if (!ret) {
+            pool_put_entry(pool, buf);
+            return NULL;
+        }
+        buf->next = NULL;
+        atomic_fetch_add_explicit(&pool->refcount, 1, memory_order_relaxed);
+        return ret;
+    }
+
     ff_mutex_lock(&pool->mutex);
     buf = pool->pool;
     if (buf) {
@@ -344,6 +798,7 @@ AVBufferRef *av_buffer_pool_get(AVBufferPool *pool)
         if (ret) {
             pool->pool = buf->next;
             buf->next = NULL;
+            atomic_fetch_add_explicit(&pool->nb_idle, -1, memory_order_relaxed);
         }
     } else {
         ret = pool_alloc_buffer(pool);
@@ -355,3 +810,140 @@ AVBufferRef *av_buffer_pool_get(AVBufferPool *pool)
 
     return ret;
 }
+
+/*
+ * Take all the idle entries out of the pool, must be called with the mutex
+ * held.
+ */
+static BufferPoolEntry *pool_take_idle(AVBufferPool *pool)
+{
+    BufferPoolEntry *buf, *idle;
+    int i, j;
+
+    if (pool->caches) {
+        idle = pool_list_take(pool);
+        for (i = 0; i < BUFFER_POOL_CACHES; i++) {
+            for (j = 0; j < BUFFER_POOL_CACHE_SLOTS; j++) {
+                buf = (BufferPoolEntry *)atomic_exchange_explicit(&pool->caches[i].slot[j],
+                                                                  0, memory_order_acquire);
+                if (buf) {
+                    buf->next = idle;
+                    idle      = buf;
+                }
+            }
+        }
+    } else {
+        idle       = pool->pool;
+        pool->pool = NULL;
+    }
+
+    return idle;
+}
+
+/*
+ * Put the idle entries from idle to last back, must be called with the mutex
+ * held.
+ */
+static void pool_put_idle(AVBufferPool *pool, BufferPoolEntry *idle,
+                          BufferPoolEntry *last)
+{
+    if (!idle)
+        return;
+    if (pool->caches) {
+        pool_list_push(pool, idle, last);
+    } else {
+        last->next = pool->pool;
+        pool->pool = idle;
+    }
+}
+
+/*
+ * Free the idle entries that were released at least max_age microseconds ago,
+ * as well as those in excess of max_idle. The entries kept in the caches are
+ * moved to the list of free entries.
+ */
+static int buffer_pool_trim(AVBufferPool *pool, int64_t max_age, int max_idle)
+{
+    BufferPoolEntry *buf, **next, *idle, *last = NULL, *trimmed = NULL;
+    int64_t now = av_gettime_relative();
+    int nb_kept = 0, nb_trimmed = 0;
+
+    ff_mutex_lock(&pool->mutex);
+
+    if (!max_age)
+        max_age = pool->max_age ? pool->max_age : INT64_MAX;
+
+    idle = pool_take_idle(pool);
+
+    /* the list is mostly sorted from the most to the least recently used */
+    next = &idle;
+    while ((buf = *next)) {
+        if (nb_kept < max_idle && now - buf->released < max_age) {
+            nb_kept++;
+            last = buf;
+            next = &buf->next;
+        } else {
+            *next     = buf->next;
+            buf->next = trimmed;
+            trimmed   = buf;
+            nb_trimmed++;
+        }
+    }
+    atomic_fetch_add_explicit(&pool->nb_idle, -nb_trimmed, memory_order_relaxed);
+
+    pool_put_idle(pool, idle, last);
+
+    ff_mutex_unlock(&pool->mutex);
+
+    while ((buf = trimmed)) {
+        trimmed = buf->next;
+        pool_entry_free(pool, buf);
+    }
+
+    return nb_trimmed;
+}
+
+void av_buffer_pool_set_max_idle(AVBufferPool *pool, int max_idle)
+{
+    atomic_store_explicit(&pool->max_idle, FFMAX(max_idle, 0),
+                          memory_order_relaxed);
+    if (max_idle > 0)
+        buffer_pool_trim(pool, INT64_MAX, max_idle);
+}
+
+void av_buffer_pool_set_max_age(AVBufferPool *pool, int64_t max_age)
+{
+    BufferPoolEntry *buf, *idle, *last = NULL;
+    int64_t now = av_gettime_relative();
+
+    ff_mutex_lock(&pool->mutex);
+
+    pool->max_age = FFMAX(max_age, 0);
+    atomic_store_explicit(&pool->track_released, !!pool->max_age,
+                          memory_order_relaxed);
+
+    /* the entries idle so far count as released now */
+    idle = pool_take_idle(pool);
+    for (buf = idle; buf; buf = buf->next) {
+        buf->released = now;
+        last = buf;
+    }
+    pool_put_idle(pool, idle, last);
+
+    ff_mutex_unlock(&pool->mutex);
+}
+
+int av_buffer_pool_trim(AVBufferPool *pool)
+{
+    return buffer_pool_trim(pool, 0, INT_MAX);
+}
+
+void av_buffer_pool_get_stats(AVBufferPool *pool, AVBufferPoolStats *stats)
+{
+    stats->allocated = atomic_load_explicit(&pool->nb_allocated, memory_order_relaxed);
+    stats->idle      = atomic_load_explicit(&pool->nb_idle,      memory_order_relaxed);
+
+    ff_mutex_lock(&pool->mutex);
+    stats->peak = pool->peak;
+    ff_mutex_unlock(&pool->mutex);
+}
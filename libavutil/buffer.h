@@ -25,6 +25,7 @@
 #ifndef AVUTIL_BUFFER_H
 #define AVUTIL_BUFFER_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -94,7 +95,8 @@ typedef struct AVBufferRef {
 } AVBufferRef;
 
 /**
- * Allocate an AVBuffer of the given size using av_malloc().
+ * Allocate an AVBuffer of the given size using av_malloc(), or the allocator
+ * set with av_buffer_set_allocator() for large sizes.
  *
  * @return an AVBufferRef of given size or NULL when out of memory
  */
@@ -106,6 +108,83 @@ AVBufferRef *av_buffer_alloc(int size);
  */
 AVBufferRef *av_buffer_allocz(int size);
 
+/**
+ * Custom allocator for the data of large buffers, see av_buffer_set_allocator().
+ */
+typedef struct AVBufferAllocator {
+    /**
+     * Allocate size bytes of memory, aligned on at least 64 bytes.
+     * Must be thread-safe.
+     *
+     * @return the allocated memory, NULL on failure
+     */
+    void *(*alloc)(void *opaque, size_t size);
+    /**
+     * Free memory returned by alloc. Must be thread-safe.
+     *
+     * @param size the size that was passed to alloc
+     */
+    void  (*free)(void *opaque, void *ptr, size_t size);
+    /**
+     * Arbitrary user data passed to alloc and free.
+     */
+    void   *opaque;
+    /**
+     * Only buffers of at least this size are allocated with this allocator,
+     * smaller ones still use av_malloc().
+     */
+    size_t  min_size;
+    /**
+     * A combination of AV_BUFFER_ALLOCATOR_FLAG_* flags.
+     */
+    int     flags;
+} AVBufferAllocator;
+
+/**
+ * The memory returned by AVBufferAllocator.alloc is always zeroed, so that
+ * av_buffer_allocz() does not need to clear it.
+ */
+#define AV_BUFFER_ALLOCATOR_FLAG_ZEROED (1 << 0)
+
+/**
+ * Set the allocator used by av_buffer_alloc() and av_buffer_allocz(), and
+ * thus by buffer pools using the default allocator, for large buffers.
+ *
+ * Buffers allocated before the call are still freed with the allocator they
+ * were allocated with. This function is not thread-safe and is meant to be
+ * called once, before any other thread allocates buffers.
+ *
+ * @param allocator the allocator to use, it is copied. NULL restores the
+ *                  default of allocating all buffers with av_malloc().
+ */
+void av_buffer_set_allocator(const AVBufferAllocator *allocator);
+
+/**
+ * Get the built-in allocator for frame-sized buffers of 2 MiB and more. It
+ * maps whole 2 MiB huge pages, explicit ones when the system has some reserved
+ * and transparent ones otherwise, and never touches the memory so that the
+ * pages get allocated on the NUMA node of the thread which first writes to
+ * them. Where such mappings are not available, it falls back to av_malloc().
+ */
+const AVBufferAllocator *av_buffer_hugepage_allocator(void);
+
+/**
+ * Allocation counters of the allocator set with av_buffer_set_allocator(),
+ * as returned by av_buffer_get_alloc_stats().
+ */
+typedef struct AVBufferAllocStats {
+    int64_t nb_allocs;  ///< number of buffers allocated
+    int64_t nb_frees;   ///< number of buffers freed
+    int64_t bytes;      ///< number of bytes currently allocated
+    int64_t peak_bytes; ///< highest value ever reached by bytes
+} AVBufferAllocStats;
+
+/**
+ * Get the allocation counters of the custom buffer allocators. Buffers
+ * allocated with av_malloc() are not accounted for.
+ */
+void av_buffer_get_alloc_stats(AVBufferAllocStats *stats);
+
 /**
  * Always treat the buffer as read-only, even when it has only one
  * reference.
@@ -266,6 +345,33 @@ AVBufferPool *av_buffer_pool_init2(int size, void *opaque,
                                    AVBufferRef* (*alloc)(void *opaque, int size),
                                    void (*pool_free)(void *opaque));
 
+/**
+ * Keep free buffers in small per-thread caches, which threads share only when
+ * there are more than 16 of them, and a lock-free list instead of a single
+ * mutex-protected list. This reduces
+ * contention when many threads get and release buffers from the same pool
+ * concurrently, at the cost of a few more idle buffers being kept around.
+ */
+#define AV_BUFFER_POOL_FLAG_LOCKLESS (1 << 0)
+
+/**
+ * Allocate and initialize a buffer pool with a more complex allocator and
+ * additional flags.
+ *
+ * @param size size of each buffer in this pool
+ * @param opaque arbitrary user data used by the allocator
+ * @param alloc a function that will be used to allocate new buffers when the
+ *              pool is empty. May be NULL, then the default allocator will be
+ *              used (av_buffer_alloc()).
+ * @param pool_free a function that will be called immediately before the pool
+ *                  is freed, see av_buffer_pool_init2(). May be NULL.
+ * @param flags a combination of AV_BUFFER_POOL_FLAG_*
+ * @return newly created buffer pool on success, NULL on error.
+ */
+AVBufferPool *av_buffer_pool_init3(int size, void *opaque,
+                                   AVBufferRef* (*alloc)(void *opaque, int size),
+                                   void (*pool_free)(void *opaque), int flags);
+
 /**
  * Mark the pool as being available for freeing. It will actually be freed only
  * once all the allocated buffers associated with the pool are released. Thus it
@@ -284,6 +390,54 @@ void av_buffer_pool_uninit(AVBufferPool **pool);
  */
 AVBufferRef *av_buffer_pool_get(AVBufferPool *pool);
 
+/**
+ * Limit the number of idle buffers kept in the pool for reuse. Buffers
+ * returned to the pool while this many buffers are already idle are freed
+ * instead, and idle buffers in excess of the new limit are freed immediately.
+ * This function may be called simultaneously with av_buffer_pool_get() and
+ * the release of buffers from other threads.
+ *
+ * @param max_idle maximum number of idle buffers, 0 for no limit (the default)
+ */
+void av_buffer_pool_set_max_idle(AVBufferPool *pool, int max_idle);
+
+/**
+ * Set the age from which idle buffers are freed by av_buffer_pool_trim().
+ * The pool only records when buffers are returned to it while an age is set,
+ * the buffers already idle count as returned when this function is called.
+ * This function may be called simultaneously with av_buffer_pool_get() and
+ * the release of buffers from other threads.
+ *
+ * @param max_age age in microseconds, 0 for none (the default)
+ */
+void av_buffer_pool_set_max_age(AVBufferPool *pool, int64_t max_age);
+
+/**
+ * Free the buffers that have been idle in the pool for at least the age set
+ * with av_buffer_pool_set_max_age(). Buffers currently in use are not
+ * affected, and no buffer is freed if no age is set.
+ * This function may be called simultaneously with av_buffer_pool_get() and
+ * the release of buffers from other threads.
+ *
+ * @return the number of buffers freed
+ */
+int av_buffer_pool_trim(AVBufferPool *pool);
+
+/**
+ * Buffer pool usage counters, as returned by av_buffer_pool_get_stats().
+ */
+typedef struct AVBufferPoolStats {
+    int allocated; ///< number of buffers owned by the pool, either in use or idle
+    int idle;      ///< number of buffers currently idle in the pool
+    int peak;      ///< highest value ever reached by allocated
+} AVBufferPoolStats;
+
+/**
+ * Get the usage counters of a buffer pool. When other threads are using the
+ * pool concurrently, the values are only a snapshot.
+ */
+void av_buffer_pool_get_stats(AVBufferPool *pool, AVBufferPoolStats *stats);
+
 /**
  * @}
  */
@@ -71,12 +71,72 @@ typedef struct BufferPoolEntry {
 
     AVBufferPool *pool;
     struct BufferPoolEntry *next;
+
+    /*
+     * Time (as returned by av_gettime_relative()) at which the buffer was
+     * last returned to the pool, used to trim buffers that stay idle. Only
+     * set while the pool has a maximum age.
+     */
+    int64_t released;
 } BufferPoolEntry;
 
+/**
+ * Number of caches of a pool created with AV_BUFFER_POOL_FLAG_LOCKLESS.
+ * Each thread is given one on first use, in turn.
+ */
+#define BUFFER_POOL_CACHES      16
+/**
+ * Number of free entries each of those caches can hold.
+ */
+#define BUFFER_POOL_CACHE_SLOTS  8
+
+typedef struct BufferPoolCache {
+    /*
+     * Each slot holds either 0 or a pointer to a free BufferPoolEntry.
+     * Entries are moved in and out of a slot with a single atomic operation,
+     * so no lock is needed and the list can't suffer from ABA issues.
+     */
+    atomic_intptr_t slot[BUFFER_POOL_CACHE_SLOTS];
+} BufferPoolCache;
+
 struct AVBufferPool {
     AVMutex mutex;
     BufferPoolEntry *pool;
 
+    /*
+     * Caches of free entries, only allocated for pools created with
+     * AV_BUFFER_POOL_FLAG_LOCKLESS, backed by a lock-free list of free
+     * entries used when the cache of the calling thread is empty (get) or
+     * full (release). The mutex protected list above is unused in that case.
+     */
+    BufferPoolCache *caches;
+    atomic_intptr_t free_list;
+    int flags;
+
+    /*
+     * Maximum number of idle entries, 0 for no limit. Entries released while
+     * the limit is reached are freed instead of being returned to the pool.
+     */
+    atomic_int max_idle;
+
+    /*
+     * Minimum age in microseconds of the idle entries freed by
+     * av_buffer_pool_trim(), 0 if none is set. Entries only record when they
+     * were released while it is set, as tracked by track_released.
+     * max_age is protected by mutex.
+     */
+    int64_t max_age;
+    atomic_int track_released;
+
+    /*
+     * Number of entries owned by the pool, either in use or idle, the number
+     * of idle entries and the highest value reached by the former.
+     * peak is protected by mutex.
+     */
+    atomic_int nb_allocated;
+    atomic_int nb_idle;
+    int peak;
+
     /*
      * This is used to track when the pool is to be freed.
      * The pointer to the pool itself held by the caller is considered to
@@ -95,4 +155,35 @@ struct AVBufferPool {
     void         (*pool_free)(void *opaque);
 };
 
+/**
+ * Allocate an arena: a single refcounted block out of which many small
+ * allocations can be carved, which is freed once all references to it are
+ * gone. Carving from an arena is not thread-safe.
+ *
+ * @param size number of bytes available for carving
+ * @return a reference to the arena, NULL on error
+ */
+AVBufferRef *ff_buffer_arena_alloc(int size);
+
+/**
+ * Carve size bytes aligned on align bytes out of the arena.
+ * The memory is only valid as long as a reference to the arena is held.
+ *
+ * @return the carved memory, NULL if the arena is not large enough
+ */
+uint8_t *ff_buffer_arena_get(AVBufferRef *arena, int size, int align);
+
+/**
+ * Carve size bytes out of the arena and return them as a new reference to
+ * it, covering only the carved memory.
+ *
+ * @return the new reference, NULL if the arena is not large enough or on error
+ */
+AVBufferRef *ff_buffer_arena_get_ref(AVBufferRef *arena, int size);
+
+/**
+ * @return 1 if ptr points into memory carved from the arena, 0 otherwise
+ */
+int ff_buffer_arena_owns(const AVBufferRef *arena, const void *ptr);
+
 #endif /* AVUTIL_BUFFER_INTERNAL_H */
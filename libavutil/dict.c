@@ -21,17 +21,190 @@
 #include <string.h>
 
 #include "avstring.h"
+#include "buffer.h"
+#include "buffer_internal.h"
 #include "dict.h"
 #include "internal.h"
 #include "mem.h"
 #include "time_internal.h"
 #include "bprint.h"
 
+/* below this number of entries, a linear search is as fast as hashing */
+#define DICT_INDEX_MIN_COUNT 16
+
 struct AVDictionary {
     int count;
+    int nb_alloc;   /* allocated number of elems (and index_next) */
     AVDictionaryEntry *elems;
+    /* if set, copies of keys and values are carved out of it when possible */
+    AVBufferRef *arena;
+
+    /*
+     * Optional case-insensitive hash index of the keys, built once the
+     * dictionary reaches DICT_INDEX_MIN_COUNT entries. index_buckets holds the
+     * head of a chain of entries for each hash bucket, index_next the next
+     * entry in the chain of each entry, both as entry index + 1 (0 ends the
+     * chain). The index is dropped if it cannot be allocated.
+     */
+    int *index_buckets;
+    int *index_next;
+    int nb_index_buckets;
 };
 
+static unsigned dict_hash(const char *key)
+{
+    unsigned h = 0;
+
+    while (*key)
+        h = h * 31 + av_toupper(*key++);
+    return h;
+}
+
+static void dict_index_free(AVDictionary *m)
+{
+    av_freep(&m->index_buckets);
+    av_freep(&m->index_next);
+    m->nb_index_buckets = 0;
+}
+
+static void dict_index_link(AVDictionary *m, int i)
+{
+    int *bucket = &m->index_buckets[dict_hash(m->elems[i].key) &
+                                    (m->nb_index_buckets - 1)];
+
+    m->index_next[i] = *bucket;
+    *bucket = i + 1;
+}
+
+static void dict_index_unlink(AVDictionary *m, int i)
+{
+    int *p = &m->index_buckets[dict_hash(m->elems[i].key) &
+                               (m->nb_index_buckets - 1)];
+
+    while (*p != i + 1)
+        p = &m->index_next[*p - 1];
+    *p = m->index_next[i];
+}
+
+static void dict_index_build(AVDictionary *m)
+{
+    int i, nb_buckets = 2 * DICT_INDEX_MIN_COUNT;
+
+    while (nb_buckets < 2 * m->count && nb_buckets < INT_MAX / 2)
+        nb_buckets <<= 1;
+
+    av_freep(&m->index_buckets);
+    m->index_buckets = av_mallocz_array(nb_buckets, sizeof(*m->index_buckets));
+    if (!m->index_next)
+        m->index_next = av_malloc_array(m->nb_alloc, sizeof(*m->index_next));
+    if (!m->index_buckets || !m->index_next) {
+        dict_index_free(m);
+        return;
+    }
+    m->nb_index_buckets = nb_buckets;
+
+    for (i = 0; i < m->count; i++)
+        dict_index_link(m, i);
+}
+
+/* index the entry just added at the end, building or resizing the index */
+static void dict_index_add(AVDictionary *m)
+{
+    if (!m->index_buckets) {
+        if (m->count >= DICT_INDEX_MIN_COUNT)
+            dict_index_build(m);
+    } else if (m->count > m->nb_index_buckets) {
+        dict_index_build(m);
+    } else {
+        dict_index_link(m, m->count - 1);
+    }
+}
+
+static int dict_grow(AVDictionary *m)
+{
+    AVDictionaryEntry *elems;
+    int nb_alloc;
+
+    if (m->count < m->nb_alloc)
+        return 0;
+
+    if (m->nb_alloc > INT_MAX / (2 * sizeof(*m->elems)))
+        return AVERROR(ENOMEM);
+    nb_alloc = FFMAX(2 * m->nb_alloc, 4);
+
+    elems = av_realloc_array(m->elems, nb_alloc, sizeof(*m->elems));
+    if (!elems)
+        return AVERROR(ENOMEM);
+    m->elems = elems;
+
+    if (m->index_next) {
+        int *next = av_realloc_array(m->index_next, nb_alloc, sizeof(*next));
+        if (next)
+            m->index_next = next;
+        else
+            dict_index_free(m);
+    }
+
+    m->nb_alloc = nb_alloc;
+    return 0;
+}
+
+static int dict_key_match(const char *s, const char *key, int flags)
+{
+    int j;
+
+    if (flags & AV_DICT_MATCH_CASE)
+        for (j = 0; s[j] == key[j] && key[j]; j++)
+            ;
+    else
+        for (j = 0; av_toupper(s[j]) == av_toupper(key[j]) && key[j]; j++)
+            ;
+    if (key[j])
+        return 0;
+    if (s[j] && !(flags & AV_DICT_IGNORE_SUFFIX))
+        return 0;
+    return 1;
+}
+
+static char *dict_strdup(AVDictionary *m, const char *s)
+{
+    if (m && m->arena && s) {
+        size_t len = strlen(s) + 1;
+        char *ret  = len <= INT_MAX ? (char *)ff_buffer_arena_get(m->arena, len, 1)
+                                    : NULL;
+        if (ret) {
+            memcpy(ret, s, len);
+            return ret;
+        }
+    }
+    return av_strdup(s);
+}
+
+static void dict_freep(AVDictionary *m, char **s)
+{
+    if (m && m->arena && ff_buffer_arena_owns(m->arena, *s))
+        *s = NULL;
+    else
+        av_freep(s);
+}
+
+int ff_dict_init_arena(AVDictionary **pm, AVBufferRef *arena)
+{
+    AVDictionary *m = av_mallocz(sizeof(*m));
+
+    if (!m)
+        return AVERROR(ENOMEM);
+
+    m->arena = av_buffer_ref(arena);
+    if (!m->arena) {
+        av_freep(&m);
+        return AVERROR(ENOMEM);
+    }
+
+    *pm = m;
+    return 0;
+}
+
 int av_dict_count(const AVDictionary *m)
 {
     return m ? m->count : 0;
@@ -40,29 +213,32 @@ int av_dict_count(const AVDictionary *m)
 AVDictionaryEntry *av_dict_get(const AVDictionary *m, const char *key,
                                const AVDictionaryEntry *prev, int flags)
 {
-    unsigned int i, j;
+    unsigned int i;
 
     if (!m)
         return NULL;
 
+    /* the first match in entry order is the one with the lowest index */
+    if (m->index_buckets && !prev && !(flags & AV_DICT_IGNORE_SUFFIX)) {
+        int next, found = m->count;
+
+        next = m->index_buckets[dict_hash(key) & (m->nb_index_buckets - 1)];
+        for (; next; next = m->index_next[next - 1]) {
+            if (next - 1 < found &&
+                dict_key_match(m->elems[next - 1].key, key, flags))
+                found = next - 1;
+        }
+        return found < m->count ? &m->elems[found] : NULL;
+    }
+
     if (prev)
         i = prev - m->elems + 1;
     else
         i = 0;
 
     for (; i < m->count; i++) {
-        const char *s = m->elems[i].key;
-        if (flags & AV_DICT_MATCH_CASE)
-            for (j = 0; s[j] == key[j] && key[j]; j++)
-                ;
-        else
-            for (j = 0; av_toupper(s[j]) == av_toupper(key[j]) && key[j]; j++)
-                ;
-        if (key[j])
-            continue;
-        if (s[j] && !(flags & AV_DICT_IGNORE_SUFFIX))
-            continue;
-        return &m->elems[i];
+        if (dict_key_match(m->elems[i].key, key, flags))
+            return &m->elems[i];
     }
     return NULL;
 }
@@ -80,34 +256,40 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
     if (flags & AV_DICT_DONT_STRDUP_KEY)
         copy_key = (void *)key;
     else
-        copy_key = av_strdup(key);
+        copy_key = dict_strdup(m, key);
     if (flags & AV_DICT_DONT_STRDUP_VAL)
         copy_value = (void *)value;
     else if (copy_key)
-        copy_value = av_strdup(value);
+        copy_value = dict_strdup(m, value);
     if (!m)
         m = *pm = av_mallocz(sizeof(*m));
     if (!m || (key && !copy_key) || (value && !copy_value))
         goto err_out;
 
     if (tag) {
+        int i = tag - m->elems;
+
         if (flags & AV_DICT_DONT_OVERWRITE) {
-            av_free(copy_key);
-            av_free(copy_value);
+            dict_freep(m, &copy_key);
+            dict_freep(m, &copy_value);
             return 0;
         }
+        if (m->index_buckets) {
+            dict_index_unlink(m, i);
+            if (i != m->count - 1)
+                dict_index_unlink(m, m->count - 1);
+        }
         if (flags & AV_DICT_APPEND)
             oldval = tag->value;
         else
-            av_free(tag->value);
-        av_free(tag->key);
+            dict_freep(m, &tag->value);
+        dict_freep(m, &tag->key);
         *tag = m->elems[--m->count];
+        if (m->index_buckets && i != m->count)
+            dict_index_link(m, i);
     } else if (copy_value) {
-        AVDictionaryEntry *tmp = av_realloc(m->elems,
-                                            (m->count + 1) * sizeof(*m->elems));
-        if (!tmp)
+        if (dict_grow(m) < 0)
             goto err_out;
-        m->elems = tmp;
     }
     if (copy_value) {
         m->elems[m->count].key = copy_key;
@@ -118,29 +300,28 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
             if (!newval)
                 goto err_out;
             av_strlcat(newval, oldval, len);
-            av_freep(&oldval);
+            dict_freep(m, &oldval);
             av_strlcat(newval, copy_value, len);
             m->elems[m->count].value = newval;
-            av_freep(&copy_value);
+            dict_freep(m, &copy_value);
         }
         m->count++;
+        dict_index_add(m);
     } else {
-        av_freep(&copy_key);
-    }
-    if (!m->count) {
-        av_freep(&m->elems);
-        av_freep(pm);
+        dict_freep(m, &copy_key);
     }
+    /* an empty dictionary with an arena is kept, so that the arena is
+     * reused if entries are set again */
+    if (!m->count && !m->arena)
+        av_dict_free(pm);
 
     return 0;
 
 err_out:
-    if (m && !m->count) {
-        av_freep(&m->elems);
-        av_freep(pm);
-    }
-    av_free(copy_key);
-    av_free(copy_value);
+    dict_freep(m, &copy_key);
+    dict_freep(m, &copy_value);
+    if (m && !m->count && !m->arena)
+        av_dict_free(pm);
     return AVERROR(ENOMEM);
 }
 
@@ -206,10 +387,12 @@ void av_dict_free(AVDictionary **pm)
 
     if (m) {
         while (m->count--) {
-            av_freep(&m->elems[m->count].key);
-            av_freep(&m->elems[m->count].value);
+            dict_freep(m, &m->elems[m->count].key);
+            dict_freep(m, &m->elems[m->count].value);
         }
         av_freep(&m->elems);
+        av_buffer_unref(&m->arena);
+        dict_index_free(m);
     }
     av_freep(pm);
 }
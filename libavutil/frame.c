@@ -19,10 +19,12 @@
 #include "channel_layout.h"
 #include "avassert.h"
 #include "buffer.h"
+#include "buffer_internal.h"
 #include "common.h"
 #include "dict.h"
 #include "frame.h"
 #include "imgutils.h"
+#include "internal.h"
 #include "mem.h"
 #include "samplefmt.h"
 
@@ -518,6 +520,8 @@ void av_frame_unref(AVFrame *frame)
 
     av_buffer_unref(&frame->opaque_ref);
 
+    av_buffer_unref(&frame->side_data_arena);
+
     get_frame_defaults(frame);
 }
 
@@ -664,12 +668,43 @@ fail:
     return NULL;
 }
 
+int av_frame_alloc_side_data_arena(AVFrame *frame, int size)
+{
+    AVBufferRef *arena;
+    int ret;
+
+    if (av_dict_count(frame->metadata))
+        return AVERROR(EINVAL);
+
+    arena = ff_buffer_arena_alloc(size);
+    if (!arena)
+        return AVERROR(ENOMEM);
+
+    av_dict_free(&frame->metadata);
+    ret = ff_dict_init_arena(&frame->metadata, arena);
+    if (ret < 0) {
+        av_buffer_unref(&arena);
+        return ret;
+    }
+
+    av_buffer_unref(&frame->side_data_arena);
+    frame->side_data_arena = arena;
+
+    return 0;
+}
+
 AVFrameSideData *av_frame_new_side_data(AVFrame *frame,
                                         enum AVFrameSideDataType type,
                                         int size)
 {
+    AVBufferRef *buf = NULL;
+
+    if (frame->side_data_arena)
+        buf = ff_buffer_arena_get_ref(frame->side_data_arena, size);
+    if (!buf)
+        buf = av_buffer_alloc(size);
 
-    return frame_new_side_data(frame, type, av_buffer_alloc(size));
+    return frame_new_side_data(frame, type, buf);
 }
 
 AVFrameSideData *av_frame_get_side_data(const AVFrame *frame,
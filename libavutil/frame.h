@@ -530,6 +530,13 @@ typedef struct AVFrame {
      * purpose.
      */
     AVBufferRef *opaque_ref;
+
+    /**
+     * Block out of which side data and metadata are allocated, see
+     * av_frame_alloc_side_data_arena().
+     * Not to be accessed directly from outside libavutil.
+     */
+    AVBufferRef *side_data_arena;
 } AVFrame;
 
 /**
@@ -714,6 +721,23 @@ int av_frame_copy_props(AVFrame *dst, const AVFrame *src);
  */
 AVBufferRef *av_frame_get_plane_buffer(AVFrame *frame, int plane);
 
+/**
+ * Allocate a single refcounted block of memory, out of which the side data
+ * subsequently added with av_frame_new_side_data() and the copies of the keys
+ * and values of the frame metadata are carved, instead of doing one or two
+ * allocations for each of them. Once the block is full, further side data and
+ * metadata are allocated separately again.
+ *
+ * The block is freed once the frame is unreferenced and all the references to
+ * side data carved from it are gone.
+ *
+ * @param frame a frame whose metadata is NULL or empty
+ * @param size  size of the block in bytes
+ *
+ * @return 0 on success, a negative AVERROR on error
+ */
+int av_frame_alloc_side_data_arena(AVFrame *frame, int size);
+
 /**
  * Add a new side data to a frame.
  *
@@ -361,4 +361,16 @@ void ff_check_pixfmt_descriptors(void);
  */
 int avpriv_dict_set_timestamp(AVDictionary **dict, const char *key, int64_t timestamp);
 
+struct AVBufferRef;
+
+/**
+ * Create an empty dictionary whose keys and values are copied into the given
+ * arena (see ff_buffer_arena_alloc()) for as long as it has room left.
+ * The dictionary holds a reference to the arena.
+ *
+ * @param pm pointer to a NULL dictionary pointer
+ * @return <0 on error
+ */
+int ff_dict_init_arena(AVDictionary **pm, struct AVBufferRef *arena);
+
 #endif /* AVUTIL_INTERNAL_H */
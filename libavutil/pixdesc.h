@@ -177,6 +177,12 @@ typedef struct AVPixFmtDescriptor {
  */
 #define AV_PIX_FMT_FLAG_BAYER        (1 << 8)
 
+/**
+ * The pixel format uses IEEE-754 floating point values. The depth of the
+ * components is the size of the floats, the nominal range is [0, 1].
+ */
+#define AV_PIX_FMT_FLAG_FLOAT        (1 << 9)
+
 /**
  * Return the number of bits per pixel used by the pixel format
  * described by pixdesc. Note that this is not the same as the number
@@ -318,6 +324,20 @@ void av_read_image_line(uint16_t *dst, const uint8_t *data[4],
                         const int linesize[4], const AVPixFmtDescriptor *desc,
                         int x, int y, int c, int w, int read_pal_component);
 
+/**
+ * Read a line from an image, like av_read_image_line(), into elements of
+ * dst_element_size bytes.
+ *
+ * @param dst_element_size size of the elements of dst in bytes, 2 or 4;
+ * components deeper than 16 bits, e.g. the floats of the formats with
+ * AV_PIX_FMT_FLAG_FLOAT, can only be read into 4 byte elements, which
+ * then hold their bits unchanged
+ */
+void av_read_image_line2(void *dst, const uint8_t *data[4],
+                         const int linesize[4], const AVPixFmtDescriptor *desc,
+                         int x, int y, int c, int w, int read_pal_component,
+                         int dst_element_size);
+
 /**
  * Write the values from src to the pixel format component c of an
  * image line.
@@ -336,6 +356,16 @@ void av_write_image_line(const uint16_t *src, uint8_t *data[4],
                          const int linesize[4], const AVPixFmtDescriptor *desc,
                          int x, int y, int c, int w);
 
+/**
+ * Write the values from src to the pixel format component c of an image
+ * line, like av_write_image_line(), from elements of src_element_size bytes.
+ *
+ * @param src_element_size size of the elements of src in bytes, 2 or 4
+ */
+void av_write_image_line2(const void *src, uint8_t *data[4],
+                          const int linesize[4], const AVPixFmtDescriptor *desc,
+                          int x, int y, int c, int w, int src_element_size);
+
 /**
  * Utility function to swap the endianness of a pixel format.
  *
@@ -0,0 +1,295 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * This test program hammers a buffer pool from several threads at once and
+ * checks that no buffer is ever handed out to two users at the same time.
+ * It also checks the idle limit, trimming and usage counters, and the custom
+ * allocator for large buffers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
+
+#define NB_THREADS    8
+#define NB_ITERATIONS 20000
+#define NB_HELD       12 /* more than a cache of a lockless pool holds */
+#define BUF_SIZE      64
+
+typedef struct ThreadArg {
+    AVBufferPool *pool;
+    int id;
+    int ret;
+} ThreadArg;
+
+static void *thread_main(void *arg)
+{
+    ThreadArg *t = arg;
+    AVBufferRef *held[NB_HELD] = { NULL };
+    int i, j;
+
+    for (i = 0; i < NB_ITERATIONS; i++) {
+        int n = i % NB_HELD + 1;
+
+        for (j = 0; j < n; j++) {
+            held[j] = av_buffer_pool_get(t->pool);
+            if (!held[j]) {
+                t->ret = 1;
+                goto end;
+            }
+            memset(held[j]->data, t->id * NB_HELD + j, BUF_SIZE);
+        }
+        for (j = 0; j < n; j++) {
+            int k;
+            for (k = 0; k < BUF_SIZE; k++) {
+                if (held[j]->data[k] != t->id * NB_HELD + j) {
+                    t->ret = 2;
+                    goto end;
+                }
+            }
+        }
+        for (j = 0; j < n; j++)
+            av_buffer_unref(&held[j]);
+    }
+
+end:
+    for (j = 0; j < NB_HELD; j++)
+        av_buffer_unref(&held[j]);
+    return NULL;
+}
+
+static int stress_pool(int flags)
+{
+    ThreadArg args[NB_THREADS];
+    pthread_t threads[NB_THREADS];
+    AVBufferPool *pool;
+    int i, ret = 0;
+
+    pool = av_buffer_pool_init3(BUF_SIZE, NULL, NULL, NULL, flags);
+    if (!pool)
+        return 1;
+
+    for (i = 0; i < NB_THREADS; i++) {
+        args[i].pool = pool;
+        args[i].id   = i;
+        args[i].ret  = 0;
+        if ((ret = pthread_create(&threads[i], NULL, thread_main, &args[i]))) {
+            fprintf(stderr, "pthread_create failed: %s.\n", strerror(ret));
+            exit(1);
+        }
+    }
+    for (i = 0; i < NB_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        if (args[i].ret)
+            ret = args[i].ret;
+    }
+
+    av_buffer_pool_uninit(&pool);
+    return ret;
+}
+
+#define CHECK_STATS(s, a, i, p) \
+    ((s).allocated == (a) && (s).idle == (i) && (s).peak == (p))
+
+static int trim_pool(int flags)
+{
+    AVBufferRef *held[NB_HELD];
+    AVBufferPoolStats stats;
+    AVBufferPool *pool;
+    int i, ret = 0;
+
+    pool = av_buffer_pool_init3(BUF_SIZE, NULL, NULL, NULL, flags);
+    if (!pool)
+        return 1;
+
+    for (i = 0; i < NB_HELD; i++)
+        if (!(held[i] = av_buffer_pool_get(pool)))
+            return 1;
+    for (i = 0; i < NB_HELD; i++)
+        av_buffer_unref(&held[i]);
+    av_buffer_pool_get_stats(pool, &stats);
+    if (!CHECK_STATS(stats, NB_HELD, NB_HELD, NB_HELD))
+        ret = 4;
+
+    av_buffer_pool_set_max_idle(pool, 1);
+    av_buffer_pool_get_stats(pool, &stats);
+    if (!CHECK_STATS(stats, 1, 1, NB_HELD))
+        ret = 5;
+
+    for (i = 0; i < 2; i++)
+        if (!(held[i] = av_buffer_pool_get(pool)))
+            return 1;
+    for (i = 0; i < 2; i++)
+        av_buffer_unref(&held[i]);
+    av_buffer_pool_get_stats(pool, &stats);
+    if (!CHECK_STATS(stats, 1, 1, NB_HELD))
+        ret = 6;
+
+    if (av_buffer_pool_trim(pool) != 0)
+        ret = 7;
+    av_buffer_pool_set_max_age(pool, INT64_MAX);
+    if (av_buffer_pool_trim(pool) != 0)
+        ret = 7;
+    av_buffer_pool_set_max_age(pool, 1000);
+    av_usleep(2000);
+    if (av_buffer_pool_trim(pool) != 1)
+        ret = 7;
+    av_buffer_pool_get_stats(pool, &stats);
+    if (!CHECK_STATS(stats, 0, 0, NB_HELD))
+        ret = 8;
+
+    av_buffer_pool_uninit(&pool);
+    return ret;
+}
+
+#define ALLOC_MIN_SIZE 4096
+
+typedef struct TestAllocator {
+    int nb_allocs;
+    int nb_frees;
+} TestAllocator;
+
+static void *test_alloc(void *opaque, size_t size)
+{
+    TestAllocator *a = opaque;
+    uint8_t *ptr = av_malloc(size);
+
+    if (ptr) {
+        /* check that av_buffer_allocz() clears unzeroed memory */
+        memset(ptr, 0xAA, size);
+        a->nb_allocs++;
+    }
+    return ptr;
+}
+
+static void test_free(void *opaque, void *ptr, size_t size)
+{
+    TestAllocator *a = opaque;
+
+    a->nb_frees++;
+    av_free(ptr);
+}
+
+static int is_zero(const uint8_t *data, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        if (data[i])
+            return 0;
+    return 1;
+}
+
+static int custom_allocator(void)
+{
+    TestAllocator a = { 0 }, b = { 0 };
+    AVBufferAllocator alloc = {
+        .alloc    = test_alloc,
+        .free     = test_free,
+        .opaque   = &a,
+        .min_size = ALLOC_MIN_SIZE,
+    };
+    const AVBufferAllocator *huge = av_buffer_hugepage_allocator();
+    AVBufferRef *small, *large, *zeroed, *other;
+    AVBufferAllocStats stats;
+    int ret = 0;
+
+    av_buffer_set_allocator(&alloc);
+
+    small  = av_buffer_alloc(ALLOC_MIN_SIZE - 1);
+    large  = av_buffer_alloc(ALLOC_MIN_SIZE);
+    zeroed = av_buffer_allocz(ALLOC_MIN_SIZE * 2);
+    if (!small || !large || !zeroed)
+        return 1;
+    if (a.nb_allocs != 2)
+        ret = 10;
+    if (!is_zero(zeroed->data, zeroed->size))
+        ret = 11;
+    memset(large->data, 1, large->size);
+
+    av_buffer_get_alloc_stats(&stats);
+    if (stats.nb_allocs != 2 || stats.nb_frees != 0 ||
+        stats.bytes < ALLOC_MIN_SIZE * 3 || stats.peak_bytes != stats.bytes)
+        ret = 12;
+
+    /* buffers are freed with the allocator they were allocated with */
+    alloc.opaque = &b;
+    av_buffer_set_allocator(&alloc);
+    other = av_buffer_alloc(ALLOC_MIN_SIZE);
+    if (!other)
+        return 1;
+    av_buffer_unref(&large);
+    av_buffer_unref(&zeroed);
+    if (a.nb_frees != 2 || b.nb_allocs != 1 || b.nb_frees != 0)
+        ret = 13;
+
+    av_buffer_set_allocator(NULL);
+    av_buffer_unref(&other);
+    av_buffer_unref(&small);
+    if (b.nb_frees != 1)
+        ret = 14;
+
+    av_buffer_get_alloc_stats(&stats);
+    if (stats.nb_allocs != 3 || stats.nb_frees != 3 || stats.bytes != 0)
+        ret = 15;
+
+    /* the built-in allocator returns zeroed, writable memory */
+    av_buffer_set_allocator(huge);
+    large  = av_buffer_alloc(huge->min_size + 1);
+    zeroed = av_buffer_allocz(huge->min_size * 2);
+    if (!large || !zeroed)
+        return 1;
+    memset(large->data, 1, large->size);
+    if (!is_zero(zeroed->data, zeroed->size))
+        ret = 16;
+    av_buffer_unref(&large);
+    av_buffer_unref(&zeroed);
+    av_buffer_set_allocator(NULL);
+
+    av_buffer_get_alloc_stats(&stats);
+    if (stats.nb_allocs != 5 || stats.nb_frees != 5 || stats.bytes != 0)
+        ret = 17;
+
+    return ret;
+}
+
+int main(void)
+{
+    int ret;
+
+    if ((ret = custom_allocator()))
+        return ret;
+
+    if ((ret = trim_pool(0)))
+        return ret;
+    if ((ret = trim_pool(AV_BUFFER_POOL_FLAG_LOCKLESS)))
+        return ret;
+
+    if ((ret = stress_pool(0)))
+        return ret;
+    if ((ret = stress_pool(AV_BUFFER_POOL_FLAG_LOCKLESS)))
+        return ret;
+
+    return 0;
+}
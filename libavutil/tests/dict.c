@@ -19,6 +19,7 @@
  */
 
 #include "libavutil/dict.c"
+#include "libavutil/time.h"
 
 static void print_dict(const AVDictionary *m)
 {
@@ -49,12 +50,119 @@ static void test_separators(const AVDictionary *m, const char pair, const char v
     av_dict_free(&dict);
 }
 
-int main(void)
+static void test_index(void)
+{
+    AVDictionary *dict = NULL;
+    AVDictionaryEntry *e;
+    char key[16], val[16];
+    int i;
+
+    printf("\nTesting lookups in large dictionaries\n");
+    for (i = 0; i < 64; i++) {
+        snprintf(key, sizeof(key), "Key%d", i);
+        snprintf(val, sizeof(val), "%d", i);
+        av_dict_set(&dict, key, val, 0);
+    }
+    for (i = 0; i < 64; i += 3) {
+        snprintf(key, sizeof(key), "KEY%d", i);
+        av_dict_set(&dict, key, NULL, 0);
+    }
+    for (i = 1; i < 64; i += 5) {
+        snprintf(key, sizeof(key), "key%d", i);
+        av_dict_set(&dict, key, "new", 0);
+    }
+    av_dict_set(&dict, "key2", "dup", AV_DICT_MULTIKEY);
+    av_dict_set(&dict, "key4", "+", AV_DICT_APPEND);
+    av_dict_set(&dict, "key5", "kept", AV_DICT_DONT_OVERWRITE);
+    av_dict_set(&dict, "key7", "case", AV_DICT_MATCH_CASE);
+    printf("count %d\n", av_dict_count(dict));
+    for (i = 0; i < 64; i++) {
+        snprintf(key, sizeof(key), "kEy%d", i);
+        e = av_dict_get(dict, key, NULL, 0);
+        printf("%s=%s%s", key, e ? e->value : "(null)", i % 8 == 7 ? "\n" : " ");
+    }
+    e = av_dict_get(dict, "Key7", NULL, AV_DICT_MATCH_CASE);
+    printf("Key7 %s\n", e ? e->value : "(null)");
+    e = av_dict_get(dict, "key7", NULL, AV_DICT_MATCH_CASE);
+    printf("key7 %s\n", e ? e->value : "(null)");
+    e = NULL;
+    while ((e = av_dict_get(dict, "KEY2", e, 0)))
+        printf("%s %s\n", e->key, e->value);
+    e = NULL;
+    while ((e = av_dict_get(dict, "key6", e, AV_DICT_IGNORE_SUFFIX)))
+        printf("%s %s\n", e->key, e->value);
+    av_dict_free(&dict);
+}
+
+static void test_arena(void)
+{
+    AVDictionary *dict = NULL;
+    AVDictionaryEntry *e;
+    AVBufferRef *arena = ff_buffer_arena_alloc(256);
+
+    printf("\nTesting a dictionary with an arena\n");
+    if (!arena || ff_dict_init_arena(&dict, arena) < 0) {
+        printf("allocation failed\n");
+        return;
+    }
+    av_dict_set(&dict, "aaa", "1", 0);
+    av_dict_set(&dict, "bbb", "2", 0);
+    e = av_dict_get(dict, "aaa", NULL, 0);
+    printf("aaa %s, in arena %d\n", e->value, ff_buffer_arena_owns(arena, e->value));
+    av_dict_set(&dict, "aaa", NULL, 0);
+    av_dict_set(&dict, "BBB", NULL, 0);
+    printf("count %d, kept %d\n", av_dict_count(dict), dict && dict->arena->data == arena->data);
+    av_dict_set(&dict, "ccc", "3", 0);
+    e = av_dict_get(dict, "ccc", NULL, 0);
+    printf("ccc %s, in arena %d\n", e->value, ff_buffer_arena_owns(arena, e->value));
+    av_dict_set(&dict, "ddd", av_strdup("4"), AV_DICT_DONT_STRDUP_VAL);
+    av_dict_set(&dict, "ccc", "5", AV_DICT_APPEND);
+    e = NULL;
+    while ((e = av_dict_get(dict, "", e, AV_DICT_IGNORE_SUFFIX)))
+        printf("%s %s, in arena %d\n", e->key, e->value,
+               ff_buffer_arena_owns(arena, e->value));
+    av_dict_free(&dict);
+    av_buffer_unref(&arena);
+}
+
+static void benchmark(int nb_entries)
+{
+    AVDictionary *dict = NULL;
+    char key[32];
+    int64_t t_set, t_get;
+    int i;
+
+    t_set = av_gettime_relative();
+    for (i = 0; i < nb_entries; i++) {
+        snprintf(key, sizeof(key), "com.example.key.%d", i);
+        av_dict_set(&dict, key, "value", 0);
+    }
+    t_set = av_gettime_relative() - t_set;
+
+    t_get = av_gettime_relative();
+    for (i = 0; i < nb_entries; i++) {
+        snprintf(key, sizeof(key), "COM.EXAMPLE.KEY.%d", nb_entries - 1 - i);
+        if (!av_dict_get(dict, key, NULL, 0))
+            printf("%s not found\n", key);
+    }
+    t_get = av_gettime_relative() - t_get;
+
+    printf("%d entries: set %.1f ns/entry, get %.1f ns/entry\n", nb_entries,
+           t_set * 1000.0 / nb_entries, t_get * 1000.0 / nb_entries);
+    av_dict_free(&dict);
+}
+
+int main(int argc, char **argv)
 {
     AVDictionary *dict = NULL;
     AVDictionaryEntry *e;
     char *buffer = NULL;
 
+    if (argc > 1) {
+        benchmark(atoi(argv[1]));
+        return 0;
+    }
+
     printf("Testing av_dict_get_string() and av_dict_parse_string()\n");
     av_dict_get_string(dict, &buffer, '=', ',');
     printf("%s\n", buffer);
@@ -132,5 +240,8 @@ int main(void)
     printf("%s\n", e->value);
     av_dict_free(&dict);
 
+    test_index();
+    test_arena();
+
     return 0;
 }
@@ -0,0 +1,231 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * This test program runs several clients of the shared pool from different
+ * threads at once. It checks that every job runs exactly once, that no two
+ * running jobs of a client share a thread slot, that jobs depending on
+ * earlier jobs of the same client make progress and that tasks can be
+ * nested. It then checks that clients can be freed from pool jobs and that
+ * the workers can be stopped and restarted.
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/error.h"
+#include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
+
+#define NB_CLIENTS     6
+#define MAX_THREADS    3
+#define NB_JOBS        64
+#define NB_ITERATIONS  200
+
+typedef struct Client {
+    ThreadPoolClient *client;
+    ThreadPoolClient *nested;
+    atomic_int slot_used[MAX_THREADS];
+    atomic_int runs[NB_JOBS];
+    atomic_int nested_runs;
+    pthread_mutex_t progress_lock;
+    pthread_cond_t progress_cond;
+    int progress;
+    int error;
+} Client;
+
+static int use_slot(Client *c, int threadnr)
+{
+    if (threadnr < 0 || threadnr >= MAX_THREADS ||
+        atomic_exchange(&c->slot_used[threadnr], 1)) {
+        c->error = 1;
+        return 0;
+    }
+    return 1;
+}
+
+static void release_slot(Client *c, int threadnr)
+{
+    atomic_store(&c->slot_used[threadnr], 0);
+}
+
+static void count_job(void *priv, int jobnr, int threadnr)
+{
+    Client *c = priv;
+
+    if (!use_slot(c, threadnr))
+        return;
+    atomic_fetch_add(&c->runs[jobnr], 1);
+    release_slot(c, threadnr);
+}
+
+/* each job waits for the previous one, like wavefront decoding does */
+static void chain_job(void *priv, int jobnr, int threadnr)
+{
+    Client *c = priv;
+
+    if (!use_slot(c, threadnr))
+        return;
+    pthread_mutex_lock(&c->progress_lock);
+    while (c->progress < jobnr)
+        pthread_cond_wait(&c->progress_cond, &c->progress_lock);
+    c->progress = jobnr + 1;
+    pthread_cond_broadcast(&c->progress_cond);
+    pthread_mutex_unlock(&c->progress_lock);
+    release_slot(c, threadnr);
+}
+
+static void count_nested_job(void *priv, int jobnr, int threadnr)
+{
+    Client *c = priv;
+
+    if (threadnr)
+        c->error = 1;
+    atomic_fetch_add(&c->nested_runs, 1);
+}
+
+static void nested_job(void *priv, int jobnr, int threadnr)
+{
+    Client *c = priv;
+    ThreadPoolTask task = { .func = count_nested_job, .priv = c, .nb_jobs = 2 };
+
+    avpriv_threadpool_execute(c->nested, &task);
+}
+
+static int check_runs(Client *c, int expected)
+{
+    int i;
+
+    for (i = 0; i < NB_JOBS; i++)
+        if (atomic_load(&c->runs[i]) != expected)
+            return 0;
+    return 1;
+}
+
+static void *client_thread(void *arg)
+{
+    Client *c = arg;
+    ThreadPoolTask tasks[4];
+    int i, j;
+
+    for (i = 0; i < NB_ITERATIONS && !c->error; i++) {
+        tasks[0] = (ThreadPoolTask){ .func = count_job, .priv = c, .nb_jobs = NB_JOBS };
+        avpriv_threadpool_execute(c->client, &tasks[0]);
+        if (!check_runs(c, 2 * i + 1))
+            c->error = 1;
+
+        c->progress = 0;
+        tasks[1] = (ThreadPoolTask){ .func = chain_job, .priv = c, .nb_jobs = NB_JOBS };
+        avpriv_threadpool_execute(c->client, &tasks[1]);
+        if (c->progress != NB_JOBS)
+            c->error = 1;
+
+        /* queued tasks, waited for together */
+        tasks[2] = (ThreadPoolTask){ .func = count_job, .priv = c, .nb_jobs = NB_JOBS / 2 };
+        tasks[3] = (ThreadPoolTask){ .func = nested_job, .priv = c, .nb_jobs = NB_JOBS / 2 };
+        avpriv_threadpool_submit(c->client, &tasks[2]);
+        avpriv_threadpool_submit(c->client, &tasks[3]);
+        avpriv_threadpool_wait(c->client);
+        if (atomic_load(&c->runs[0]) != 2 * i + 2 ||
+            atomic_load(&c->nested_runs) != (i + 1) * NB_JOBS)
+            c->error = 1;
+        for (j = NB_JOBS / 2; j < NB_JOBS; j++)
+            atomic_fetch_add(&c->runs[j], 1);
+    }
+
+    return NULL;
+}
+
+static void free_client_job(void *priv, int jobnr, int threadnr)
+{
+    ThreadPoolClient **other = priv;
+
+    /* the last other client is freed from a pool worker */
+    avpriv_threadpool_client_free(&other[jobnr]);
+}
+
+static int test_lifetime(void)
+{
+    ThreadPoolClient *client, *other[2];
+    ThreadPoolTask task = { .func = free_client_job, .priv = other, .nb_jobs = 2 };
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        if (avpriv_threadpool_client_alloc(&client, 1) < 0 ||
+            avpriv_threadpool_client_alloc(&other[0], 1) < 0 ||
+            avpriv_threadpool_client_alloc(&other[1], 1) < 0)
+            return 1;
+        if (avpriv_threadpool_uninit() != AVERROR(EBUSY))
+            return 2;
+        avpriv_threadpool_submit(client, &task);
+        avpriv_threadpool_wait(client);
+        if (other[0] || other[1])
+            return 3;
+        avpriv_threadpool_client_free(&client);
+        if (avpriv_threadpool_uninit() < 0)
+            return 4;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    Client clients[NB_CLIENTS];
+    pthread_t threads[NB_CLIENTS];
+    int i, ret = 0;
+
+    memset(clients, 0, sizeof(clients));
+
+    for (i = 0; i < NB_CLIENTS; i++) {
+        Client *c = &clients[i];
+        pthread_mutex_init(&c->progress_lock, NULL);
+        pthread_cond_init(&c->progress_cond, NULL);
+        if (avpriv_threadpool_client_alloc(&c->client, MAX_THREADS) < 0 ||
+            avpriv_threadpool_client_alloc(&c->nested, 1) < 0) {
+            fprintf(stderr, "Failed to allocate client %d.\n", i);
+            return 1;
+        }
+    }
+
+    for (i = 0; i < NB_CLIENTS; i++) {
+        if ((ret = pthread_create(&threads[i], NULL, client_thread, &clients[i]))) {
+            fprintf(stderr, "pthread_create failed: %s.\n", strerror(ret));
+            return 1;
+        }
+    }
+    for (i = 0; i < NB_CLIENTS; i++) {
+        pthread_join(threads[i], NULL);
+        if (clients[i].error) {
+            fprintf(stderr, "Client %d failed.\n", i);
+            ret = 1;
+        }
+        avpriv_threadpool_client_free(&clients[i].client);
+        avpriv_threadpool_client_free(&clients[i].nested);
+        pthread_mutex_destroy(&clients[i].progress_lock);
+        pthread_cond_destroy(&clients[i].progress_cond);
+    }
+
+    if (test_lifetime()) {
+        fprintf(stderr, "Client lifetime test failed.\n");
+        ret = 1;
+    }
+
+    return ret;
+}
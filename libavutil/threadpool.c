@@ -0,0 +1,396 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "cpu.h"
+#include "error.h"
+#include "internal.h"
+#include "mem.h"
+#include "thread.h"
+#include "threadpool.h"
+
+#if HAVE_THREADS
+
+struct ThreadPoolClient {
+    ThreadPoolTask *first;      ///< first task with jobs left to start
+    ThreadPoolTask *last;
+    int nb_pending;             ///< number of tasks not completed yet
+    pthread_cond_t done_cond;   ///< signaled when a task completes
+
+    int *free_slots;            ///< thread slots not used by a running job
+    int nb_free_slots;
+
+    /* ring of the clients with jobs that can be started */
+    ThreadPoolClient *prev, *next;
+    int ready;
+};
+
+typedef struct ThreadPool {
+    pthread_mutex_t lock;       ///< protects the pool and all its clients
+    pthread_cond_t  work_cond;  ///< signaled when jobs can be started
+    ThreadPoolClient *ready;    ///< next client to take a job from
+    int exit;
+
+    /* the workers are started with the first client and kept until
+     * avpriv_threadpool_uninit(), so that they are not respawned whenever
+     * the number of clients drops to zero */
+    pthread_mutex_t init_lock;  ///< serializes starting and stopping workers
+    pthread_t *workers;
+    int nb_workers;
+    int nb_clients;
+} ThreadPool;
+
+static ThreadPool pool;
+static AVOnce pool_once = AV_ONCE_INIT;
+
+static void pool_init(void)
+{
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_mutex_init(&pool.init_lock, NULL);
+    pthread_cond_init(&pool.work_cond, NULL);
+}
+
+static int client_can_start(const ThreadPoolClient *c)
+{
+    return c->first && c->nb_free_slots;
+}
+
+static void ready_add(ThreadPoolClient *c)
+{
+    if (c->ready)
+        return;
+    c->ready = 1;
+    if (!pool.ready) {
+        c->prev = c->next = c;
+        pool.ready = c;
+    } else {
+        /* insert last in the round-robin order */
+        c->next = pool.ready;
+        c->prev = pool.ready->prev;
+        c->prev->next = c;
+        c->next->prev = c;
+    }
+}
+
+static void ready_remove(ThreadPoolClient *c)
+{
+    if (!c->ready)
+        return;
+    c->ready = 0;
+    if (c->next == c) {
+        pool.ready = NULL;
+    } else {
+        c->prev->next = c->next;
+        c->next->prev = c->prev;
+        if (pool.ready == c)
+            pool.ready = c->next;
+    }
+}
+
+static ThreadPoolTask *take_job(ThreadPoolClient *c, int *jobnr, int *slot)
+{
+    ThreadPoolTask *task = c->first;
+
+    *jobnr = task->next_job++;
+    *slot  = c->free_slots[--c->nb_free_slots];
+    if (task->next_job == task->nb_jobs) {
+        c->first = task->next;
+        if (!c->first)
+            c->last = NULL;
+    }
+    if (!client_can_start(c))
+        ready_remove(c);
+    return task;
+}
+
+/* the task must not be accessed after this, its owner may free it */
+static void finish_job(ThreadPoolClient *c, ThreadPoolTask *task, int slot)
+{
+    c->free_slots[c->nb_free_slots++] = slot;
+    if (++task->nb_done == task->nb_jobs) {
+        c->nb_pending--;
+        pthread_cond_broadcast(&c->done_cond);
+    }
+    if (client_can_start(c))
+        ready_add(c);
+}
+
+static void enqueue(ThreadPoolClient *c, ThreadPoolTask *task)
+{
+    task->next_job = 0;
+    task->nb_done  = 0;
+    task->next     = NULL;
+
+    if (c->last)
+        c->last->next = task;
+    else
+        c->first = task;
+    c->last = task;
+    c->nb_pending++;
+
+    if (client_can_start(c))
+        ready_add(c);
+    if (task->nb_jobs > 1)
+        pthread_cond_broadcast(&pool.work_cond);
+    else
+        pthread_cond_signal(&pool.work_cond);
+}
+
+static void *attribute_align_arg worker(void *arg)
+{
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        ThreadPoolClient *c;
+        ThreadPoolTask *task;
+        int jobnr, slot;
+
+        while (!pool.ready && !pool.exit)
+            pthread_cond_wait(&pool.work_cond, &pool.lock);
+        if (!pool.ready)
+            break;
+
+        c    = pool.ready;
+        task = take_job(c, &jobnr, &slot);
+        /* serve the clients in turn */
+        if (pool.ready == c)
+            pool.ready = c->next;
+
+        pthread_mutex_unlock(&pool.lock);
+        task->func(task->priv, jobnr, slot);
+        pthread_mutex_lock(&pool.lock);
+
+        finish_job(c, task, slot);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    return NULL;
+}
+
+static void stop_workers(void)
+{
+    int i;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.exit = 1;
+    pthread_cond_broadcast(&pool.work_cond);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (i = 0; i < pool.nb_workers; i++)
+        pthread_join(pool.workers[i], NULL);
+    av_freep(&pool.workers);
+    pool.nb_workers = 0;
+    pool.exit       = 0;
+}
+
+static int start_workers(void)
+{
+    int i, ret, nb_workers = av_cpu_count();
+
+    pool.workers = av_mallocz_array(nb_workers, sizeof(*pool.workers));
+    if (!pool.workers)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < nb_workers; i++) {
+        ret = pthread_create(&pool.workers[i], NULL, worker, NULL);
+        if (ret) {
+            /* run with the workers started so far, if any */
+            if (!i) {
+                av_freep(&pool.workers);
+                return AVERROR(ret);
+            }
+            break;
+        }
+        pool.nb_workers++;
+    }
+
+    return 0;
+}
+
+int avpriv_threadpool_client_alloc(ThreadPoolClient **pclient, int max_threads)
+{
+    ThreadPoolClient *c;
+    int i, ret = 0;
+
+    *pclient = NULL;
+    if (max_threads <= 0)
+        return AVERROR(EINVAL);
+
+    ff_thread_once(&pool_once, pool_init);
+
+    c = av_mallocz(sizeof(*c));
+    if (!c)
+        return AVERROR(ENOMEM);
+    c->free_slots = av_malloc_array(max_threads, sizeof(*c->free_slots));
+    if (!c->free_slots) {
+        av_free(c);
+        return AVERROR(ENOMEM);
+    }
+    /* hand out the lowest slots first */
+    for (i = 0; i < max_threads; i++)
+        c->free_slots[i] = max_threads - 1 - i;
+    c->nb_free_slots = max_threads;
+
+    pthread_mutex_lock(&pool.init_lock);
+    if (!pool.nb_workers)
+        ret = start_workers();
+    if (!ret)
+        pool.nb_clients++;
+    pthread_mutex_unlock(&pool.init_lock);
+
+    if (ret < 0) {
+        av_freep(&c->free_slots);
+        av_free(c);
+        return ret;
+    }
+
+    pthread_cond_init(&c->done_cond, NULL);
+    *pclient = c;
+    return 0;
+}
+
+void avpriv_threadpool_client_free(ThreadPoolClient **pclient)
+{
+    ThreadPoolClient *c = *pclient;
+
+    if (!c)
+        return;
+
+    avpriv_threadpool_wait(c);
+
+    pthread_mutex_lock(&pool.init_lock);
+    pool.nb_clients--;
+    pthread_mutex_unlock(&pool.init_lock);
+
+    pthread_cond_destroy(&c->done_cond);
+    av_freep(&c->free_slots);
+    av_freep(pclient);
+}
+
+int avpriv_threadpool_uninit(void)
+{
+    int i, ret = 0;
+
+    ff_thread_once(&pool_once, pool_init);
+
+    pthread_mutex_lock(&pool.init_lock);
+    if (pool.nb_clients)
+        ret = AVERROR(EBUSY);
+    /* a worker cannot join itself */
+    for (i = 0; i < pool.nb_workers && !ret; i++)
+        if (pthread_equal(pool.workers[i], pthread_self()))
+            ret = AVERROR(EDEADLK);
+    if (!ret)
+        stop_workers();
+    pthread_mutex_unlock(&pool.init_lock);
+
+    return ret;
+}
+
+void avpriv_threadpool_submit(ThreadPoolClient *c, ThreadPoolTask *task)
+{
+    if (task->nb_jobs <= 0)
+        return;
+
+    pthread_mutex_lock(&pool.lock);
+    enqueue(c, task);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+void avpriv_threadpool_execute(ThreadPoolClient *c, ThreadPoolTask *task)
+{
+    if (task->nb_jobs <= 0)
+        return;
+
+    pthread_mutex_lock(&pool.lock);
+    enqueue(c, task);
+
+    for (;;) {
+        /* run our own jobs rather than sleep while the workers are busy, also
+         * once the tasks queued before ours completed, as all workers may be
+         * blocked in jobs of other clients */
+        while (c->first == task && c->nb_free_slots) {
+            int jobnr, slot;
+
+            take_job(c, &jobnr, &slot);
+            pthread_mutex_unlock(&pool.lock);
+            task->func(task->priv, jobnr, slot);
+            pthread_mutex_lock(&pool.lock);
+            finish_job(c, task, slot);
+        }
+        if (task->nb_done == task->nb_jobs)
+            break;
+        pthread_cond_wait(&c->done_cond, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+}
+
+void avpriv_threadpool_wait_task(ThreadPoolClient *c, ThreadPoolTask *task)
+{
+    pthread_mutex_lock(&pool.lock);
+    while (task->nb_done < task->nb_jobs)
+        pthread_cond_wait(&c->done_cond, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+void avpriv_threadpool_wait(ThreadPoolClient *c)
+{
+    pthread_mutex_lock(&pool.lock);
+    while (c->nb_pending)
+        pthread_cond_wait(&c->done_cond, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+#else
+
+struct ThreadPoolClient {
+    int dummy;
+};
+
+int avpriv_threadpool_client_alloc(ThreadPoolClient **pclient, int max_threads)
+{
+    *pclient = NULL;
+    return AVERROR(ENOSYS);
+}
+
+void avpriv_threadpool_client_free(ThreadPoolClient **pclient)
+{
+}
+
+int avpriv_threadpool_uninit(void)
+{
+    return 0;
+}
+
+void avpriv_threadpool_submit(ThreadPoolClient *c, ThreadPoolTask *task)
+{
+}
+
+void avpriv_threadpool_execute(ThreadPoolClient *c, ThreadPoolTask *task)
+{
+}
+
+void avpriv_threadpool_wait_task(ThreadPoolClient *c, ThreadPoolTask *task)
+{
+}
+
+void avpriv_threadpool_wait(ThreadPoolClient *c)
+{
+}
+
+#endif /* HAVE_THREADS */
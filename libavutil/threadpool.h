@@ -0,0 +1,120 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Process-wide shared worker pool.
+ *
+ * The pool owns one worker thread per CPU core and is shared by all its
+ * clients, e.g. codec or filter graph contexts, so that the number of threads
+ * in a process does not grow with the number of contexts. Workers serve the
+ * clients with pending work in round-robin order, one job at a time, and
+ * each client may cap the number of its jobs running at once.
+ *
+ * Jobs of a client are started in submission order. A job may block waiting
+ * for a job of the same client submitted before it, but never for a later one.
+ *
+ * All jobs are taken from a single queue under one lock rather than from
+ * per-worker deques with work stealing: stealing would start jobs out of
+ * submission order, which breaks the guarantee above that wavefront and
+ * pipelined decoding rely on, and the per-client limit on running jobs needs
+ * a global view anyway. The jobs run by lavc, lavfi and swscale are whole
+ * slices, rows or frames, so the lock is taken rarely compared to the work
+ * done in between.
+ *
+ * The workers are started with the first client and then kept running until
+ * avpriv_threadpool_uninit() is called, rather than being stopped whenever
+ * the last client is freed.
+ */
+
+#ifndef AVUTIL_THREADPOOL_H
+#define AVUTIL_THREADPOOL_H
+
+typedef struct ThreadPoolClient ThreadPoolClient;
+
+typedef struct ThreadPoolTask {
+    /**
+     * Job function, called once per job.
+     *
+     * @param priv     the task's priv field
+     * @param jobnr    job number, in [0, nb_jobs)
+     * @param threadnr slot number of the calling thread, in [0, max_threads)
+     *                 of the client; no two concurrent jobs of a client get
+     *                 the same slot
+     */
+    void (*func)(void *priv, int jobnr, int threadnr);
+    void *priv;
+    int nb_jobs;
+
+    /* the following fields are private to the pool */
+    int next_job;
+    int nb_done;
+    struct ThreadPoolTask *next;
+} ThreadPoolTask;
+
+/**
+ * Attach a new client to the shared pool, starting the pool workers if they
+ * are not running.
+ *
+ * @param max_threads maximum number of jobs of this client running at once
+ * @return 0 on success, a negative AVERROR code on failure, in particular
+ *         AVERROR(ENOSYS) if lavu was built without thread support
+ */
+int avpriv_threadpool_client_alloc(ThreadPoolClient **pclient, int max_threads);
+
+/**
+ * Wait for all tasks of the client to complete and detach it from the pool.
+ * The workers keep running. May be called from a pool job.
+ */
+void avpriv_threadpool_client_free(ThreadPoolClient **pclient);
+
+/**
+ * Stop the pool workers. They are started again by the next
+ * avpriv_threadpool_client_alloc().
+ *
+ * @return 0 on success, AVERROR(EBUSY) if clients are still attached,
+ *         AVERROR(EDEADLK) if called from a pool job
+ */
+int avpriv_threadpool_uninit(void);
+
+/**
+ * Queue a task to be run asynchronously by the pool workers.
+ *
+ * The task must stay valid and must not be submitted again until all its jobs
+ * have completed, which can be waited for with avpriv_threadpool_wait_task()
+ * or avpriv_threadpool_wait().
+ */
+void avpriv_threadpool_submit(ThreadPoolClient *client, ThreadPoolTask *task);
+
+/**
+ * Run all jobs of a task and wait for their completion. The calling thread
+ * takes part in running the jobs.
+ */
+void avpriv_threadpool_execute(ThreadPoolClient *client, ThreadPoolTask *task);
+
+/**
+ * Wait for all jobs of a submitted task to complete.
+ */
+void avpriv_threadpool_wait_task(ThreadPoolClient *client, ThreadPoolTask *task);
+
+/**
+ * Wait for all tasks submitted to the client to complete.
+ */
+void avpriv_threadpool_wait(ThreadPoolClient *client);
+
+#endif /* AVUTIL_THREADPOOL_H */
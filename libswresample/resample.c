@@ -27,8 +27,29 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/thread.h"
 #include "resample.h"
 
+/* The filter banks are shared by the resamplers with the same filter, e.g.
+ * the many streams of a mixer, which then build it once and all read the
+ * same copy. A bank is freed with the last resampler using it. */
+#define FILTER_BANK_CACHE_SIZE 16
+
+typedef struct FilterBankEntry {
+    enum AVSampleFormat format;
+    double factor;
+    int filter_length;
+    int phase_count;
+    enum SwrFilterType filter_type;
+    double kaiser_beta;
+    uint8_t *filter_bank;
+    int refs;
+} FilterBankEntry;
+
+static FilterBankEntry filter_banks[FILTER_BANK_CACHE_SIZE];
+static AVMutex filter_bank_lock;
+static AVOnce filter_bank_once = AV_ONCE_INIT;
+
 static inline double eval_poly(const double *coeff, int size, double x) {
     double sum = coeff[size-1];
     int i;
@@ -276,11 +297,109 @@ fail:
     return ret;
 }
 
+static void filter_bank_init(void)
+{
+    ff_mutex_init(&filter_bank_lock, NULL);
+}
+
+static int filter_bank_match(const FilterBankEntry *e, const ResampleContext *c)
+{
+    return e->filter_bank                     &&
+           e->format        == c->format        &&
+           e->factor        == c->factor        &&
+           e->filter_length == c->filter_length &&
+           e->phase_count   == c->phase_count   &&
+           e->filter_type   == c->filter_type   &&
+           e->kaiser_beta   == c->kaiser_beta;
+}
+
+/* take a reference to the shared bank of the filter of c, if there is one */
+static uint8_t *filter_bank_ref(const ResampleContext *c)
+{
+    uint8_t *bank = NULL;
+    int i;
+
+    ff_mutex_lock(&filter_bank_lock);
+    for (i = 0; i < FILTER_BANK_CACHE_SIZE; i++) {
+        if (filter_bank_match(&filter_banks[i], c)) {
+            filter_banks[i].refs++;
+            bank = filter_banks[i].filter_bank;
+            break;
+        }
+    }
+    ff_mutex_unlock(&filter_bank_lock);
+
+    return bank;
+}
+
+/* share the bank built for c, unless another thread shared one meanwhile or
+ * the cache is full, in which case it stays private to c */
+static void filter_bank_share(ResampleContext *c)
+{
+    FilterBankEntry *slot = NULL;
+    uint8_t *bank = NULL;
+    int i;
+
+    ff_mutex_lock(&filter_bank_lock);
+    for (i = 0; i < FILTER_BANK_CACHE_SIZE; i++) {
+        FilterBankEntry *e = &filter_banks[i];
+
+        if (filter_bank_match(e, c)) {
+            e->refs++;
+            bank = e->filter_bank;
+            break;
+        }
+        if (!e->filter_bank && !slot)
+            slot = e;
+    }
+    if (!bank && slot) {
+        slot->format        = c->format;
+        slot->factor        = c->factor;
+        slot->filter_length = c->filter_length;
+        slot->phase_count   = c->phase_count;
+        slot->filter_type   = c->filter_type;
+        slot->kaiser_beta   = c->kaiser_beta;
+        slot->filter_bank   = c->filter_bank;
+        slot->refs          = 1;
+    }
+    ff_mutex_unlock(&filter_bank_lock);
+
+    if (bank) {
+        av_free(c->filter_bank);
+        c->filter_bank = bank;
+    }
+}
+
+static void filter_bank_unref(uint8_t **bank)
+{
+    int i;
+
+    if (!*bank)
+        return;
+
+    ff_thread_once(&filter_bank_once, filter_bank_init);
+    ff_mutex_lock(&filter_bank_lock);
+    for (i = 0; i < FILTER_BANK_CACHE_SIZE; i++) {
+        FilterBankEntry *e = &filter_banks[i];
+
+        if (e->filter_bank == *bank) {
+            if (--e->refs)
+                *bank = NULL;
+            else
+                e->filter_bank = NULL;
+            break;
+        }
+    }
+    ff_mutex_unlock(&filter_bank_lock);
+
+    av_freep(bank);
+}
+
 static void resample_free(ResampleContext **cc){
     ResampleContext *c = *cc;
     if(!c)
         return;
-    av_freep(&c->filter_bank);
+    filter_bank_unref(&c->filter_bank);
     av_freep(cc);
 }
 
@@ -345,16 +464,22 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->factor        = factor;
         c->filter_length = filter_length;
         c->filter_alloc  = FFALIGN(c->filter_length, 8);
-        c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
         c->phase_count_compensation = phase_count_compensation;
-        if (!c->filter_bank)
-            goto error;
-        if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
-            goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+
+        ff_thread_once(&filter_bank_once, filter_bank_init);
+        c->filter_bank = filter_bank_ref(c);
+        if (!c->filter_bank) {
+            c->filter_bank = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
+            if (!c->filter_bank)
+                goto error;
+            if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
+                goto error;
+            memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
+            memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+            filter_bank_share(c);
+        }
     }
 
     c->compensation_distance= 0;
@@ -375,7 +500,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     return c;
 error:
-    av_freep(&c->filter_bank);
+    filter_bank_unref(&c->filter_bank);
     av_free(c);
     return NULL;
 }
@@ -423,7 +548,7 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
     c->dst_incr_mod   = c->dst_incr % c->src_incr;
     c->index         *= phase_count / c->phase_count;
     c->phase_count    = phase_count;
-    av_freep(&c->filter_bank);
+    filter_bank_unref(&c->filter_bank);
     c->filter_bank = new_filter_bank;
     return 0;
 }
@@ -494,8 +619,14 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
              * when frac and dst_incr_mod are zero */
             resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
                             c->dsp.resample_linear : c->dsp.resample_common;
-            for (i = 0; i < dst->ch_count; i++)
-                *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            if (resample_func == c->dsp.resample_common &&
+                c->dsp.resample_common_multi && dst->ch_count > 1) {
+                *consumed = c->dsp.resample_common_multi(c, dst->ch, (const uint8_t **)src->ch,
+                                                         dst->ch_count, dst_size, 1);
+            } else {
+                for (i = 0; i < dst->ch_count; i++)
+                    *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            }
         }
     }
 
@@ -524,6 +655,12 @@ static int64_t get_delay(struct SwrContext *s, int64_t base){
     return av_rescale(num, base, s->in_sample_rate*(int64_t)c->src_incr * c->phase_count);
 }
 
+static int64_t get_latency(struct SwrContext *s, int64_t base){
+    ResampleContext *c = s->resample;
+    // input samples needed past an output position, including its fractional part
+    return av_rescale(c->filter_length/2 + 1, base, s->in_sample_rate);
+}
+
 static int64_t get_out_samples(struct SwrContext *s, int in_samples) {
     ResampleContext *c = s->resample;
     // The + 2 are added to allow implementations to be slightly inaccurate, they should not be needed currently.
@@ -616,4 +753,5 @@ struct Resampler const swri_resampler={
   get_delay,
   invert_initial_buffer,
   get_out_samples,
+  get_latency,
 };
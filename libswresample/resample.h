@@ -57,6 +57,11 @@ typedef struct ResampleContext {
                                const void *src, int n, int update_ctx);
         int (*resample_linear)(struct ResampleContext *c, void *dst,
                                const void *src, int n, int update_ctx);
+        /* resample_common for ch_count channels at once, each filter phase
+         * being applied to all the channels */
+        int (*resample_common_multi)(struct ResampleContext *c, uint8_t **dst,
+                                     const uint8_t **src, int ch_count,
+                                     int n, int update_ctx);
     } dsp;
 } ResampleContext;
 
@@ -140,6 +140,64 @@ static int RENAME(resample_common)(ResampleContext *c,
     return sample_index;
 }
 
+static int RENAME(resample_common_multi)(ResampleContext *c,
+                                         uint8_t **dest, const uint8_t **source,
+                                         int ch_count, int n, int update_ctx)
+{
+    int dst_index;
+    int index= c->index;
+    int frac= c->frac;
+    int sample_index = 0;
+
+    while (index >= c->phase_count) {
+        sample_index++;
+        index -= c->phase_count;
+    }
+
+    for (dst_index = 0; dst_index < n; dst_index++) {
+        FELEM *filter = ((FELEM *) c->filter_bank) + c->filter_alloc * index;
+        int ch;
+
+        for (ch = 0; ch < ch_count; ch++) {
+            DELEM *dst = (DELEM *) dest[ch];
+            const DELEM *src = (const DELEM *) source[ch] + sample_index;
+            FELEM2 val = FOFFSET;
+            FELEM2 val2= 0;
+            int i;
+            for (i = 0; i + 1 < c->filter_length; i+=2) {
+                val  += src[i    ] * (FELEM2)filter[i    ];
+                val2 += src[i + 1] * (FELEM2)filter[i + 1];
+            }
+            if (i < c->filter_length)
+                val  += src[i    ] * (FELEM2)filter[i    ];
+#ifdef FELEML
+            OUT(dst[dst_index], val + (FELEML)val2);
+#else
+            OUT(dst[dst_index], val + val2);
+#endif
+        }
+
+        frac  += c->dst_incr_mod;
+        index += c->dst_incr_div;
+        if (frac >= c->src_incr) {
+            frac -= c->src_incr;
+            index++;
+        }
+
+        while (index >= c->phase_count) {
+            sample_index++;
+            index -= c->phase_count;
+        }
+    }
+
+    if(update_ctx){
+        c->frac= frac;
+        c->index= index;
+    }
+
+    return sample_index;
+}
+
 static int RENAME(resample_linear)(ResampleContext *c,
                                    void *dest, const void *source,
                                    int n, int update_ctx)
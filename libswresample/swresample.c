@@ -195,6 +195,11 @@ av_cold int swr_init(struct SwrContext *s){
             return AVERROR(EINVAL);
     }
 
+    if (s->low_delay && s->engine != SWR_ENGINE_SWR) {
+        av_log(s, AV_LOG_ERROR, "Low delay mode is only supported by the swr engine\n");
+        return AVERROR(EINVAL);
+    }
+
     if(!s->used_ch_count)
         s->used_ch_count= s->in.ch_count;
 
@@ -264,7 +269,9 @@ av_cold int swr_init(struct SwrContext *s){
     }
 
     if (s->out_sample_rate!=s->in_sample_rate || (s->flags & SWR_FLAG_RESAMPLE)){
-        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational);
+        int filter_size    = s->low_delay ? FFMIN(s->filter_size, SWR_LOW_DELAY_FILTER_SIZE) : s->filter_size;
+        int exact_rational = s->low_delay || s->exact_rational;
+        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, exact_rational);
         if (!s->resample) {
             av_log(s, AV_LOG_ERROR, "Failed to initialize resampler\n");
             return AVERROR(ENOMEM);
@@ -382,6 +389,14 @@ av_assert0(s->out.ch_count);
             goto fail;
     }
 
+    /* prime the filter with its lookahead, so that every chunk outputs the
+     * samples of its duration right away */
+    if (s->low_delay && s->resample) {
+        ret = swr_inject_silence(s, s->resampler->get_latency(s, s->in_sample_rate));
+        if (ret < 0)
+            goto fail;
+    }
+
     return 0;
 fail:
     swr_close(s);
@@ -864,6 +879,15 @@ int64_t swr_get_delay(struct SwrContext *s, int64_t base){
     }
 }
 
+int64_t swr_get_latency(struct SwrContext *s, int64_t base){
+    if (s->resampler && s->resample){
+        if (!s->resampler->get_latency)
+            return AVERROR(ENOSYS);
+        return s->resampler->get_latency(s, base);
+    }
+    return 0;
+}
+
 int swr_get_out_samples(struct SwrContext *s, int in_samples)
 {
     int64_t out_samples;
@@ -886,6 +910,20 @@ int swr_get_out_samples(struct SwrContext *s, int in_samples)
     return out_samples;
 }
 
+int swr_convert_chunk(struct SwrContext *s, uint8_t **out,
+                      const uint8_t **in, int in_count)
+{
+    int64_t out_count = in_count * (int64_t)s->out_sample_rate;
+
+    if (!swr_is_initialized(s) || !s->low_delay || in_count <= 0 ||
+        out_count % s->in_sample_rate) {
+        av_log(s, AV_LOG_ERROR, "Chunks of %d samples are not supported\n", in_count);
+        return AVERROR(EINVAL);
+    }
+
+    return swr_convert(s, out, out_count / s->in_sample_rate, in, in_count);
+}
+
 int swr_set_compensation(struct SwrContext *s, int sample_delta, int compensation_distance){
     int ret;
 
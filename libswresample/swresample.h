@@ -310,6 +310,27 @@ void swr_close(struct SwrContext *s);
 int swr_convert(struct SwrContext *s, uint8_t **out, int out_count,
                                 const uint8_t **in , int in_count);
 
+/**
+ * Convert a chunk of audio in low delay mode.
+ *
+ * The context must have been initialized with the "low_delay" option set.
+ * The resampling filter is then primed by swr_init(), so that every chunk
+ * outputs exactly in_count * out_sample_rate / in_sample_rate samples, from
+ * the first call on, and nothing accumulates inside the context. This is
+ * meant for real time processing of fixed size chunks, e.g. 10 ms of audio.
+ *
+ * @param s         initialized Swr context, with low_delay set
+ * @param out       output buffers, only the first one need be set in case of packed audio
+ * @param in        input buffers, only the first one need to be set in case of packed audio
+ * @param in_count  number of input samples in one channel, in_count * out_sample_rate
+ *                  must be a multiple of in_sample_rate
+ *
+ * @return number of samples output per channel, negative value on error
+ * @see swr_get_latency()
+ */
+int swr_convert_chunk(struct SwrContext *s, uint8_t **out,
+                      const uint8_t **in, int in_count);
+
 /**
  * Convert the next timestamp from input to output
  * timestamps are in 1/(in_sample_rate * out_sample_rate) units.
@@ -466,6 +487,22 @@ int swr_inject_silence(struct SwrContext *s, int count);
  */
 int64_t swr_get_delay(struct SwrContext *s, int64_t base);
 
+/**
+ * Gets the algorithmic latency of the resampling filter.
+ *
+ * This is the amount of input the filter needs past a given position to
+ * output the corresponding sample. In low delay mode it is the amount of
+ * silence the filter is primed with, i.e. the exact delay between the input
+ * and the output of swr_convert_chunk(). Unlike swr_get_delay() it does not
+ * depend on the buffered data.
+ *
+ * @param s     initialized Swr context
+ * @param base  timebase in which the returned latency will be, see swr_get_delay()
+ * @returns     the latency in 1 / @c base units, 0 if no resampling is done,
+ *              AVERROR(ENOSYS) if the resampling engine does not support it
+ */
+int64_t swr_get_latency(struct SwrContext *s, int64_t base);
+
 /**
  * Find an upper bound on the number of samples that the next swr_convert
  * call will output, if called with in_samples of input samples. This
@@ -31,6 +31,8 @@
 
 #define NS_TAPS 20
 
+#define SWR_LOW_DELAY_FILTER_SIZE 16 ///< maximum filter size in low delay mode
+
 #if ARCH_X86_64
 typedef int64_t integer;
 #else
@@ -77,6 +79,7 @@ typedef int     (* set_compensation_func)(struct ResampleContext *c, int sample_
 typedef int64_t (* get_delay_func)(struct SwrContext *s, int64_t base);
 typedef int     (* invert_initial_buffer_func)(struct ResampleContext *c, AudioData *dst, const AudioData *src, int src_size, int *dst_idx, int *dst_count);
 typedef int64_t (* get_out_samples_func)(struct SwrContext *s, int in_samples);
+typedef int64_t (* get_latency_func)(struct SwrContext *s, int64_t base);
 
 struct Resampler {
   resample_init_func            init;
@@ -87,6 +90,7 @@ struct Resampler {
   get_delay_func                get_delay;
   invert_initial_buffer_func    invert_initial_buffer;
   get_out_samples_func          get_out_samples;
+  get_latency_func              get_latency;
 };
 
 extern struct Resampler const swri_resampler;
@@ -128,6 +132,7 @@ struct SwrContext {
     int phase_shift;                                /**< log2 of the number of entries in the resampling polyphase filterbank */
     int linear_interp;                              /**< if 1 then the resampling FIR filter will be linearly interpolated */
     int exact_rational;                             /**< if 1 then enable non power of 2 phase_count */
+    int low_delay;                                  /**< if 1 then use a short filter and output fixed size chunks from the first call */
     double cutoff;                                  /**< resampling cutoff frequency (swr: 6dB point; soxr: 0dB point). 1.0 corresponds to half the output sample rate */
     int filter_type;                                /**< swr resampling filter type */
     double kaiser_beta;                                /**< swr beta value for Kaiser window (only applicable if filter_type == AV_FILTER_TYPE_KAISER) */
@@ -0,0 +1,164 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that the low delay mode outputs exactly 10 ms for every 10 ms chunk
+ * and that the output is delayed by the reported latency, or with -b, compare
+ * the time per 10 ms chunk to the default mode.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/time.h"
+#include "libswresample/swresample.h"
+
+#define CHUNKS   50
+#define MAX_RATE 48000
+#define FREQ     440.0
+
+static const struct {
+    int in_rate, out_rate;
+} tests[] = {
+    { 48000, 48000 },
+    { 48000, 16000 },
+    { 16000, 48000 },
+    { 44100, 48000 },
+    { 48000, 44100 },
+    {  8000, 32000 },
+};
+
+static struct SwrContext *get_context(int in_rate, int out_rate, int low_delay)
+{
+    struct SwrContext *s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_STEREO, AV_SAMPLE_FMT_FLTP, out_rate,
+                                              AV_CH_LAYOUT_STEREO, AV_SAMPLE_FMT_FLTP, in_rate,
+                                              0, NULL);
+    if (!s)
+        return NULL;
+    av_opt_set_int(s, "low_delay", low_delay, 0);
+    if (swr_init(s) < 0)
+        swr_free(&s);
+    return s;
+}
+
+static void fill_sine(float *dst, int count, int64_t pos, int rate)
+{
+    int i;
+    for (i = 0; i < count; i++)
+        dst[i] = 0.5 * sin(2 * M_PI * FREQ * (pos + i) / rate);
+}
+
+static double bench(struct SwrContext *s, uint8_t **out, int out_count,
+                    const uint8_t **in, int in_count)
+{
+    int64_t t = av_gettime_relative();
+    int i, n = 0;
+
+    do {
+        for (i = 0; i < 100; i++)
+            swr_convert(s, out, out_count, in, in_count);
+        n += 100;
+    } while (av_gettime_relative() - t < 500000);
+
+    return (av_gettime_relative() - t) / (double)n;
+}
+
+int main(int argc, char **argv)
+{
+    int do_bench = argc > 1 && !strcmp(argv[1], "-b");
+    float in_buf[2][MAX_RATE / 100], out_buf[2][2 * MAX_RATE / 100];
+    uint8_t *out[2] = { (uint8_t *)out_buf[0], (uint8_t *)out_buf[1] };
+    const uint8_t *in[2] = { (const uint8_t *)in_buf[0], (const uint8_t *)in_buf[1] };
+    struct SwrContext *s = NULL, *s_default = NULL;
+    int i, j, ret = 1;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(tests); i++) {
+        int in_count  = tests[i].in_rate  / 100;
+        int out_count = tests[i].out_rate / 100;
+        int64_t latency, out_latency;
+        double max_diff = 0;
+        int sizes_ok = 1;
+
+        s = get_context(tests[i].in_rate, tests[i].out_rate, 1);
+        if (!s)
+            goto end;
+
+        fill_sine(in_buf[0], in_count, 0, tests[i].in_rate);
+        memcpy(in_buf[1], in_buf[0], sizeof(*in_buf[0]) * in_count);
+
+        if (do_bench) {
+            s_default = get_context(tests[i].in_rate, tests[i].out_rate, 0);
+            if (!s_default)
+                goto end;
+            printf("%d -> %d: default %.2f us, low delay %.2f us per chunk\n",
+                   tests[i].in_rate, tests[i].out_rate,
+                   bench(s_default, out, FF_ARRAY_ELEMS(out_buf[0]), in, in_count),
+                   bench(s,         out, out_count, in, in_count));
+            swr_free(&s_default);
+            swr_free(&s);
+            continue;
+        }
+
+        latency     = swr_get_latency(s, tests[i].in_rate);
+        out_latency = swr_get_latency(s, (int64_t)tests[i].in_rate * tests[i].out_rate);
+        if (latency < 0)
+            goto end;
+
+        for (j = 0; j < CHUNKS; j++) {
+            int k, n;
+
+            fill_sine(in_buf[0], in_count, (int64_t)j * in_count, tests[i].in_rate);
+            memcpy(in_buf[1], in_buf[0], sizeof(*in_buf[0]) * in_count);
+            n = swr_convert_chunk(s, out, in, in_count);
+            if (n != out_count) {
+                printf("%d -> %d: chunk %d: %d samples instead of %d\n",
+                       tests[i].in_rate, tests[i].out_rate, j, n, out_count);
+                sizes_ok = 0;
+                continue;
+            }
+
+            /* the output is the input delayed by the latency, skip the
+             * transition from the priming silence */
+            for (k = 0; k < n; k++) {
+                int64_t pos = (int64_t)j * out_count + k;
+                double t = (pos * (double)tests[i].in_rate - out_latency) / tests[i].out_rate;
+                if (t < 2 * latency)
+                    continue;
+                max_diff = FFMAX(max_diff, fabs(out_buf[0][k] - 0.5 * sin(2 * M_PI * FREQ * t / tests[i].in_rate)));
+                max_diff = FFMAX(max_diff, fabs(out_buf[1][k] - out_buf[0][k]));
+            }
+        }
+
+        printf("%d -> %d: latency %"PRId64" samples, %s, %s\n",
+               tests[i].in_rate, tests[i].out_rate, latency,
+               sizes_ok ? "chunk sizes ok" : "chunk sizes wrong",
+               max_diff < 0.01 ? "delay ok" : "delay wrong");
+        swr_free(&s);
+    }
+
+    ret = 0;
+end:
+    swr_free(&s);
+    swr_free(&s_default);
+    return ret;
+}
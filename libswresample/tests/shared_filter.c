@@ -0,0 +1,170 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that many mono streams sharing a filter bank convert like a stream
+ * with a bank of its own, also when one of them starts compensating, or with
+ * -b, time the setup and a 10 ms chunk of the streams.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/lfg.h"
+#include "libavutil/time.h"
+#include "libswresample/swresample.h"
+
+#define NB_STREAMS 256
+#define CHUNKS     10
+#define MAX_IN     (48000 / 100)
+#define MAX_OUT    (2 * 48000 / 100)
+
+static const struct {
+    int in_rate, out_rate;
+} tests[] = {
+    { 16000, 48000 },
+    { 48000, 16000 },
+    { 44100, 48000 },
+    { 48000, 44100 },
+};
+
+static int16_t in_buf [CHUNKS][MAX_IN];
+static int16_t ref_buf[CHUNKS][MAX_OUT];
+static int16_t out_buf[MAX_OUT];
+
+static struct SwrContext *alloc_context(int in_rate, int out_rate)
+{
+    struct SwrContext *s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_MONO, AV_SAMPLE_FMT_S16, out_rate,
+                                              AV_CH_LAYOUT_MONO, AV_SAMPLE_FMT_S16, in_rate,
+                                              0, NULL);
+    if (s && swr_init(s) < 0)
+        swr_free(&s);
+    return s;
+}
+
+static int alloc_contexts(struct SwrContext *s[NB_STREAMS], int in_rate, int out_rate)
+{
+    int i;
+
+    for (i = 0; i < NB_STREAMS; i++) {
+        s[i] = alloc_context(in_rate, out_rate);
+        if (!s[i])
+            return -1;
+    }
+    return 0;
+}
+
+static void free_contexts(struct SwrContext *s[NB_STREAMS])
+{
+    int i;
+
+    for (i = 0; i < NB_STREAMS; i++)
+        swr_free(&s[i]);
+}
+
+static int convert(struct SwrContext *s, int16_t *out, int chunk, int in_count)
+{
+    uint8_t *out_ptr      = (uint8_t *)out;
+    const uint8_t *in_ptr = (const uint8_t *)in_buf[chunk];
+
+    return swr_convert(s, &out_ptr, MAX_OUT, &in_ptr, in_count);
+}
+
+static void bench(int in_rate, int out_rate)
+{
+    struct SwrContext *s[NB_STREAMS] = { NULL };
+    int in_count = in_rate / 100;
+    int64_t t, setup;
+    int i, n = 0;
+
+    t = av_gettime_relative();
+    if (alloc_contexts(s, in_rate, out_rate) < 0)
+        goto end;
+    setup = av_gettime_relative() - t;
+
+    t = av_gettime_relative();
+    do {
+        for (i = 0; i < NB_STREAMS; i++)
+            convert(s[i], out_buf, n % CHUNKS, in_count);
+        n++;
+    } while (av_gettime_relative() - t < 500000);
+
+    printf("%d -> %d, %d streams: setup %.1f us, 10 ms chunk %.1f us\n",
+           in_rate, out_rate, NB_STREAMS, (double)setup,
+           (av_gettime_relative() - t) / (double)n);
+end:
+    free_contexts(s);
+}
+
+int main(int argc, char **argv)
+{
+    int do_bench = argc > 1 && !strcmp(argv[1], "-b");
+    struct SwrContext *s[NB_STREAMS] = { NULL }, *ref = NULL;
+    int i, j, k, x, ret = 1;
+    AVLFG lfg;
+
+    av_lfg_init(&lfg, 1);
+    for (j = 0; j < CHUNKS; j++)
+        for (x = 0; x < MAX_IN; x++)
+            in_buf[j][x] = av_lfg_get(&lfg) % 16384 - 8192;
+
+    for (k = 0; k < FF_ARRAY_ELEMS(tests); k++) {
+        int in_count = tests[k].in_rate / 100;
+        int ref_count[CHUNKS];
+        int ok = 1;
+
+        if (do_bench) {
+            bench(tests[k].in_rate, tests[k].out_rate);
+            continue;
+        }
+
+        /* the only context of its rates, with a bank of its own */
+        ref = alloc_context(tests[k].in_rate, tests[k].out_rate);
+        if (!ref)
+            goto end;
+        for (j = 0; j < CHUNKS; j++)
+            ref_count[j] = convert(ref, ref_buf[j], j, in_count);
+        swr_free(&ref);
+
+        if (alloc_contexts(s, tests[k].in_rate, tests[k].out_rate) < 0)
+            goto end;
+        /* a compensating stream uses a bank with more phases, built for it */
+        if (swr_set_compensation(s[0], 1, tests[k].out_rate) < 0)
+            goto end;
+
+        for (j = 0; j < CHUNKS; j++) {
+            for (i = 0; i < NB_STREAMS; i++) {
+                int n = convert(s[i], out_buf, j, in_count);
+                if (i && (n != ref_count[j] ||
+                          memcmp(out_buf, ref_buf[j], n * sizeof(*out_buf))))
+                    ok = 0;
+            }
+        }
+        free_contexts(s);
+
+        printf("%d -> %d: %s\n", tests[k].in_rate, tests[k].out_rate,
+               ok ? "ok" : "mismatch");
+    }
+
+    ret = 0;
+end:
+    swr_free(&ref);
+    free_contexts(s);
+    return ret;
+}
@@ -0,0 +1,302 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Process-wide caches of scaler filters and idle contexts, so that switching
+ * back and forth between a few resolutions does not recompute the filters or
+ * reinitialize the contexts each time.
+ *
+ * Both caches keep the most recently used entries first and evict the least
+ * recently used ones when they hold too many entries or too many bytes.
+ * sws_flush_caches() empties them.
+ */
+
+#include <string.h>
+
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/thread.h"
+
+#include "swscale.h"
+#include "swscale_internal.h"
+
+#define FILTER_CACHE_SIZE   32
+#define FILTER_CACHE_BYTES  (4 << 20)
+#define CONTEXT_CACHE_SIZE  16
+#define CONTEXT_CACHE_BYTES (32 << 20)
+
+typedef struct FilterCacheEntry {
+    SwsFilterKey key;
+    int16_t *filter;
+    int32_t *filter_pos;
+    int filter_size;
+    size_t bytes;
+} FilterCacheEntry;
+
+typedef struct ContextCacheEntry {
+    SwsContext *c;
+    size_t bytes;
+} ContextCacheEntry;
+
+static FilterCacheEntry filter_cache[FILTER_CACHE_SIZE];
+static int nb_filters;
+static size_t filter_cache_bytes;
+
+static ContextCacheEntry context_cache[CONTEXT_CACHE_SIZE];
+static int nb_contexts;
+static size_t context_cache_bytes;
+
+static AVMutex cache_lock;
+static AVOnce cache_once = AV_ONCE_INIT;
+
+static void cache_init(void)
+{
+    ff_mutex_init(&cache_lock, NULL);
+}
+
+static int filter_key_equal(const SwsFilterKey *a, const SwsFilterKey *b)
+{
+    return a->xInc        == b->xInc        &&
+           a->srcW        == b->srcW        &&
+           a->dstW        == b->dstW        &&
+           a->filterAlign == b->filterAlign &&
+           a->one         == b->one         &&
+           a->flags       == b->flags       &&
+           a->cpu_flags   == b->cpu_flags   &&
+           a->param[0]    == b->param[0]    &&
+           a->param[1]    == b->param[1]    &&
+           a->srcPos      == b->srcPos      &&
+           a->dstPos      == b->dstPos;
+}
+
+/* the filters are allocated with 3 entries of padding, see initFilter() */
+static size_t filter_bytes(int filter_size, int dstW)
+{
+    return (size_t)(dstW + 3) * (filter_size * sizeof(int16_t) + sizeof(int32_t));
+}
+
+static int copy_filter(int16_t **dst_filter, int32_t **dst_pos,
+                       const int16_t *filter, const int32_t *filter_pos,
+                       int filter_size, int dstW)
+{
+    *dst_filter = av_malloc_array(dstW + 3, filter_size * sizeof(*filter));
+    *dst_pos    = av_malloc_array(dstW + 3, sizeof(*filter_pos));
+    if (!*dst_filter || !*dst_pos) {
+        av_freep(dst_filter);
+        av_freep(dst_pos);
+        return AVERROR(ENOMEM);
+    }
+    memcpy(*dst_filter, filter, (dstW + 3) * filter_size * sizeof(*filter));
+    memcpy(*dst_pos, filter_pos, (dstW + 3) * sizeof(*filter_pos));
+    return 0;
+}
+
+int ff_sws_filter_cache_get(const SwsFilterKey *key, int16_t **filter,
+                            int32_t **filter_pos, int *filter_size)
+{
+    int i, ret = AVERROR(ENOENT);
+
+    ff_thread_once(&cache_once, cache_init);
+    ff_mutex_lock(&cache_lock);
+    for (i = 0; i < nb_filters; i++) {
+        FilterCacheEntry e = filter_cache[i];
+
+        if (!filter_key_equal(&e.key, key))
+            continue;
+        ret = copy_filter(filter, filter_pos, e.filter, e.filter_pos,
+                          e.filter_size, key->dstW);
+        if (ret >= 0)
+            *filter_size = e.filter_size;
+        memmove(&filter_cache[1], &filter_cache[0], i * sizeof(*filter_cache));
+        filter_cache[0] = e;
+        break;
+    }
+    ff_mutex_unlock(&cache_lock);
+
+    return ret;
+}
+
+void ff_sws_filter_cache_put(const SwsFilterKey *key, const int16_t *filter,
+                             const int32_t *filter_pos, int filter_size)
+{
+    FilterCacheEntry e = { *key, NULL, NULL, filter_size,
+                           filter_bytes(filter_size, key->dstW) };
+    FilterCacheEntry evicted[FILTER_CACHE_SIZE];
+    int i, nb_evicted = 0;
+
+    if (e.bytes > FILTER_CACHE_BYTES ||
+        copy_filter(&e.filter, &e.filter_pos, filter, filter_pos,
+                    filter_size, key->dstW) < 0)
+        return;
+
+    ff_thread_once(&cache_once, cache_init);
+    ff_mutex_lock(&cache_lock);
+    while (nb_filters == FILTER_CACHE_SIZE ||
+           (nb_filters && filter_cache_bytes + e.bytes > FILTER_CACHE_BYTES)) {
+        evicted[nb_evicted] = filter_cache[--nb_filters];
+        filter_cache_bytes -= evicted[nb_evicted++].bytes;
+    }
+    memmove(&filter_cache[1], &filter_cache[0], nb_filters * sizeof(*filter_cache));
+    filter_cache[0] = e;
+    nb_filters++;
+    filter_cache_bytes += e.bytes;
+    ff_mutex_unlock(&cache_lock);
+
+    for (i = 0; i < nb_evicted; i++) {
+        av_free(evicted[i].filter);
+        av_free(evicted[i].filter_pos);
+    }
+}
+
+static int context_key_equal(const SwsContextKey *a, const SwsContextKey *b)
+{
+    return a->srcW      == b->srcW      &&
+           a->srcH      == b->srcH      &&
+           a->srcFormat == b->srcFormat &&
+           a->dstW      == b->dstW      &&
+           a->dstH      == b->dstH      &&
+           a->dstFormat == b->dstFormat &&
+           a->flags     == b->flags     &&
+           a->param[0]  == b->param[0]  &&
+           a->param[1]  == b->param[1]  &&
+           !memcmp(a->chr_pos, b->chr_pos, sizeof(a->chr_pos)) &&
+           a->threads   == b->threads;
+}
+
+/* whether the options and colorspace details are still those set up at init */
+static int context_is_pristine(SwsContext *c)
+{
+    const int *table = ff_yuv2rgb_coeffs[SWS_CS_DEFAULT];
+    char *opts = NULL;
+    int pristine;
+
+    if (!c->cache_opts || av_opt_serialize(c, 0, 0, &opts, '=', ':') < 0)
+        return 0;
+    pristine = !strcmp(opts, c->cache_opts)        &&
+               c->brightness == 0                  &&
+               c->contrast   == 1 << 16            &&
+               c->saturation == 1 << 16            &&
+               !memcmp(c->srcColorspaceTable, table, sizeof(c->srcColorspaceTable)) &&
+               !memcmp(c->dstColorspaceTable, table, sizeof(c->dstColorspaceTable));
+    av_free(opts);
+    return pristine;
+}
+
+/* an estimate of the memory used by a context: its filters and the lines of
+ * its slices, including those of its cascaded and slice contexts */
+static size_t context_bytes(const SwsContext *c)
+{
+    size_t bytes;
+    int i;
+
+    if (!c)
+        return 0;
+    bytes = filter_bytes(c->hLumFilterSize, c->dstW) +
+            filter_bytes(c->hChrFilterSize, c->chrDstW) +
+            filter_bytes(c->vLumFilterSize, c->dstH) +
+            filter_bytes(c->vChrFilterSize, c->chrDstH) +
+            (size_t)(c->vLumFilterSize + c->vChrFilterSize) * 4 *
+            (FFMAX(c->srcW, c->dstW) + 64) * sizeof(int32_t);
+    for (i = 0; i < FF_ARRAY_ELEMS(c->cascaded_context); i++)
+        bytes += context_bytes(c->cascaded_context[i]);
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        bytes += context_bytes(c->slice_ctx[i]);
+    return bytes;
+}
+
+SwsContext *ff_sws_context_cache_get(const SwsContextKey *key)
+{
+    SwsContext *c = NULL;
+    int i;
+
+    ff_thread_once(&cache_once, cache_init);
+    ff_mutex_lock(&cache_lock);
+    for (i = 0; i < nb_contexts; i++) {
+        if (context_key_equal(&context_cache[i].c->cache_key, key)) {
+            c = context_cache[i].c;
+            context_cache_bytes -= context_cache[i].bytes;
+            memmove(&context_cache[i], &context_cache[i + 1],
+                    (nb_contexts - i - 1) * sizeof(*context_cache));
+            nb_contexts--;
+            break;
+        }
+    }
+    ff_mutex_unlock(&cache_lock);
+
+    if (c) {
+        av_log(c, AV_LOG_DEBUG, "Reusing a cached context\n");
+        /* a context may have been released in the middle of a frame */
+        c->sliceDir = 0;
+    }
+    return c;
+}
+
+void ff_sws_context_cache_put(SwsContext *c)
+{
+    ContextCacheEntry e = { c, 0 };
+    SwsContext *evicted[CONTEXT_CACHE_SIZE];
+    int i, nb_evicted = 0;
+
+    if (!c->cacheable || !context_is_pristine(c) ||
+        (e.bytes = context_bytes(c)) > CONTEXT_CACHE_BYTES) {
+        sws_freeContext(c);
+        return;
+    }
+
+    ff_thread_once(&cache_once, cache_init);
+    ff_mutex_lock(&cache_lock);
+    while (nb_contexts == CONTEXT_CACHE_SIZE ||
+           (nb_contexts && context_cache_bytes + e.bytes > CONTEXT_CACHE_BYTES)) {
+        nb_contexts--;
+        evicted[nb_evicted++] = context_cache[nb_contexts].c;
+        context_cache_bytes -= context_cache[nb_contexts].bytes;
+    }
+    memmove(&context_cache[1], &context_cache[0], nb_contexts * sizeof(*context_cache));
+    context_cache[0] = e;
+    nb_contexts++;
+    context_cache_bytes += e.bytes;
+    ff_mutex_unlock(&cache_lock);
+
+    for (i = 0; i < nb_evicted; i++)
+        sws_freeContext(evicted[i]);
+}
+
+void sws_flush_caches(void)
+{
+    FilterCacheEntry filters[FILTER_CACHE_SIZE];
+    ContextCacheEntry contexts[CONTEXT_CACHE_SIZE];
+    int i, nb_f, nb_c;
+
+    ff_thread_once(&cache_once, cache_init);
+    ff_mutex_lock(&cache_lock);
+    nb_f = nb_filters;
+    nb_c = nb_contexts;
+    memcpy(filters,  filter_cache,  nb_f * sizeof(*filters));
+    memcpy(contexts, context_cache, nb_c * sizeof(*contexts));
+    nb_filters  = nb_contexts = 0;
+    filter_cache_bytes = context_cache_bytes = 0;
+    ff_mutex_unlock(&cache_lock);
+
+    for (i = 0; i < nb_f; i++) {
+        av_free(filters[i].filter);
+        av_free(filters[i].filter_pos);
+    }
+    for (i = 0; i < nb_c; i++)
+        sws_freeContext(contexts[i].c);
+}
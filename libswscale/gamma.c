@@ -18,55 +18,110 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <math.h>
+
+#include "libavutil/thread.h"
+
 #include "swscale_internal.h"
 
-typedef struct GammaContext
-{
-    uint16_t *table;
-} GammaContext;
+#define GAMMA 2.2
 
-// gamma_convert expects 16 bit rgb format
-// it writes directly in src slice thus it must be modifiable (done through cascade context)
-static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
-{
-    GammaContext *instance = desc->instance;
-    uint16_t *table = instance->table;
-    int srcW = desc->src->width;
+/* 8 and 16-bit gamma encoded RGB components to 16-bit linear ones, and back */
+static struct {
+    uint16_t lin8[256];
+    uint16_t lin16[65536];
+    uint16_t enc16[65536];
+    uint8_t  enc8[65536];
+} tables;
+
+static AVOnce tables_once = AV_ONCE_INIT;
 
+static void init_tables(void)
+{
     int i;
-    for (i = 0; i < sliceH; ++i) {
-        uint8_t ** src = desc->src->plane[0].line;
-        int src_pos = sliceY+i - desc->src->plane[0].sliceY;
-
-        uint16_t *src1 = (uint16_t*)*(src+src_pos);
-        int j;
-        for (j = 0; j < srcW; ++j) {
-            uint16_t r = AV_RL16(src1 + j*4 + 0);
-            uint16_t g = AV_RL16(src1 + j*4 + 1);
-            uint16_t b = AV_RL16(src1 + j*4 + 2);
-
-            AV_WL16(src1 + j*4 + 0, table[r]);
-            AV_WL16(src1 + j*4 + 1, table[g]);
-            AV_WL16(src1 + j*4 + 2, table[b]);
-        }
 
+    for (i = 0; i < 256; i++)
+        tables.lin8[i] = lrint(pow(i / 255.0, GAMMA) * 65535.0);
+    for (i = 0; i < 65536; i++) {
+        tables.lin16[i] = lrint(pow(i / 65535.0, GAMMA) * 65535.0);
+        tables.enc16[i] = lrint(pow(i / 65535.0, 1.0 / GAMMA) * 65535.0);
+        tables.enc8[i]  = lrint(pow(i / 65535.0, 1.0 / GAMMA) * 255.0);
     }
-    return sliceH;
 }
 
+void ff_sws_init_gamma_tables(void)
+{
+    ff_thread_once(&tables_once, init_tables);
+}
 
-int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *table)
+void ff_sws_gamma_linearize(uint16_t *const dst[4], const int dstStride[4],
+                            const uint8_t *src, int srcStride,
+                            int width, int height, int depth8)
 {
-    GammaContext *li = av_malloc(sizeof(GammaContext));
-    if (!li)
-        return AVERROR(ENOMEM);
-    li->table = table;
+    int x, y;
+
+    for (y = 0; y < height; y++) {
+        uint16_t *r = (uint16_t *)((uint8_t *)dst[0] + y * dstStride[0]);
+        uint16_t *g = (uint16_t *)((uint8_t *)dst[1] + y * dstStride[1]);
+        uint16_t *b = (uint16_t *)((uint8_t *)dst[2] + y * dstStride[2]);
+        uint16_t *a = dst[3] ? (uint16_t *)((uint8_t *)dst[3] + y * dstStride[3]) : NULL;
+
+        if (depth8) {
+            const uint8_t *src8 = src + y * srcStride;
 
-    desc->instance = li;
-    desc->src = src;
-    desc->dst = NULL;
-    desc->process = &gamma_convert;
+            for (x = 0; x < width; x++) {
+                r[x] = tables.lin8[src8[4 * x + 0]];
+                g[x] = tables.lin8[src8[4 * x + 1]];
+                b[x] = tables.lin8[src8[4 * x + 2]];
+            }
+            if (a)
+                for (x = 0; x < width; x++)
+                    a[x] = src8[4 * x + 3] * 257;
+        } else {
+            const uint16_t *src16 = (const uint16_t *)(src + y * srcStride);
 
-    return 0;
+            for (x = 0; x < width; x++) {
+                r[x] = tables.lin16[src16[4 * x + 0]];
+                g[x] = tables.lin16[src16[4 * x + 1]];
+                b[x] = tables.lin16[src16[4 * x + 2]];
+            }
+            if (a)
+                for (x = 0; x < width; x++)
+                    a[x] = src16[4 * x + 3];
+        }
+    }
 }
 
+void ff_sws_gamma_encode(uint8_t *dst, int dstStride,
+                         const uint16_t *const src[4], const int srcStride[4],
+                         int width, int height, int depth8)
+{
+    int x, y;
+
+    for (y = 0; y < height; y++) {
+        const uint16_t *r = (const uint16_t *)((const uint8_t *)src[0] + y * srcStride[0]);
+        const uint16_t *g = (const uint16_t *)((const uint8_t *)src[1] + y * srcStride[1]);
+        const uint16_t *b = (const uint16_t *)((const uint8_t *)src[2] + y * srcStride[2]);
+        const uint16_t *a = src[3] ? (const uint16_t *)((const uint8_t *)src[3] + y * srcStride[3]) : NULL;
+
+        if (depth8) {
+            uint8_t *dst8 = dst + y * dstStride;
+
+            for (x = 0; x < width; x++) {
+                dst8[4 * x + 0] = tables.enc8[r[x]];
+                dst8[4 * x + 1] = tables.enc8[g[x]];
+                dst8[4 * x + 2] = tables.enc8[b[x]];
+                dst8[4 * x + 3] = a ? a[x] >> 8 : 0xFF;
+            }
+        } else {
+            uint16_t *dst16 = (uint16_t *)(dst + y * dstStride);
+
+            for (x = 0; x < width; x++) {
+                dst16[4 * x + 0] = tables.enc16[r[x]];
+                dst16[4 * x + 1] = tables.enc16[g[x]];
+                dst16[4 * x + 2] = tables.enc16[b[x]];
+                dst16[4 * x + 3] = a ? a[x] : 0xFFFF;
+            }
+        }
+    }
+}
@@ -575,6 +575,31 @@ static void bswap16UV_c(uint8_t *_dstU, uint8_t *_dstV, const uint8_t *unused0,
     }
 }
 
+/* float components are clipped to [0,1] and read as 16 bits */
+static av_always_inline int read_float16(const uint8_t *src, int is_be)
+{
+    float v = av_int2float(is_be ? AV_RB32(src) : AV_RL32(src));
+    return lrintf(av_clipf(65535.0f * v, 0.0f, 65535.0f));
+}
+
+static void grayf32leToY16_c(uint8_t *_dst, const uint8_t *src, const uint8_t *unused1,
+                             const uint8_t *unused2, int width, uint32_t *unused)
+{
+    int i;
+    uint16_t *dst = (uint16_t *)_dst;
+    for (i = 0; i < width; i++)
+        dst[i] = read_float16(src + 4 * i, 0);
+}
+
+static void grayf32beToY16_c(uint8_t *_dst, const uint8_t *src, const uint8_t *unused1,
+                             const uint8_t *unused2, int width, uint32_t *unused)
+{
+    int i;
+    uint16_t *dst = (uint16_t *)_dst;
+    for (i = 0; i < width; i++)
+        dst[i] = read_float16(src + 4 * i, 1);
+}
+
 static void read_ya16le_gray_c(uint8_t *dst, const uint8_t *src, const uint8_t *unused1, const uint8_t *unused2, int width,
                                uint32_t *unused)
 {
@@ -980,6 +1005,74 @@ rgb9plus_planar_transparency_funcs(10)
 rgb9plus_planar_transparency_funcs(12)
 rgb9plus_planar_transparency_funcs(16)
 
+#define rdpx(src) read_float16(src, is_be)
+static av_always_inline void planar_rgbf32_to_y(uint8_t *_dst, const uint8_t *src[4],
+                                                int width, int is_be, int32_t *rgb2yuv)
+{
+    int i;
+    uint16_t *dst = (uint16_t *)_dst;
+    int32_t ry = rgb2yuv[RY_IDX], gy = rgb2yuv[GY_IDX], by = rgb2yuv[BY_IDX];
+
+    for (i = 0; i < width; i++) {
+        int g = rdpx(src[0] + 4 * i);
+        int b = rdpx(src[1] + 4 * i);
+        int r = rdpx(src[2] + 4 * i);
+
+        dst[i] = (ry*r + gy*g + by*b + (33 << (RGB2YUV_SHIFT + 7))) >> RGB2YUV_SHIFT;
+    }
+}
+
+static av_always_inline void planar_rgbf32_to_a(uint8_t *_dst, const uint8_t *src[4],
+                                                int width, int is_be, int32_t *rgb2yuv)
+{
+    int i;
+    uint16_t *dst = (uint16_t *)_dst;
+
+    for (i = 0; i < width; i++)
+        dst[i] = rdpx(src[3] + 4 * i);
+}
+
+static av_always_inline void planar_rgbf32_to_uv(uint8_t *_dstU, uint8_t *_dstV,
+                                                 const uint8_t *src[4], int width,
+                                                 int is_be, int32_t *rgb2yuv)
+{
+    int i;
+    uint16_t *dstU = (uint16_t *)_dstU;
+    uint16_t *dstV = (uint16_t *)_dstV;
+    int32_t ru = rgb2yuv[RU_IDX], gu = rgb2yuv[GU_IDX], bu = rgb2yuv[BU_IDX];
+    int32_t rv = rgb2yuv[RV_IDX], gv = rgb2yuv[GV_IDX], bv = rgb2yuv[BV_IDX];
+
+    for (i = 0; i < width; i++) {
+        int g = rdpx(src[0] + 4 * i);
+        int b = rdpx(src[1] + 4 * i);
+        int r = rdpx(src[2] + 4 * i);
+
+        dstU[i] = (ru*r + gu*g + bu*b + (257 << (RGB2YUV_SHIFT + 7))) >> RGB2YUV_SHIFT;
+        dstV[i] = (rv*r + gv*g + bv*b + (257 << (RGB2YUV_SHIFT + 7))) >> RGB2YUV_SHIFT;
+    }
+}
+#undef rdpx
+
+#define rgbf32_planar_funcs_endian(endian_name, endian)                                     \
+static void planar_rgbf32##endian_name##_to_y(uint8_t *dst, const uint8_t *src[4],          \
+                                              int w, int32_t *rgb2yuv)                      \
+{                                                                                           \
+    planar_rgbf32_to_y(dst, src, w, endian, rgb2yuv);                                       \
+}                                                                                           \
+static void planar_rgbf32##endian_name##_to_uv(uint8_t *dstU, uint8_t *dstV,                \
+                                               const uint8_t *src[4], int w, int32_t *rgb2yuv) \
+{                                                                                           \
+    planar_rgbf32_to_uv(dstU, dstV, src, w, endian, rgb2yuv);                               \
+}                                                                                           \
+static void planar_rgbf32##endian_name##_to_a(uint8_t *dst, const uint8_t *src[4],          \
+                                              int w, int32_t *rgb2yuv)                      \
+{                                                                                           \
+    planar_rgbf32_to_a(dst, src, w, endian, rgb2yuv);                                       \
+}
+
+rgbf32_planar_funcs_endian(le, 0)
+rgbf32_planar_funcs_endian(be, 1)
+
 av_cold void ff_sws_init_input_funcs(SwsContext *c)
 {
     enum AVPixelFormat srcFormat = c->srcFormat;
@@ -1048,6 +1141,14 @@ av_cold void ff_sws_init_input_funcs(SwsContext *c)
     case AV_PIX_FMT_GBRP:
         c->readChrPlanar = planar_rgb_to_uv;
         break;
+    case AV_PIX_FMT_GBRAPF32LE:
+    case AV_PIX_FMT_GBRPF32LE:
+        c->readChrPlanar = planar_rgbf32le_to_uv;
+        break;
+    case AV_PIX_FMT_GBRAPF32BE:
+    case AV_PIX_FMT_GBRPF32BE:
+        c->readChrPlanar = planar_rgbf32be_to_uv;
+        break;
 #if HAVE_BIGENDIAN
     case AV_PIX_FMT_YUV420P9LE:
     case AV_PIX_FMT_YUV422P9LE:
@@ -1343,6 +1444,16 @@ av_cold void ff_sws_init_input_funcs(SwsContext *c)
     case AV_PIX_FMT_GBRP:
         c->readLumPlanar = planar_rgb_to_y;
         break;
+    case AV_PIX_FMT_GBRAPF32LE:
+        c->readAlpPlanar = planar_rgbf32le_to_a;
+    case AV_PIX_FMT_GBRPF32LE:
+        c->readLumPlanar = planar_rgbf32le_to_y;
+        break;
+    case AV_PIX_FMT_GBRAPF32BE:
+        c->readAlpPlanar = planar_rgbf32be_to_a;
+    case AV_PIX_FMT_GBRPF32BE:
+        c->readLumPlanar = planar_rgbf32be_to_y;
+        break;
 #if HAVE_BIGENDIAN
     case AV_PIX_FMT_YUV420P9LE:
     case AV_PIX_FMT_YUV422P9LE:
@@ -1420,6 +1531,12 @@ av_cold void ff_sws_init_input_funcs(SwsContext *c)
         c->alpToYV12 = bswap16Y_c;
         break;
 #endif
+    case AV_PIX_FMT_GRAYF32LE:
+        c->lumToYV12 = grayf32leToY16_c;
+        break;
+    case AV_PIX_FMT_GRAYF32BE:
+        c->lumToYV12 = grayf32beToY16_c;
+        break;
     case AV_PIX_FMT_YA16LE:
         c->lumToYV12 = read_ya16le_gray_c;
         break;
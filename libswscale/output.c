@@ -182,6 +182,68 @@ yuv2planeX_16_c_template(const int16_t *filter, int filterSize,
 
 #undef output_pixel
 
+#define output_pixel(pos, val) \
+    if (big_endian) { \
+        AV_WB32(pos, av_float2int(av_clip_uint16(val) * (1.0f / 65535))); \
+    } else { \
+        AV_WL32(pos, av_float2int(av_clip_uint16(val) * (1.0f / 65535))); \
+    }
+
+/* float output goes through the 16-bit intermediate of the 16-bit formats */
+static av_always_inline void
+yuv2plane1_float_c_template(const int32_t *src, uint8_t *dest, int dstW,
+                            int big_endian)
+{
+    int i;
+    int shift = 3;
+
+    for (i = 0; i < dstW; i++) {
+        int val = (src[i] + (1 << (shift - 1))) >> shift;
+        output_pixel(dest + 4 * i, val);
+    }
+}
+
+static av_always_inline void
+yuv2planeX_float_c_template(const int16_t *filter, int filterSize,
+                            const int32_t **src, uint8_t *dest, int dstW,
+                            int big_endian)
+{
+    int i;
+    int shift = 15;
+
+    for (i = 0; i < dstW; i++) {
+        int val = 1 << (shift - 1);
+        int j;
+
+        /* see yuv2planeX_16_c_template() */
+        val -= 0x40000000;
+        for (j = 0; j < filterSize; j++)
+            val += src[j][i] * (unsigned)filter[j];
+        val = (val >> shift) + 0x8000;
+
+        output_pixel(dest + 4 * i, val);
+    }
+}
+
+#undef output_pixel
+
+#define yuv2float(BE_LE, is_be) \
+static void yuv2plane1_float ## BE_LE ## _c(const int16_t *src, uint8_t *dest, int dstW, \
+                                           const uint8_t *dither, int offset) \
+{ \
+    yuv2plane1_float_c_template((const int32_t *)src, dest, dstW, is_be); \
+} \
+static void yuv2planeX_float ## BE_LE ## _c(const int16_t *filter, int filterSize, \
+                                           const int16_t **src, uint8_t *dest, int dstW, \
+                                           const uint8_t *dither, int offset) \
+{ \
+    yuv2planeX_float_c_template(filter, filterSize, (const int32_t **)src, \
+                                dest, dstW, is_be); \
+}
+
+yuv2float(LE, 0)
+yuv2float(BE, 1)
+
 #define output_pixel(pos, val) \
     if (big_endian) { \
         AV_WB16(pos, av_clip_uintp2(val >> shift, output_bits)); \
@@ -2096,6 +2158,82 @@ yuv2gbrp16_full_X_c(SwsContext *c, const int16_t *lumFilter,
     }
 }
 
+static void
+yuv2gbrpf32_full_X_c(SwsContext *c, const int16_t *lumFilter,
+                     const int16_t **lumSrcx, int lumFilterSize,
+                     const int16_t *chrFilter, const int16_t **chrUSrcx,
+                     const int16_t **chrVSrcx, int chrFilterSize,
+                     const int16_t **alpSrc, uint8_t **dest,
+                     int dstW, int y)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->dstFormat);
+    int i;
+    int hasAlpha = (desc->flags & AV_PIX_FMT_FLAG_ALPHA) && alpSrc;
+    int big_endian = isBE(c->dstFormat);
+    const int32_t **lumSrc  = (const int32_t**)lumSrcx;
+    const int32_t **chrUSrc = (const int32_t**)chrUSrcx;
+    const int32_t **chrVSrc = (const int32_t**)chrVSrcx;
+    const float scale = 1.0f / (1 << 30);
+    int A = 0; // init to silence warning
+
+#define output_pixel(pos, val) \
+    if (big_endian) { \
+        AV_WB32(pos, av_float2int(val)); \
+    } else { \
+        AV_WL32(pos, av_float2int(val)); \
+    }
+
+    for (i = 0; i < dstW; i++) {
+        int j;
+        int Y = -0x40000000;
+        int U = -(128 << 23);
+        int V = -(128 << 23);
+        int R, G, B;
+
+        for (j = 0; j < lumFilterSize; j++)
+            Y += lumSrc[j][i] * (unsigned)lumFilter[j];
+
+        for (j = 0; j < chrFilterSize; j++) {
+            U += chrUSrc[j][i] * (unsigned)chrFilter[j];
+            V += chrVSrc[j][i] * (unsigned)chrFilter[j];
+        }
+
+        Y >>= 14;
+        Y += 0x10000;
+        U >>= 14;
+        V >>= 14;
+
+        if (hasAlpha) {
+            A = 1 << 18;
+
+            for (j = 0; j < lumFilterSize; j++)
+                A += alpSrc[j][i] * lumFilter[j];
+
+            if (A & 0xF8000000)
+                A =  av_clip_uintp2(A, 27);
+        }
+
+        Y -= c->yuv2rgb_y_offset;
+        Y *= c->yuv2rgb_y_coeff;
+        Y += 1 << 13;
+        R = V * c->yuv2rgb_v2r_coeff;
+        G = V * c->yuv2rgb_v2g_coeff + U * c->yuv2rgb_u2g_coeff;
+        B =                            U * c->yuv2rgb_u2b_coeff;
+
+        /* the 30-bit components are kept at full precision */
+        R = av_clip_uintp2(Y + R, 30);
+        G = av_clip_uintp2(Y + G, 30);
+        B = av_clip_uintp2(Y + B, 30);
+
+        output_pixel(dest[0] + 4 * i, G * scale);
+        output_pixel(dest[1] + 4 * i, B * scale);
+        output_pixel(dest[2] + 4 * i, R * scale);
+        if (hasAlpha)
+            output_pixel(dest[3] + 4 * i, A * (1.0f / (1 << 27)));
+    }
+#undef output_pixel
+}
+
 static void
 yuv2ya8_1_c(SwsContext *c, const int16_t *buf0,
             const int16_t *ubuf[2], const int16_t *vbuf[2],
@@ -2254,6 +2392,9 @@ av_cold void ff_sws_init_output_funcs(SwsContext *c,
         *yuv2plane1 = isBE(dstFormat) ? yuv2p010l1_BE_c : yuv2p010l1_LE_c;
         *yuv2planeX = isBE(dstFormat) ? yuv2p010lX_BE_c : yuv2p010lX_LE_c;
         *yuv2nv12cX = yuv2p010cX_c;
+    } else if (isFloat(dstFormat)) {
+        *yuv2planeX = isBE(dstFormat) ? yuv2planeX_floatBE_c : yuv2planeX_floatLE_c;
+        *yuv2plane1 = isBE(dstFormat) ? yuv2plane1_floatBE_c : yuv2plane1_floatLE_c;
     } else if (is16BPS(dstFormat)) {
         *yuv2planeX = isBE(dstFormat) ? yuv2planeX_16BE_c  : yuv2planeX_16LE_c;
         *yuv2plane1 = isBE(dstFormat) ? yuv2plane1_16BE_c  : yuv2plane1_16LE_c;
@@ -2490,6 +2631,12 @@ av_cold void ff_sws_init_output_funcs(SwsContext *c,
         case AV_PIX_FMT_GBRAP16LE:
             *yuv2anyX = yuv2gbrp16_full_X_c;
             break;
+        case AV_PIX_FMT_GBRPF32BE:
+        case AV_PIX_FMT_GBRPF32LE:
+        case AV_PIX_FMT_GBRAPF32BE:
+        case AV_PIX_FMT_GBRAPF32LE:
+            *yuv2anyX = yuv2gbrpf32_full_X_c;
+            break;
         }
         if (!*yuv2packedX && !*yuv2anyX)
             goto YUV_PACKED;
@@ -0,0 +1,302 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Float scaler for planar float and high bit depth formats, enabled with the
+ * float_scale option: each plane is converted to float in [0,1], scaled
+ * horizontally into a ring buffer of lines, scaled vertically and converted
+ * to the destination format, without the 15 or 19-bit intermediate of the
+ * generic scaler. Both formats must have the same planes and subsampling.
+ */
+
+#include <string.h>
+
+#include "libavutil/intfloat.h"
+#include "libavutil/mem.h"
+
+#include "swscale.h"
+#include "swscale_internal.h"
+
+static void hscale_float_c(float *dst, int dstW, const float *src,
+                           const float *filter, const int32_t *filterPos,
+                           int filterSize)
+{
+    int i, j, k;
+
+    for (i = 0; i < dstW; i += 8) {
+        float sum[8];
+
+        for (k = 0; k < 8; k++)
+            sum[k] = src[filterPos[i + k]] * filter[k];
+        for (j = 1; j < filterSize; j++)
+            for (k = 0; k < 8; k++)
+                sum[k] += src[filterPos[i + k] + j] * filter[8 * j + k];
+        for (k = 0; k < 8; k++)
+            dst[i + k] = sum[k];
+        filter += 8 * filterSize;
+    }
+}
+
+static void vscale_float_c(float *dst, int dstW, const float *const *src,
+                           const float *filter, int filterSize)
+{
+    int i, j;
+
+    for (i = 0; i < dstW; i++) {
+        float sum = src[0][i] * filter[0];
+
+        for (j = 1; j < filterSize; j++)
+            sum += src[j][i] * filter[j];
+        dst[i] = sum;
+    }
+}
+
+#define FLOAT_FUNCS(name, rb, wb)                                           \
+static void read_ ## name(float *dst, const uint8_t *src, int width,       \
+                          float mul)                                        \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < width; i++)                                             \
+        dst[i] = av_int2float(rb(src + 4 * i));                             \
+}                                                                           \
+                                                                            \
+static void write_ ## name(uint8_t *dst, const float *src, int width,      \
+                           float mul, int max)                              \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < width; i++)                                             \
+        wb(dst + 4 * i, av_float2int(src[i]));                              \
+}
+
+/* values out of [0,1] are kept, they are meaningful for float formats */
+FLOAT_FUNCS(f32le, AV_RL32, AV_WL32)
+FLOAT_FUNCS(f32be, AV_RB32, AV_WB32)
+
+#define INT16_FUNCS(name, rb, wb)                                           \
+static void read_ ## name(float *dst, const uint8_t *src, int width,       \
+                          float mul)                                        \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < width; i++)                                             \
+        dst[i] = rb(src + 2 * i) * mul;                                     \
+}                                                                           \
+                                                                            \
+static void write_ ## name(uint8_t *dst, const float *src, int width,      \
+                           float mul, int max)                              \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < width; i++)                                             \
+        wb(dst + 2 * i, (int)av_clipf(src[i] * mul + 0.5f, 0, max));        \
+}
+
+INT16_FUNCS(int16le, AV_RL16, AV_WL16)
+INT16_FUNCS(int16be, AV_RB16, AV_WB16)
+
+int ff_sws_float_filter_init(float **dst_filter, int32_t **dst_pos, int *dst_size,
+                             const int16_t *filter, const int32_t *filter_pos,
+                             int filter_size, int dst_w, int one, int blocked)
+{
+    int n    = blocked ? FFALIGN(dst_w, 8) : dst_w;
+    int size = filter_size;
+    int i, j;
+
+    /* the filters of small sources are padded with taps past the source */
+    while (size > 1) {
+        for (i = 0; i < dst_w; i++)
+            if (filter[i * filter_size + size - 1])
+                break;
+        if (i < dst_w)
+            break;
+        size--;
+    }
+
+    *dst_filter = av_mallocz_array(n, size * sizeof(**dst_filter));
+    *dst_pos    = av_malloc_array(n, sizeof(**dst_pos));
+    if (!*dst_filter || !*dst_pos) {
+        av_freep(dst_filter);
+        av_freep(dst_pos);
+        return AVERROR(ENOMEM);
+    }
+
+    for (i = 0; i < n; i++) {
+        float *f = blocked ? *dst_filter + (i & ~7) * size + (i & 7)
+                           : *dst_filter + i * size;
+        int stride = blocked ? 8 : 1;
+
+        /* the padding pixels repeat the last one with a zero filter */
+        (*dst_pos)[i] = filter_pos[FFMIN(i, dst_w - 1)];
+        if (i >= dst_w)
+            continue;
+        for (j = 0; j < size; j++)
+            f[j * stride] = filter[i * filter_size + j] / (float)one;
+    }
+    *dst_size = size;
+
+    return 0;
+}
+
+/* scale and offset of the conversion between limited and full range of a
+ * luma or chroma plane, normalized to [0,1] where unit is the size of an
+ * 8-bit step */
+static void range_convert_params(float unit, int chroma, int to_full,
+                                 float *mul, float *add)
+{
+    float range = chroma ? 224.0f / 255 : 219.0f / 255;
+    float zero  = chroma ? 128 * unit : 16 * unit;
+
+    /* black maps to black and the chroma center to itself */
+    if (chroma) {
+        *mul = to_full ? 1 / range : range;
+        *add = zero * (1 - *mul);
+    } else if (to_full) {
+        *mul = 1 / range;
+        *add = -zero / range;
+    } else {
+        *mul = range;
+        *add = zero;
+    }
+}
+
+static int scale_float(SwsContext *c, const uint8_t *src[], int srcStride[],
+                       int srcSliceY, int srcSliceH, uint8_t *dst[],
+                       int dstStride[])
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->dstFormat);
+    int convert_range = c->srcRange != c->dstRange &&
+                        !(desc->flags & AV_PIX_FMT_FLAG_RGB);
+    int lines = 0;
+    int i, j, y;
+
+    for (i = 0; i < c->float_nb_planes; i++) {
+        SwsFloatPlane *p = &c->float_planes[i];
+        int start = srcSliceY >> p->log2_h;
+        int end   = AV_CEIL_RSHIFT(srcSliceY + srcSliceH, p->log2_h);
+        int chroma = i == 1 || i == 2;
+        int dst_y0;
+        float mul = 1, add = 0;
+
+        if (!start)
+            p->src_y = p->dst_y = 0;
+        if (start != p->src_y) {
+            av_log(c, AV_LOG_ERROR, "Slices are not consecutive\n");
+            return AVERROR(EINVAL);
+        }
+        if (convert_range && i < 3) {
+            float unit = isFloat(c->dstFormat) ? 1.0f / 255 :
+                         (1 << (desc->comp[0].depth - 8)) / c->float_write_mul;
+            range_convert_params(unit, chroma, c->dstRange, &mul, &add);
+        }
+        dst_y0 = p->dst_y;
+
+        for (y = start; y < end; y++) {
+            c->float_read(p->line, src[i] + (y - start) * srcStride[i],
+                          p->src_w, c->float_read_mul);
+            c->hscale_float(p->ring + (y % p->v_filter_size) * p->stride,
+                            p->stride, p->line, p->h_filter,
+                            p->h_filter_pos, p->h_filter_size);
+
+            /* output the lines whose source lines are all scaled */
+            while (p->dst_y < p->dst_h &&
+                   p->v_filter_pos[p->dst_y] + p->v_filter_size <= y + 1) {
+                const float *filter = p->v_filter + p->dst_y * p->v_filter_size;
+                int pos = p->v_filter_pos[p->dst_y];
+
+                for (j = 0; j < p->v_filter_size; j++)
+                    p->ring_lines[j] = p->ring + ((pos + j) % p->v_filter_size) * p->stride;
+                c->vscale_float(p->out, p->stride, p->ring_lines, filter,
+                                p->v_filter_size);
+                if (mul != 1 || add != 0)
+                    for (j = 0; j < p->dst_w; j++)
+                        p->out[j] = p->out[j] * mul + add;
+                c->float_write(dst[i] + p->dst_y * dstStride[i], p->out,
+                               p->dst_w, c->float_write_mul, c->float_write_max);
+                p->dst_y++;
+            }
+        }
+        p->src_y = end;
+        if (!i)
+            lines = p->dst_y - dst_y0;
+    }
+
+    return lines;
+}
+
+av_cold int ff_sws_init_float_scaler(SwsContext *c)
+{
+    int src_depth = av_pix_fmt_desc_get(c->srcFormat)->comp[0].depth;
+    int dst_depth = av_pix_fmt_desc_get(c->dstFormat)->comp[0].depth;
+    int i;
+
+    for (i = 0; i < c->float_nb_planes; i++) {
+        SwsFloatPlane *p = &c->float_planes[i];
+
+        p->stride     = FFALIGN(p->dst_w, 8);
+        p->line       = av_malloc_array(p->src_w + 8, sizeof(*p->line));
+        p->ring       = av_malloc_array(p->v_filter_size, p->stride * sizeof(*p->ring));
+        p->out        = av_malloc_array(p->stride, sizeof(*p->out));
+        p->ring_lines = av_malloc_array(p->v_filter_size, sizeof(*p->ring_lines));
+        if (!p->line || !p->ring || !p->out || !p->ring_lines)
+            return AVERROR(ENOMEM);
+    }
+
+    if (isFloat(c->srcFormat))
+        c->float_read = isBE(c->srcFormat) ? read_f32be    : read_f32le;
+    else
+        c->float_read = isBE(c->srcFormat) ? read_int16be  : read_int16le;
+    if (isFloat(c->dstFormat))
+        c->float_write = isBE(c->dstFormat) ? write_f32be   : write_f32le;
+    else
+        c->float_write = isBE(c->dstFormat) ? write_int16be : write_int16le;
+
+    /* integers are normalized as the generic scaler converts them: with
+     * shifts between integer formats, to their maximum next to float ones */
+    if (isFloat(c->srcFormat) || isFloat(c->dstFormat)) {
+        c->float_read_mul  = isFloat(c->srcFormat) ? 1 : 1.0f / ((1 << src_depth) - 1);
+        c->float_write_mul = isFloat(c->dstFormat) ? 1 : (1 << dst_depth) - 1;
+    } else {
+        c->float_read_mul  = 1.0f / (1 << src_depth);
+        c->float_write_mul = 1 << dst_depth;
+    }
+    c->float_write_max = isFloat(c->dstFormat) ? 0 : (1 << dst_depth) - 1;
+
+    c->hscale_float = hscale_float_c;
+    c->vscale_float = vscale_float_c;
+
+    c->swscale = scale_float;
+    return 0;
+}
+
+av_cold void ff_sws_free_float_scaler(SwsContext *c)
+{
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(c->float_planes); i++) {
+        SwsFloatPlane *p = &c->float_planes[i];
+
+        av_freep(&p->h_filter);
+        av_freep(&p->h_filter_pos);
+        av_freep(&p->v_filter);
+        av_freep(&p->v_filter_pos);
+        av_freep(&p->line);
+        av_freep(&p->ring);
+        av_freep(&p->out);
+        av_freep(&p->ring_lines);
+    }
+    c->float_nb_planes = 0;
+}
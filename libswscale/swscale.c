@@ -76,6 +76,8 @@ static void hScale16To19_c(SwsContext *c, int16_t *_dst, int dstW,
 
     if((isAnyRGB(c->srcFormat) || c->srcFormat==AV_PIX_FMT_PAL8) && desc->comp[0].depth<16)
         sh= 9;
+    else if (isFloat(c->srcFormat)) /* float input is read as 16 bits */
+        sh= 16 - 1 - 4;
 
     for (i = 0; i < dstW; i++) {
         int j;
@@ -101,6 +103,8 @@ static void hScale16To15_c(SwsContext *c, int16_t *dst, int dstW,
 
     if(sh<15)
         sh= isAnyRGB(c->srcFormat) || c->srcFormat==AV_PIX_FMT_PAL8 ? 13 : (desc->comp[0].depth - 1);
+    else if (isFloat(c->srcFormat)) /* float input is read as 16 bits */
+        sh= 16 - 1;
 
     for (i = 0; i < dstW; i++) {
         int j;
@@ -228,9 +232,77 @@ static void lumRangeFromJpeg16_c(int16_t *_dst, int width)
     if (DEBUG_SWSCALE_BUFFERS)                  \
         av_log(c, AV_LOG_DEBUG, __VA_ARGS__)
 
-static int swscale(SwsContext *c, const uint8_t *src[],
-                   int srcStride[], int srcSliceY,
-                   int srcSliceH, uint8_t *dst[], int dstStride[])
+/* room for the pixels SIMD output functions may write past the line end */
+#define BOUNCE_PADDING 128
+
+static int bounce_line_size(const int dstStride[4])
+{
+    int i, size = 0;
+
+    for (i = 0; i < 4; i++)
+        size = FFMAX(size, FFALIGN(FFABS(dstStride[i]) + BOUNCE_PADDING, 64));
+    return size;
+}
+
+/**
+ * The SIMD output functions may write past the end of a line. When the
+ * lines of a frame are output by several slice contexts at once, doing so on
+ * the last line of a slice would overwrite the first line of the next slice,
+ * which may already be done. Redirect the last lines of the slice output at
+ * dstY to the scratch lines of c->slice_bounce instead, to be copied back by
+ * bounce_lines_end().
+ *
+ * @param saved set to the destination lines replaced, NULL for the others
+ */
+static void bounce_lines_start(SwsContext *c, SwsSlice *vout, int dstY,
+                               int dstSliceEnd, const int dstStride[4],
+                               uint8_t *saved[4])
+{
+    const int nb_planes  = av_pix_fmt_count_planes(c->dstFormat);
+    const int chr_shift  = c->chrDstVSubSample;
+    const int chr_output = !(dstY & ((1 << chr_shift) - 1));
+    const int size       = bounce_line_size(dstStride);
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        const int is_chr = i == 1 || i == 2;
+        const int y      = is_chr ? dstY >> chr_shift : dstY;
+        const int last   = is_chr ? (dstSliceEnd - 1) >> chr_shift : dstSliceEnd - 1;
+        SwsPlane *plane  = &vout->plane[i];
+
+        saved[i] = NULL;
+        if (i >= nb_planes || y != last || (is_chr && !chr_output))
+            continue;
+        saved[i] = plane->line[y - plane->sliceY];
+        plane->line[y - plane->sliceY] = c->slice_bounce + i * size;
+    }
+}
+
+static void bounce_lines_end(SwsContext *c, SwsSlice *vout, int dstY,
+                             const int dstStride[4], uint8_t *saved[4])
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        SwsPlane *plane = &vout->plane[i];
+        const int y = i == 1 || i == 2 ? dstY >> c->chrDstVSubSample : dstY;
+
+        if (!saved[i])
+            continue;
+        memcpy(saved[i], plane->line[y - plane->sliceY], FFABS(dstStride[i]));
+        plane->line[y - plane->sliceY] = saved[i];
+    }
+}
+
+/**
+ * Scale a source slice, outputting the destination lines it allows, up to
+ * dstSliceEnd. When srcSliceY is 0, scaling starts at the destination line
+ * dstSliceY rather than carrying on from the previous slice.
+ */
+static int scale_lines(SwsContext *c, const uint8_t *src[],
+                       int srcStride[], int srcSliceY,
+                       int srcSliceH, uint8_t *dst[], int dstStride[],
+                       int dstSliceY, int dstSliceEnd)
 {
     /* load a few things into local vars to make the code more readable?
      * and faster */
@@ -337,7 +409,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     if (srcSliceY == 0) {
         lumBufIndex  = -1;
         chrBufIndex  = -1;
-        dstY         = 0;
+        dstY         = dstSliceY;
         lastInLumBuf = -1;
         lastInChrBuf = -1;
     }
@@ -369,7 +441,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
         hout_slice->width = dstW;
     }
 
-    for (; dstY < dstH; dstY++) {
+    for (; dstY < dstSliceEnd; dstY++) {
         const int chrDstY = dstY >> c->chrDstVSubSample;
         int use_mmx_vfilter= c->use_mmx_vfilter;
 
@@ -497,7 +569,15 @@ static int swscale(SwsContext *c, const uint8_t *src[],
                            yuv2packed1, yuv2packed2, yuv2packedX, yuv2anyX, use_mmx_vfilter);
         }
 
-        {
+        if (dstSliceEnd < dstH &&
+            dstY >= dstSliceEnd - (1 << c->chrDstVSubSample)) {
+            uint8_t *saved[4];
+
+            bounce_lines_start(c, vout_slice, dstY, dstSliceEnd, dstStride, saved);
+            for (i = vStart; i < vEnd; ++i)
+                desc[i].process(c, &desc[i], dstY, 1);
+            bounce_lines_end(c, vout_slice, dstY, dstStride, saved);
+        } else {
             for (i = vStart; i < vEnd; ++i)
                 desc[i].process(c, &desc[i], dstY, 1);
         }
@@ -506,7 +586,10 @@ static int swscale(SwsContext *c, const uint8_t *src[],
         int length = dstW;
         int height = dstY - lastDstY;
 
-        if (is16BPS(dstFormat) || isNBPS(dstFormat)) {
+        if (isFloat(dstFormat)) {
+            fillPlane32(dst[3], dstStride[3], length, height, lastDstY,
+                        isBE(dstFormat));
+        } else if (is16BPS(dstFormat) || isNBPS(dstFormat)) {
             const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dstFormat);
             fillPlane16(dst[3], dstStride[3], length, height, lastDstY,
                     1, desc->comp[3].depth,
@@ -531,6 +614,73 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     return dstY - lastDstY;
 }
 
+static int swscale(SwsContext *c, const uint8_t *src[],
+                   int srcStride[], int srcSliceY,
+                   int srcSliceH, uint8_t *dst[], int dstStride[])
+{
+    return scale_lines(c, src, srcStride, srcSliceY, srcSliceH,
+                       dst, dstStride, 0, c->dstH);
+}
+
+static void slice_worker(void *priv, int jobnr, int threadnr)
+{
+    SwsContext *parent = priv;
+    SwsContext *c = parent->slice_ctx[jobnr];
+    /* the slices start on chroma lines, so that no chroma line is output twice */
+    const int nb_lines  = AV_CEIL_RSHIFT(c->dstH, c->chrDstVSubSample);
+    const int slice_start = (nb_lines *  jobnr      / parent->nb_slice_ctx) << c->chrDstVSubSample;
+    const int slice_end   = jobnr == parent->nb_slice_ctx - 1 ? c->dstH :
+                            (nb_lines * (jobnr + 1) / parent->nb_slice_ctx) << c->chrDstVSubSample;
+    const uint8_t *src[4];
+    uint8_t *dst[4];
+    int srcStride[4], dstStride[4];
+
+    /* swscale() modifies the pointers and strides it is given */
+    memcpy(src,       parent->slice_src,       sizeof(src));
+    memcpy(srcStride, parent->slice_srcStride, sizeof(srcStride));
+    memcpy(dst,       parent->slice_dst,       sizeof(dst));
+    memcpy(dstStride, parent->slice_dstStride, sizeof(dstStride));
+
+    if (usePal(c->srcFormat)) {
+        memcpy(c->pal_yuv, parent->pal_yuv, sizeof(c->pal_yuv));
+        memcpy(c->pal_rgb, parent->pal_rgb, sizeof(c->pal_rgb));
+    }
+
+    scale_lines(c, src, srcStride, 0, c->srcH, dst, dstStride,
+                slice_start, slice_end);
+}
+
+/**
+ * Scale a whole frame with the slice contexts, each outputting a part of
+ * the destination lines.
+ */
+static int swscale_threaded(SwsContext *c, const uint8_t *src[],
+                            int srcStride[], uint8_t *dst[], int dstStride[])
+{
+    ThreadPoolTask task = { .func = slice_worker, .priv = c, .nb_jobs = c->nb_slice_ctx };
+    int i;
+
+    /* all slices but the last one output their last lines through these */
+    for (i = 0; i < c->nb_slice_ctx - 1; i++) {
+        SwsContext *slice = c->slice_ctx[i];
+
+        av_fast_malloc(&slice->slice_bounce, &slice->slice_bounce_size,
+                       4 * bounce_line_size(dstStride));
+        if (!slice->slice_bounce)
+            return AVERROR(ENOMEM);
+    }
+
+    memcpy(c->slice_src,       src,       sizeof(c->slice_src));
+    memcpy(c->slice_srcStride, srcStride, sizeof(c->slice_srcStride));
+    memcpy(c->slice_dst,       dst,       sizeof(c->slice_dst));
+    memcpy(c->slice_dstStride, dstStride, sizeof(c->slice_dstStride));
+
+    avpriv_threadpool_execute(c->slice_pool, &task);
+
+    c->dstY = c->dstH;
+    return c->dstH;
+}
+
 av_cold void ff_sws_init_range_convert(SwsContext *c)
 {
     c->lumConvertRange = NULL;
@@ -746,6 +896,61 @@ static void rgb48Toxyz12(struct SwsContext *c, uint16_t *dst,
     }
 }
 
+/**
+ * Scale a slice in linear light, see the gamma_* fields of SwsContext.
+ */
+static int scale_gamma(SwsContext *c, const uint8_t * const srcSlice[],
+                       const int srcStride[], int srcSliceY, int srcSliceH,
+                       uint8_t *const dst[], const int dstStride[])
+{
+    SwsContext *scaler = c->cascaded_context[1];
+    const uint8_t *src = srcSlice[0];
+    int src_stride     = srcStride[0];
+    uint16_t *lin[4];
+    uint8_t *enc;
+    int enc_stride;
+    int i, ret, y;
+
+    if (c->cascaded_context[0]) {
+        ret = sws_scale(c->cascaded_context[0], srcSlice, srcStride,
+                        srcSliceY, srcSliceH, c->gamma_tmp, c->gamma_tmpStride);
+        if (ret < 0)
+            return ret;
+        src_stride = c->gamma_tmpStride[0];
+        src        = c->gamma_tmp[0] + srcSliceY * src_stride;
+    }
+    for (i = 0; i < 4; i++)
+        lin[i] = c->cascaded_tmp[i] ?
+                 (uint16_t *)(c->cascaded_tmp[i] + srcSliceY * c->cascaded_tmpStride[i]) : NULL;
+    ff_sws_gamma_linearize(lin, c->cascaded_tmpStride, src, src_stride,
+                           c->srcW, srcSliceH, c->gamma_srcFormat == AV_PIX_FMT_RGBA);
+
+    ret = sws_scale(scaler, (const uint8_t * const *)lin, c->cascaded_tmpStride,
+                    srcSliceY, srcSliceH, c->cascaded1_tmp, c->cascaded1_tmpStride);
+    if (ret <= 0)
+        return ret;
+    y = scaler->dstY - ret;
+
+    if (c->cascaded_context[2]) {
+        enc_stride = c->gamma1_tmpStride[0];
+        enc        = c->gamma1_tmp[0] + y * enc_stride;
+    } else {
+        enc_stride = dstStride[0];
+        enc        = dst[0] + y * enc_stride;
+    }
+    for (i = 0; i < 4; i++)
+        lin[i] = c->cascaded1_tmp[i] ?
+                 (uint16_t *)(c->cascaded1_tmp[i] + y * c->cascaded1_tmpStride[i]) : NULL;
+    ff_sws_gamma_encode(enc, enc_stride, (const uint16_t * const *)lin,
+                        c->cascaded1_tmpStride, c->dstW, ret,
+                        c->gamma_dstFormat == AV_PIX_FMT_RGBA);
+
+    if (!c->cascaded_context[2])
+        return ret;
+    return sws_scale(c->cascaded_context[2], (const uint8_t * const *)&enc,
+                     &enc_stride, y, ret, dst, dstStride);
+}
+
 /**
  * swscale wrapper, so we don't need to export the SwsContext.
  * Assumes planar YUV to be in YUV order instead of YVU.
@@ -783,31 +988,9 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
         return AVERROR(EINVAL);
     }
 
-    if (c->gamma_flag && c->cascaded_context[0]) {
-
-
-        ret = sws_scale(c->cascaded_context[0],
-                    srcSlice, srcStride, srcSliceY, srcSliceH,
-                    c->cascaded_tmp, c->cascaded_tmpStride);
-
-        if (ret < 0)
-            return ret;
-
-        if (c->cascaded_context[2])
-            ret = sws_scale(c->cascaded_context[1], (const uint8_t * const *)c->cascaded_tmp, c->cascaded_tmpStride, srcSliceY, srcSliceH, c->cascaded1_tmp, c->cascaded1_tmpStride);
-        else
-            ret = sws_scale(c->cascaded_context[1], (const uint8_t * const *)c->cascaded_tmp, c->cascaded_tmpStride, srcSliceY, srcSliceH, dst, dstStride);
-
-        if (ret < 0)
-            return ret;
-
-        if (c->cascaded_context[2]) {
-            ret = sws_scale(c->cascaded_context[2],
-                        (const uint8_t * const *)c->cascaded1_tmp, c->cascaded1_tmpStride, c->cascaded_context[1]->dstY - ret, c->cascaded_context[1]->dstY,
-                        dst, dstStride);
-        }
-        return ret;
-    }
+    if (c->gamma_cascade)
+        return scale_gamma(c, srcSlice, srcStride, srcSliceY, srcSliceH,
+                           dst, dstStride);
 
     if (c->cascaded_context[0] && srcSliceY == 0 && srcSliceH == c->cascaded_context[0]->srcH) {
         ret = sws_scale(c->cascaded_context[0],
@@ -977,7 +1160,10 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
     /* reset slice direction at end of frame */
     if (srcSliceY_internal + srcSliceH == c->srcH)
         c->sliceDir = 0;
-    ret = c->swscale(c, src2, srcStride2, srcSliceY_internal, srcSliceH, dst2, dstStride2);
+    if (c->nb_slice_ctx && srcSliceY_internal == 0 && srcSliceH == c->srcH)
+        ret = swscale_threaded(c, src2, srcStride2, dst2, dstStride2);
+    else
+        ret = c->swscale(c, src2, srcStride2, srcSliceY_internal, srcSliceH, dst2, dstStride2);
 
 
     if (c->dstXYZ && !(c->srcXYZ && c->srcW==c->dstW && c->srcH==c->dstH)) {
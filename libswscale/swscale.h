@@ -285,9 +285,17 @@ void sws_freeFilter(SwsFilter *filter);
  * If context is NULL, just calls sws_getContext() to get a new
  * context. Otherwise, checks if the parameters are the ones already
  * saved in context. If that is the case, returns the current
- * context. Otherwise, frees context and gets a new context with
+ * context. Otherwise, releases context and gets a new context with
  * the new parameters.
  *
+ * Contexts created by this function without filters are not freed when
+ * released, but kept in a small process-wide pool as long as none of their
+ * options or colorspace details have been changed, and returned again by a
+ * later call with the same parameters instead of being initialized anew.
+ * This makes switching back and forth between a few resolutions cheap. The
+ * pool is bounded in number of contexts and in memory, and is emptied by
+ * sws_flush_caches().
+ *
  * Be warned that srcFilter and dstFilter are not checked, they
  * are assumed to remain the same.
  */
@@ -297,6 +305,13 @@ struct SwsContext *sws_getCachedContext(struct SwsContext *context,
                                         int flags, SwsFilter *srcFilter,
                                         SwsFilter *dstFilter, const double *param);
 
+/**
+ * Free the idle contexts kept by sws_getCachedContext() and the scaler
+ * filters cached by the context initialization. This does not affect the
+ * contexts in use.
+ */
+void sws_flush_caches(void);
+
 /**
  * Convert an 8-bit paletted frame into a frame with a color depth of 32 bits.
  *
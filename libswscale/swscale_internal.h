@@ -27,11 +27,13 @@
 #include "libavutil/avassert.h"
 #include "libavutil/avutil.h"
 #include "libavutil/common.h"
+#include "libavutil/intfloat.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/log.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/ppc/util_altivec.h"
+#include "libavutil/threadpool.h"
 
 #define STR(s) AV_TOSTRING(s) // AV_STRINGIFY is too long
 
@@ -79,6 +81,35 @@ typedef enum SwsAlphaBlend {
     SWS_ALPHA_BLEND_NB,
 } SwsAlphaBlend;
 
+/**
+ * Parameters a scaler filter is computed from, see libswscale/cache.c.
+ */
+typedef struct SwsFilterKey {
+    int xInc;
+    int srcW, dstW;
+    int filterAlign;
+    int one;
+    int flags;
+    int cpu_flags;
+    double param[2];
+    int srcPos, dstPos;
+} SwsFilterKey;
+
+/**
+ * Parameters a context was created with by sws_getCachedContext(), see
+ * libswscale/cache.c.
+ */
+typedef struct SwsContextKey {
+    int srcW, srcH;
+    enum AVPixelFormat srcFormat;
+    int dstW, dstH;
+    enum AVPixelFormat dstFormat;
+    int flags;
+    double param[2];
+    int chr_pos[4];               ///< src_h, src_v, dst_h and dst_v chroma positions.
+    int threads;
+} SwsContextKey;
+
 typedef int (*SwsFunc)(struct SwsContext *context, const uint8_t *src[],
                        int srcStride[], int srcSliceY, int srcSliceH,
                        uint8_t *dst[], int dstStride[]);
@@ -276,6 +307,31 @@ typedef void (*yuv2anyX_fn)(struct SwsContext *c, const int16_t *lumFilter,
 struct SwsSlice;
 struct SwsFilterDescriptor;
 
+/**
+ * State of the float scaler for one plane. The horizontal filter holds the
+ * coefficients of blocks of 8 output pixels tap by tap, i.e. coefficient j
+ * of output pixel i is at h_filter[(i & ~7) * h_filter_size + j * 8 + (i & 7)],
+ * and the lines are padded to a multiple of 8 pixels.
+ */
+typedef struct SwsFloatPlane {
+    int src_w, src_h;
+    int dst_w, dst_h;
+    int log2_h;                   ///< Vertical subsampling of the plane.
+    float *h_filter;
+    int32_t *h_filter_pos;
+    int h_filter_size;
+    float *v_filter;
+    int32_t *v_filter_pos;
+    int v_filter_size;
+    float *line;                  ///< Source line converted to float.
+    float *ring;                  ///< The last v_filter_size horizontally scaled lines.
+    const float **ring_lines;     ///< Lines of ring used by one output line, in order.
+    float *out;                   ///< Vertically scaled line.
+    int stride;                   ///< Number of floats per line of ring and out.
+    int src_y;                    ///< Next source line to scale horizontally.
+    int dst_y;                    ///< Next destination line to output.
+} SwsFloatPlane;
+
 /* This struct should be aligned on at least a 32-byte boundary. */
 typedef struct SwsContext {
     /**
@@ -321,11 +377,40 @@ typedef struct SwsContext {
     uint8_t *cascaded1_tmp[4];
     int cascaded_mainindex;
 
-    double gamma_value;
+    /* The slice_* fields allow splitting a scaler task into groups of
+     * destination lines scaled concurrently, each by its own context, so
+     * that every line is computed exactly as by a single context.
+     */
+    int nb_threads;               ///< Number of threads requested by the user, 0 for automatic.
+    struct SwsContext **slice_ctx;
+    int nb_slice_ctx;
+    ThreadPoolClient *slice_pool;
+    const uint8_t *slice_src[4];  ///< Source image of the frame being scaled by the slice contexts.
+    int slice_srcStride[4];
+    uint8_t *slice_dst[4];        ///< Destination image of the frame being scaled by the slice contexts.
+    int slice_dstStride[4];
+    uint8_t *slice_bounce;        ///< Scratch lines for the last output lines of a slice.
+    unsigned int slice_bounce_size;
+
+    SwsContextKey cache_key;      ///< Parameters of a context created by sws_getCachedContext().
+    int cacheable;                ///< Whether the context may be kept for reuse once replaced.
+    char *cache_opts;             ///< Serialized options of the context after init, for the cache.
+
+    /* With gamma_flag, the source is converted to gamma encoded RGBA or
+     * RGBA64 by cascaded_context[0], linearized into the planes of
+     * cascaded_tmp, scaled plane by plane to cascaded1_tmp by
+     * cascaded_context[1], encoded again and converted to the destination
+     * format by cascaded_context[2]. 8-bit formats go through RGBA, so that
+     * the fast unscaled converters and 8-bit tables can be used.
+     */
     int gamma_flag;
-    int is_internal_gamma;
-    uint16_t *gamma;
-    uint16_t *inv_gamma;
+    int gamma_cascade;            ///< Whether the cascaded contexts implement gamma_flag.
+    enum AVPixelFormat gamma_srcFormat; ///< Gamma encoded format the source is converted to.
+    enum AVPixelFormat gamma_dstFormat; ///< Gamma encoded format the destination is converted from.
+    uint8_t *gamma_tmp[4];        ///< Source converted to gamma_srcFormat.
+    int gamma_tmpStride[4];
+    uint8_t *gamma1_tmp[4];       ///< Destination encoded to gamma_dstFormat.
+    int gamma1_tmpStride[4];
 
     int numDesc;
     int descIndex[2];
@@ -623,6 +708,40 @@ typedef struct SwsContext {
     SwsDither dither;
 
     SwsAlphaBlend alphablend;
+
+    /**
+     * @name Float scaler.
+     * Planar formats whose planes are scaled independently in float, see
+     * scale_float.c.
+     */
+    //@{
+    int float_scale;              ///< Use the float scaler when the formats allow it.
+    SwsFloatPlane float_planes[4];
+    int float_nb_planes;
+    /// Convert a line of the source format to float, multiplying integers by mul.
+    void (*float_read)(float *dst, const uint8_t *src, int width, float mul);
+    /// Convert a line of float to the destination format, multiplying by mul
+    /// and clipping to [0,max] for integers.
+    void (*float_write)(uint8_t *dst, const float *src, int width,
+                        float mul, int max);
+    float float_read_mul;         ///< Normalization of the source to [0,1].
+    float float_write_mul;        ///< Scale from [0,1] to the destination.
+    int float_write_max;          ///< Largest integer of the destination.
+    /**
+     * Scale one line horizontally with the float filters of SwsFloatPlane.
+     * dstW is a multiple of 8, and src is readable up to the last position
+     * plus filterSize.
+     */
+    void (*hscale_float)(float *dst, int dstW, const float *src,
+                         const float *filter, const int32_t *filterPos,
+                         int filterSize);
+    /**
+     * Compute dst[i] = sum of src[j][i] * filter[j] over the filterSize
+     * lines. dstW is a multiple of 8 and the lines are aligned to 32 bytes.
+     */
+    void (*vscale_float)(float *dst, int dstW, const float *const *src,
+                         const float *filter, int filterSize);
+    //@}
 } SwsContext;
 //FIXME check init (where 0)
 
@@ -655,6 +774,13 @@ static av_always_inline int isNBPS(enum AVPixelFormat pix_fmt)
     return desc->comp[0].depth >= 9 && desc->comp[0].depth <= 14;
 }
 
+static av_always_inline int isFloat(enum AVPixelFormat pix_fmt)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt);
+    av_assert0(desc);
+    return desc->flags & AV_PIX_FMT_FLAG_FLOAT;
+}
+
 static av_always_inline int isBE(enum AVPixelFormat pix_fmt)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt);
@@ -830,6 +956,34 @@ void ff_get_unscaled_swscale_aarch64(SwsContext *c);
  */
 SwsFunc ff_getSwsFunc(SwsContext *c);
 
+/**
+ * Look up a filter in the process-wide filter cache.
+ *
+ * @return 0 and a copy of the filter and its positions, allocated with
+ *         av_malloc(), if found, a negative error code otherwise
+ */
+int ff_sws_filter_cache_get(const SwsFilterKey *key, int16_t **filter,
+                            int32_t **filter_pos, int *filter_size);
+
+/**
+ * Add a copy of a filter computed by initFilter() to the filter cache.
+ */
+void ff_sws_filter_cache_put(const SwsFilterKey *key, const int16_t *filter,
+                             const int32_t *filter_pos, int filter_size);
+
+/**
+ * Take an idle context matching key out of the context cache.
+ *
+ * @return the context, or NULL if there is none
+ */
+SwsContext *ff_sws_context_cache_get(const SwsContextKey *key);
+
+/**
+ * Keep a context that is no longer used for reuse by
+ * ff_sws_context_cache_get(), or free it if it cannot be reused.
+ */
+void ff_sws_context_cache_put(SwsContext *c);
+
 void ff_sws_init_input_funcs(SwsContext *c);
 void ff_sws_init_output_funcs(SwsContext *c,
                               yuv2planar1_fn *yuv2plane1,
@@ -841,7 +995,24 @@ void ff_sws_init_output_funcs(SwsContext *c,
                               yuv2anyX_fn *yuv2anyX);
 void ff_sws_init_swscale_ppc(SwsContext *c);
 void ff_sws_init_swscale_x86(SwsContext *c);
+
 void ff_sws_init_swscale_aarch64(SwsContext *c);
+
+/**
+ * Convert a filter computed by initFilter() for the float scaler: the
+ * coefficients are normalized to 1.0, the trailing taps that are zero for
+ * all pixels are dropped and the layout is the one of SwsFloatPlane.
+ */
+int ff_sws_float_filter_init(float **dst_filter, int32_t **dst_pos, int *dst_size,
+                             const int16_t *filter, const int32_t *filter_pos,
+                             int filter_size, int dst_w, int one, int blocked);
+
+/**
+ * Set up the float scaler for planes whose filters are already in
+ * c->float_planes, and make it the scaling function of the context.
+ */
+int ff_sws_init_float_scaler(SwsContext *c);
+void ff_sws_free_float_scaler(SwsContext *c);
 void ff_sws_init_swscale_arm(SwsContext *c);
 
 void ff_hyscale_fast_c(SwsContext *c, int16_t *dst, int dstWidth,
@@ -894,6 +1065,23 @@ static inline void fillPlane16(uint8_t *plane, int stride, int width, int height
     }
 }
 
+static inline void fillPlane32(uint8_t *plane, int stride, int width, int height, int y,
+                               const int big_endian)
+{
+    int i, j;
+    uint8_t *ptr = plane + stride * y;
+    uint32_t v = av_float2int(1.0f);
+    for (i = 0; i < height; i++) {
+        for (j = 0; j < width; j++) {
+            if (big_endian)
+                AV_WB32(ptr + 4 * j, v);
+            else
+                AV_WL32(ptr + 4 * j, v);
+        }
+        ptr += stride;
+    }
+}
+
 #define MAX_SLICE_PLANES 4
 
 /// Slice plane
@@ -956,8 +1144,25 @@ int ff_free_filters(SwsContext *c);
 */
 int ff_rotate_slice(SwsSlice *s, int lum, int chr);
 
-/// initializes gamma conversion descriptor
-int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *table);
+/// initializes the tables used by ff_sws_gamma_linearize() and ff_sws_gamma_encode()
+void ff_sws_init_gamma_tables(void);
+
+/**
+ * Convert gamma encoded RGBA (depth8) or native endian RGBA64 lines to
+ * linear R, G, B and optionally A planes of 16 bits.
+ */
+void ff_sws_gamma_linearize(uint16_t *const dst[4], const int dstStride[4],
+                            const uint8_t *src, int srcStride,
+                            int width, int height, int depth8);
+
+/**
+ * Convert linear R, G, B and optionally A planes of 16 bits to gamma encoded
+ * RGBA (depth8) or native endian RGBA64 lines, with opaque alpha if there
+ * is no A plane.
+ */
+void ff_sws_gamma_encode(uint8_t *dst, int dstStride,
+                         const uint16_t *const src[4], const int srcStride[4],
+                         int width, int height, int depth8);
 
 /// initializes lum pixel format conversion descriptor
 int ff_init_desc_fmt_convert(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlice *dst, uint32_t *pal);
@@ -0,0 +1,175 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* check the reuse of contexts by sws_getCachedContext() and the filter cache */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/imgutils.h"
+#include "libavutil/lfg.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libswscale/swscale.h"
+
+#define SRC_W 352
+#define SRC_H 288
+
+static int nb_reused;
+
+static void log_callback(void *avcl, int level, const char *fmt, va_list vl)
+{
+    if (!strcmp(fmt, "Reusing a cached context\n"))
+        nb_reused++;
+}
+
+static uint8_t *src[4];
+static int src_stride[4];
+
+/* switch c to a SRC_W x SRC_H yuv420p to w x h rgb24 context, and report
+ * whether sws_getCachedContext() took it from the cache */
+static struct SwsContext *get(struct SwsContext *c, int src_w, int src_h,
+                              int w, int h, int flags, int *reused)
+{
+    int prev = nb_reused;
+
+    c = sws_getCachedContext(c, src_w, src_h, AV_PIX_FMT_YUV420P,
+                             w, h, AV_PIX_FMT_RGB24, flags, NULL, NULL, NULL);
+    *reused = nb_reused != prev;
+    return c;
+}
+
+/* compare the output of c with the output of a context created anew */
+static int output_ok(struct SwsContext *c, int w, int h, int flags)
+{
+    struct SwsContext *ref = sws_getContext(SRC_W, SRC_H, AV_PIX_FMT_YUV420P,
+                                            w, h, AV_PIX_FMT_RGB24, flags,
+                                            NULL, NULL, NULL);
+    uint8_t *dst[4] = { NULL }, *dst_ref[4] = { NULL };
+    int dst_stride[4], y, ok = 0;
+
+    if (ref &&
+        av_image_alloc(dst,     dst_stride, w, h, AV_PIX_FMT_RGB24, 16) >= 0 &&
+        av_image_alloc(dst_ref, dst_stride, w, h, AV_PIX_FMT_RGB24, 16) >= 0) {
+        sws_scale(c, (const uint8_t * const *)src, src_stride, 0, SRC_H,
+                  dst, dst_stride);
+        sws_scale(ref, (const uint8_t * const *)src, src_stride, 0, SRC_H,
+                  dst_ref, dst_stride);
+        for (ok = 1, y = 0; y < h; y++)
+            ok &= !memcmp(dst[0]     + y * dst_stride[0],
+                          dst_ref[0] + y * dst_stride[0], w * 3);
+    }
+    av_freep(&dst[0]);
+    av_freep(&dst_ref[0]);
+    sws_freeContext(ref);
+    return ok;
+}
+
+static const char *yes_no(int v)
+{
+    return v ? "yes" : "no";
+}
+
+int main(void)
+{
+    struct SwsContext *c = NULL, *first;
+    AVLFG lfg;
+    int i, size, reused;
+
+    av_log_set_callback(log_callback);
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    if (av_image_alloc(src, src_stride, SRC_W, SRC_H, AV_PIX_FMT_YUV420P, 16) < 0)
+        return 1;
+    size = av_image_get_buffer_size(AV_PIX_FMT_YUV420P, SRC_W, SRC_H, 16);
+    for (i = 0; i < size; i++)
+        src[0][i] = av_lfg_get(&lfg);
+
+    /* a context computing its filters matches one taking them from the
+     * cache, as the reference context of output_ok() does */
+    sws_flush_caches();
+    c = sws_getContext(SRC_W, SRC_H, AV_PIX_FMT_YUV420P, 200, 150,
+                       AV_PIX_FMT_RGB24, SWS_LANCZOS, NULL, NULL, NULL);
+    printf("cached filters: output ok %s\n", yes_no(output_ok(c, 200, 150, SWS_LANCZOS)));
+    sws_freeContext(c);
+    c = NULL;
+
+    /* switching back to a previous size reuses its context */
+    first = c = get(NULL, SRC_W, SRC_H, 200, 150, SWS_BICUBIC, &reused);
+    /* scaling with a context does not prevent its reuse */
+    output_ok(c, 200, 150, SWS_BICUBIC);
+    c = get(c, SRC_W, SRC_H, 320, 240, SWS_BICUBIC, &reused);
+    c = get(c, SRC_W, SRC_H, 200, 150, SWS_BICUBIC, &reused);
+    printf("switch back: reused %s, same context %s, output ok %s\n",
+           yes_no(reused), yes_no(c == first),
+           yes_no(output_ok(c, 200, 150, SWS_BICUBIC)));
+
+    /* 16 idle contexts are kept, the least recently used one is evicted */
+    for (i = 0; i < 15; i++)
+        c = get(c, SRC_W, SRC_H, 100 + 8 * i, 100, SWS_BICUBIC, &reused);
+    c = get(c, SRC_W, SRC_H, 200, 150, SWS_BICUBIC, &reused);
+    printf("after 15 other contexts: reused %s\n", yes_no(reused));
+    for (i = 0; i < 16; i++)
+        c = get(c, SRC_W, SRC_H, 100 + 8 * i, 120, SWS_BICUBIC, &reused);
+    c = get(c, SRC_W, SRC_H, 200, 150, SWS_BICUBIC, &reused);
+    printf("after 16 other contexts: reused %s, output ok %s\n", yes_no(reused),
+           yes_no(output_ok(c, 200, 150, SWS_BICUBIC)));
+
+    /* contexts whose options were changed are not kept */
+    av_opt_set(c, "sws_dither", "ed", 0);
+    c = get(c, SRC_W, SRC_H, 320, 240, SWS_BICUBIC, &reused);
+    c = get(c, SRC_W, SRC_H, 200, 150, SWS_BICUBIC, &reused);
+    printf("changed option: reused %s, output ok %s\n", yes_no(reused),
+           yes_no(output_ok(c, 200, 150, SWS_BICUBIC)));
+    {
+        int *inv_table, *table, src_range, dst_range, brightness, contrast, saturation;
+
+        sws_getColorspaceDetails(c, &inv_table, &src_range, &table, &dst_range,
+                                 &brightness, &contrast, &saturation);
+        sws_setColorspaceDetails(c, inv_table, src_range, table, dst_range,
+                                 brightness + (1 << 12), contrast, saturation);
+    }
+    c = get(c, SRC_W, SRC_H, 320, 240, SWS_BICUBIC, &reused);
+    c = get(c, SRC_W, SRC_H, 200, 150, SWS_BICUBIC, &reused);
+    printf("changed colorspace details: reused %s\n", yes_no(reused));
+
+    /* the memory used by the idle contexts is bounded as well, keeping only
+     * three of these large ones */
+    for (i = 0; i < 4; i++)
+        c = get(c, 8192, 4096, 1024 - 8 * i, 512, SWS_LANCZOS, &reused);
+    c = get(c, SRC_W, SRC_H, 200, 150, SWS_BICUBIC, &reused);
+    c = get(c, 8192, 4096, 1024, 512, SWS_LANCZOS, &reused);
+    printf("large contexts: oldest reused %s", yes_no(reused));
+    c = get(c, 8192, 4096, 1000, 512, SWS_LANCZOS, &reused);
+    printf(", newest reused %s\n", yes_no(reused));
+
+    /* flushing empties the caches */
+    c = get(c, SRC_W, SRC_H, 200, 150, SWS_BICUBIC, &reused);
+    c = get(c, SRC_W, SRC_H, 320, 240, SWS_BICUBIC, &reused);
+    sws_flush_caches();
+    c = get(c, SRC_W, SRC_H, 200, 150, SWS_BICUBIC, &reused);
+    printf("after flush: reused %s, output ok %s\n", yes_no(reused),
+           yes_no(output_ok(c, 200, 150, SWS_BICUBIC)));
+
+    sws_freeContext(c);
+    sws_flush_caches();
+    av_freep(&src[0]);
+    return 0;
+}
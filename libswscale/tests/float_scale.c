@@ -0,0 +1,285 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* check which conversions the float_scale option applies to, and that the
+ * float scaler output is close to the one of the default scaler */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/intfloat.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/lfg.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+
+#define SRC_W 352
+#define SRC_H 288
+
+static const struct {
+    enum AVPixelFormat src, dst;
+} convs[] = {
+    { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P10LE },
+    { AV_PIX_FMT_YUV444P16LE, AV_PIX_FMT_YUV444P16BE },
+    { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P16LE },
+    { AV_PIX_FMT_YUVA422P16LE, AV_PIX_FMT_YUVA422P10LE },
+    { AV_PIX_FMT_GBRP12LE,    AV_PIX_FMT_GBRPF32LE },
+    { AV_PIX_FMT_GBRPF32LE,   AV_PIX_FMT_GBRP16LE },
+    { AV_PIX_FMT_GBRAPF32BE,  AV_PIX_FMT_GBRAPF32LE },
+    { AV_PIX_FMT_GRAYF32LE,   AV_PIX_FMT_GRAY16LE },
+    /* not supported: different subsampling, 8 bits, packed */
+    { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV444P10LE },
+    { AV_PIX_FMT_YUV420P,     AV_PIX_FMT_YUV420P10LE },
+    { AV_PIX_FMT_RGB48LE,     AV_PIX_FMT_GBRP16LE },
+};
+
+static const struct {
+    int w, h;
+    int flags;
+} scales[] = {
+    { 333, 201, SWS_BICUBIC },
+    { 120,  90, SWS_LANCZOS },
+};
+
+static int float_scaler_used;
+
+static void log_callback(void *avcl, int level, const char *fmt, va_list vl)
+{
+    if (!strncmp(fmt, "using float scaler", 18))
+        float_scaler_used = 1;
+}
+
+static struct SwsContext *alloc_context(enum AVPixelFormat src_fmt,
+                                        enum AVPixelFormat dst_fmt,
+                                        int w, int h, int flags, int float_scale)
+{
+    struct SwsContext *c = sws_alloc_context();
+
+    if (!c)
+        return NULL;
+    av_opt_set_int(c, "srcw",        SRC_W,       0);
+    av_opt_set_int(c, "srch",        SRC_H,       0);
+    av_opt_set_int(c, "src_format",  src_fmt,     0);
+    av_opt_set_int(c, "dstw",        w,           0);
+    av_opt_set_int(c, "dsth",        h,           0);
+    av_opt_set_int(c, "dst_format",  dst_fmt,     0);
+    av_opt_set_int(c, "sws_flags",   flags,       0);
+    av_opt_set_int(c, "float_scale", float_scale, 0);
+    if (sws_init_context(c, NULL, NULL) < 0) {
+        sws_freeContext(c);
+        return NULL;
+    }
+    return c;
+}
+
+static int scale(enum AVPixelFormat src_fmt, uint8_t *src[4], int src_stride[4],
+                 enum AVPixelFormat dst_fmt, int w, int h, int flags,
+                 int float_scale, uint8_t *dst[4], int dst_stride[4])
+{
+    struct SwsContext *c;
+    int ret;
+
+    float_scaler_used = 0;
+    c = alloc_context(src_fmt, dst_fmt, w, h, flags | SWS_PRINT_INFO, float_scale);
+    if (!c)
+        return -1;
+    ret = av_image_alloc(dst, dst_stride, w, h, dst_fmt, 32);
+    if (ret >= 0)
+        ret = sws_scale(c, (const uint8_t * const *)src, src_stride, 0, SRC_H,
+                        dst, dst_stride);
+    sws_freeContext(c);
+    return ret;
+}
+
+/* component c at x of a line, in [0,1] for integers */
+static double get(const AVPixFmtDescriptor *desc, const uint8_t *line, int c, int x)
+{
+    const AVComponentDescriptor *comp = &desc->comp[c];
+    int be = desc->flags & AV_PIX_FMT_FLAG_BE;
+
+    if (desc->flags & AV_PIX_FMT_FLAG_FLOAT)
+        return av_int2float(be ? AV_RB32(line + 4 * x) : AV_RL32(line + 4 * x));
+    if (comp->depth > 8)
+        return (be ? AV_RB16(line + 2 * x) : AV_RL16(line + 2 * x)) /
+               (double)((1 << comp->depth) - 1);
+    return line[x] / 255.0;
+}
+
+static void put(const AVPixFmtDescriptor *desc, uint8_t *line, int c, int x,
+                double v)
+{
+    const AVComponentDescriptor *comp = &desc->comp[c];
+    int be = desc->flags & AV_PIX_FMT_FLAG_BE;
+
+    if (desc->flags & AV_PIX_FMT_FLAG_FLOAT) {
+        uint32_t f = av_float2int(v);
+        if (be)
+            AV_WB32(line + 4 * x, f);
+        else
+            AV_WL32(line + 4 * x, f);
+    } else if (comp->depth > 8) {
+        int i = v * ((1 << comp->depth) - 1) + 0.5;
+        if (be)
+            AV_WB16(line + 2 * x, i);
+        else
+            AV_WL16(line + 2 * x, i);
+    } else {
+        line[x] = v * 255 + 0.5;
+    }
+}
+
+/* fill the planar formats with a constant per component or with gradients
+ * and some noise, within [0,1] so that the scalers clip the same values, and
+ * the others with random bytes */
+static void fill(enum AVPixelFormat fmt, uint8_t *data[4], int stride[4],
+                 int constant, AVLFG *lfg)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    int c, x, y;
+
+    if (!(desc->flags & AV_PIX_FMT_FLAG_PLANAR) && desc->nb_components > 1) {
+        for (y = 0; y < SRC_H; y++)
+            for (x = 0; x < stride[0]; x++)
+                data[0][y * stride[0] + x] = av_lfg_get(lfg);
+        return;
+    }
+    for (c = 0; c < desc->nb_components; c++) {
+        int chroma = (c == 1 || c == 2) && !(desc->flags & AV_PIX_FMT_FLAG_RGB);
+        int w = chroma ? AV_CEIL_RSHIFT(SRC_W, desc->log2_chroma_w) : SRC_W;
+        int h = chroma ? AV_CEIL_RSHIFT(SRC_H, desc->log2_chroma_h) : SRC_H;
+        int p = desc->comp[c].plane;
+
+        for (y = 0; y < h; y++)
+            for (x = 0; x < w; x++)
+                put(desc, data[p] + y * stride[p], c, x, constant ? 0.2 + 0.15 * c :
+                    (x + y + c * 64) % 512 / 768.0 + (av_lfg_get(lfg) & 0xff) / 1024.0);
+    }
+}
+
+/* largest difference between a and b, or between a and the constants of
+ * fill() if b is NULL */
+static double max_diff(enum AVPixelFormat fmt, int w, int h, uint8_t *a[4],
+                       uint8_t *b[4], int stride[4])
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    double diff = 0;
+    int c, x, y;
+
+    for (c = 0; c < desc->nb_components; c++) {
+        int chroma = (c == 1 || c == 2) && !(desc->flags & AV_PIX_FMT_FLAG_RGB);
+        int cw = chroma ? AV_CEIL_RSHIFT(w, desc->log2_chroma_w) : w;
+        int ch = chroma ? AV_CEIL_RSHIFT(h, desc->log2_chroma_h) : h;
+        int p = desc->comp[c].plane;
+
+        for (y = 0; y < ch; y++)
+            for (x = 0; x < cw; x++) {
+                double ref = b ? get(desc, b[p] + y * stride[p], c, x) : 0.2 + 0.15 * c;
+                diff = FFMAX(diff, fabs(get(desc, a[p] + y * stride[p], c, x) - ref));
+            }
+    }
+    return diff;
+}
+
+/* two steps of the less precise format, float ones counting as 16 bits */
+static double tolerance(enum AVPixelFormat src_fmt, enum AVPixelFormat dst_fmt)
+{
+    const AVPixFmtDescriptor *src = av_pix_fmt_desc_get(src_fmt);
+    const AVPixFmtDescriptor *dst = av_pix_fmt_desc_get(dst_fmt);
+    int depth = FFMIN(FFMIN(src->comp[0].depth, dst->comp[0].depth), 16);
+
+    return 2.0 / (1 << depth);
+}
+
+static const char *ok(double diff, double tolerance)
+{
+    return diff <= tolerance ? "ok" : "mismatch";
+}
+
+int main(void)
+{
+    uint8_t *src[4] = { NULL }, *dst[4] = { NULL }, *dst_ref[4] = { NULL };
+    int src_stride[4], dst_stride[4];
+    int f, i, ret = 1;
+    AVLFG lfg;
+
+    av_log_set_callback(log_callback);
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(convs); f++) {
+        const enum AVPixelFormat src_fmt = convs[f].src, dst_fmt = convs[f].dst;
+        const char *src_name = av_get_pix_fmt_name(src_fmt);
+        const char *dst_name = av_get_pix_fmt_name(dst_fmt);
+        const double tol = tolerance(src_fmt, dst_fmt);
+        /* the default scaler goes through YUV for RGB, losing precision */
+        const int cmp_default = !(av_pix_fmt_desc_get(dst_fmt)->flags & AV_PIX_FMT_FLAG_RGB);
+
+        if (av_image_alloc(src, src_stride, SRC_W, SRC_H, src_fmt, 32) < 0)
+            goto end;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(scales); i++) {
+            const int w = scales[i].w, h = scales[i].h, flags = scales[i].flags;
+
+            /* a constant stays one, with each component in its place */
+            fill(src_fmt, src, src_stride, 1, &lfg);
+            if (scale(src_fmt, src, src_stride, dst_fmt, w, h, flags, 1,
+                      dst, dst_stride) < 0)
+                goto fail;
+            printf("%s -> %dx%d %s: float scaler ", src_name, w, h, dst_name);
+            if (!float_scaler_used) {
+                printf("not used\n");
+                av_freep(&dst[0]);
+                continue;
+            }
+            printf("used, constant %s", ok(max_diff(dst_fmt, w, h, dst, NULL, dst_stride), tol));
+            av_freep(&dst[0]);
+
+            fill(src_fmt, src, src_stride, 0, &lfg);
+            if (scale(src_fmt, src, src_stride, dst_fmt, w, h, flags, 0,
+                      dst_ref, dst_stride) < 0 ||
+                float_scaler_used ||
+                scale(src_fmt, src, src_stride, dst_fmt, w, h, flags, 1,
+                      dst, dst_stride) < 0)
+                goto fail;
+            /* the default scaler is less precise for 16-bit formats */
+            if (cmp_default)
+                printf(", default scaler %s",
+                       ok(max_diff(dst_fmt, w, h, dst, dst_ref, dst_stride),
+                          FFMAX(tol, 1.0 / (1 << 11))));
+            printf("\n");
+            av_freep(&dst[0]);
+            av_freep(&dst_ref[0]);
+        }
+        av_freep(&src[0]);
+    }
+    ret = 0;
+    goto end;
+
+fail:
+    printf("scaling failed\n");
+end:
+    av_freep(&src[0]);
+    av_freep(&dst[0]);
+    av_freep(&dst_ref[0]);
+    return ret;
+}
@@ -0,0 +1,268 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check the gamma correct scaling against a scaling of the linearized image
+ * computed here, or with -b, compare its speed to the default scaling.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+#include "libswscale/swscale.h"
+
+#define SRC_W 1280
+#define SRC_H 720
+#define DST_W 320
+#define DST_H 180
+#define GAMMA 2.2
+
+static const struct {
+    enum AVPixelFormat src, dst;
+} tests[] = {
+    { AV_PIX_FMT_YUV420P,    AV_PIX_FMT_YUV420P    },
+    { AV_PIX_FMT_YUV420P,    AV_PIX_FMT_RGBA       },
+    { AV_PIX_FMT_RGB24,      AV_PIX_FMT_RGB24      },
+    { AV_PIX_FMT_RGBA,       AV_PIX_FMT_RGBA       },
+    { AV_PIX_FMT_RGBA64LE,   AV_PIX_FMT_RGBA64LE   },
+    { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_RGB48LE   },
+};
+
+static struct SwsContext *get_context(int src_w, int src_h, enum AVPixelFormat src_fmt,
+                                      int dst_w, int dst_h, enum AVPixelFormat dst_fmt,
+                                      int gamma, int flags)
+{
+    struct SwsContext *c = sws_alloc_context();
+
+    if (!c)
+        return NULL;
+    av_opt_set_int(c, "srcw",       src_w,       0);
+    av_opt_set_int(c, "srch",       src_h,       0);
+    av_opt_set_int(c, "src_format", src_fmt,     0);
+    av_opt_set_int(c, "dstw",       dst_w,       0);
+    av_opt_set_int(c, "dsth",       dst_h,       0);
+    av_opt_set_int(c, "dst_format", dst_fmt,     0);
+    av_opt_set_int(c, "sws_flags",  flags,       0);
+    av_opt_set_int(c, "gamma",      gamma,       0);
+    if (sws_init_context(c, NULL, NULL) < 0) {
+        sws_freeContext(c);
+        return NULL;
+    }
+    return c;
+}
+
+/* apply the transfer function to the RGB components of RGBA64LE pixels */
+static void apply_gamma(uint8_t *buf, int stride, int w, int h, double e)
+{
+    int x, y;
+
+    for (y = 0; y < h; y++) {
+        uint16_t *p = (uint16_t *)(buf + y * stride);
+        for (x = 0; x < 4 * w; x++)
+            if ((x & 3) != 3)
+                AV_WL16(p + x, lrint(pow(AV_RL16(p + x) / 65535.0, e) * 65535.0));
+    }
+}
+
+/* max difference between the components of two images, in 8-bit units; RGB
+ * components are also compared in linear light, as tiny linear differences
+ * near black are amplified when encoded to 16 bits */
+static double compare(uint8_t *a[4], uint8_t *b[4], const int stride[4],
+                      enum AVPixelFormat fmt, int w, int h)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    int rgb = desc->flags & AV_PIX_FMT_FLAG_RGB;
+    double diff = 0;
+    int c, x, y;
+
+    for (c = 0; c < desc->nb_components; c++) {
+        int max = (1 << desc->comp[c].depth) - 1;
+        int cw = c == 1 || c == 2 ? AV_CEIL_RSHIFT(w, desc->log2_chroma_w) : w;
+        int ch = c == 1 || c == 2 ? AV_CEIL_RSHIFT(h, desc->log2_chroma_h) : h;
+        uint16_t line_a[DST_W], line_b[DST_W];
+
+        for (y = 0; y < ch; y++) {
+            av_read_image_line(line_a, (const uint8_t **)a, stride, desc, 0, y, c, cw, 0);
+            av_read_image_line(line_b, (const uint8_t **)b, stride, desc, 0, y, c, cw, 0);
+            for (x = 0; x < cw; x++) {
+                double va = line_a[x] / (double)max, vb = line_b[x] / (double)max;
+                double d  = fabs(va - vb);
+                if (rgb && c < 3)
+                    d = FFMIN(d, fabs(pow(va, GAMMA) - pow(vb, GAMMA)));
+                diff = FFMAX(diff, d * 255);
+            }
+        }
+    }
+    return diff;
+}
+
+/* scale by hand in linear light: to RGBA64LE, linearize, scale, encode back */
+static int scale_reference(const uint8_t *const src[4], const int src_stride[4],
+                           enum AVPixelFormat src_fmt, uint8_t *dst[4],
+                           const int dst_stride[4], enum AVPixelFormat dst_fmt)
+{
+    struct SwsContext *c[3];
+    uint8_t *tmp[4], *tmp1[4];
+    int tmp_stride[4], tmp1_stride[4];
+    int ret = -1;
+
+    c[0] = get_context(SRC_W, SRC_H, src_fmt, SRC_W, SRC_H, AV_PIX_FMT_RGBA64LE, 0, SWS_BICUBIC);
+    c[1] = get_context(SRC_W, SRC_H, AV_PIX_FMT_RGBA64LE, DST_W, DST_H, AV_PIX_FMT_RGBA64LE, 0,
+                       SWS_BICUBIC | SWS_FULL_CHR_H_INP | SWS_FULL_CHR_H_INT);
+    c[2] = get_context(DST_W, DST_H, AV_PIX_FMT_RGBA64LE, DST_W, DST_H, dst_fmt, 0, SWS_BICUBIC);
+    if (!c[0] || !c[1] || !c[2] ||
+        av_image_alloc(tmp, tmp_stride, SRC_W, SRC_H, AV_PIX_FMT_RGBA64LE, 32) < 0)
+        goto end;
+    if (av_image_alloc(tmp1, tmp1_stride, DST_W, DST_H, AV_PIX_FMT_RGBA64LE, 32) < 0) {
+        av_freep(&tmp[0]);
+        goto end;
+    }
+
+    sws_scale(c[0], src, src_stride, 0, SRC_H, tmp, tmp_stride);
+    apply_gamma(tmp[0], tmp_stride[0], SRC_W, SRC_H, GAMMA);
+    sws_scale(c[1], (const uint8_t * const *)tmp, tmp_stride, 0, SRC_H, tmp1, tmp1_stride);
+    apply_gamma(tmp1[0], tmp1_stride[0], DST_W, DST_H, 1.0 / GAMMA);
+    sws_scale(c[2], (const uint8_t * const *)tmp1, tmp1_stride, 0, DST_H, dst, dst_stride);
+    ret = 0;
+
+    av_freep(&tmp[0]);
+    av_freep(&tmp1[0]);
+end:
+    sws_freeContext(c[0]);
+    sws_freeContext(c[1]);
+    sws_freeContext(c[2]);
+    return ret;
+}
+
+static double bench(struct SwsContext *c, const uint8_t *const src[4],
+                    const int src_stride[4], uint8_t *dst[4], const int dst_stride[4])
+{
+    int64_t t = av_gettime_relative();
+    int i, n = 0;
+
+    do {
+        for (i = 0; i < 10; i++)
+            sws_scale(c, src, src_stride, 0, SRC_H, dst, dst_stride);
+        n += 10;
+    } while (av_gettime_relative() - t < 500000);
+
+    return (av_gettime_relative() - t) / 1000.0 / n;
+}
+
+int main(int argc, char **argv)
+{
+    int do_bench = argc > 1 && !strcmp(argv[1], "-b");
+    uint8_t *src[4] = { NULL }, *dst[4] = { NULL }, *ref[4] = { NULL };
+    int src_stride[4], dst_stride[4];
+    struct SwsContext *c = NULL, *c_default = NULL;
+    int i, x, y, ret = 1;
+    AVLFG lfg;
+
+    av_lfg_init(&lfg, 1);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(tests); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(tests[i].src);
+        const char *src_name = av_get_pix_fmt_name(tests[i].src);
+        const char *dst_name = av_get_pix_fmt_name(tests[i].dst);
+        double diff;
+
+        if (av_image_alloc(src, src_stride, SRC_W, SRC_H, tests[i].src, 32) < 0 ||
+            av_image_alloc(dst, dst_stride, DST_W, DST_H, tests[i].dst, 32) < 0 ||
+            av_image_alloc(ref, dst_stride, DST_W, DST_H, tests[i].dst, 32) < 0)
+            goto end;
+
+        /* fine black and white patterns and a noisy luma gradient, with
+         * smooth chroma; the patterns look darker when scaled without
+         * linearization */
+        for (y = 0; y < SRC_H; y++) {
+            int k;
+            for (k = 0; k < desc->nb_components; k++) {
+                const AVComponentDescriptor *comp = &desc->comp[k];
+                int max = (1 << comp->depth) - 1;
+                int chroma = (k == 1 || k == 2) && !(desc->flags & AV_PIX_FMT_FLAG_RGB);
+                int cw = chroma ? AV_CEIL_RSHIFT(SRC_W, desc->log2_chroma_w) : SRC_W;
+                uint16_t line[SRC_W];
+
+                if (chroma && (y & ((1 << desc->log2_chroma_h) - 1)))
+                    continue;
+                for (x = 0; x < cw; x++) {
+                    if (k == 3)
+                        line[x] = max;
+                    else if (chroma)
+                        line[x] = max / 4 + (int64_t)max * (x + y) / (cw + SRC_H) / 2;
+                    else if (x < SRC_W / 2)
+                        line[x] = (x ^ y) & 1 ? max : 0;
+                    else
+                        line[x] = (int64_t)max * x / SRC_W + av_lfg_get(&lfg) % 16;
+                    line[x] = FFMIN(line[x], max);
+                }
+                av_write_image_line(line, src, src_stride, desc, 0,
+                                    y >> (chroma ? desc->log2_chroma_h : 0), k, cw);
+            }
+        }
+
+        c = get_context(SRC_W, SRC_H, tests[i].src, DST_W, DST_H, tests[i].dst, 1, SWS_BICUBIC);
+        if (!c)
+            goto end;
+
+        if (do_bench) {
+            c_default = get_context(SRC_W, SRC_H, tests[i].src, DST_W, DST_H, tests[i].dst, 0, SWS_BICUBIC);
+            if (!c_default)
+                goto end;
+            printf("%s -> %s: default %.2f ms, gamma %.2f ms\n", src_name, dst_name,
+                   bench(c_default, (const uint8_t * const *)src, src_stride, dst, dst_stride),
+                   bench(c,         (const uint8_t * const *)src, src_stride, dst, dst_stride));
+            sws_freeContext(c_default);
+            c_default = NULL;
+        } else {
+            sws_scale(c, (const uint8_t * const *)src, src_stride, 0, SRC_H, dst, dst_stride);
+            if (scale_reference((const uint8_t * const *)src, src_stride, tests[i].src,
+                                ref, dst_stride, tests[i].dst) < 0)
+                goto end;
+            /* the 8-bit formats are linearized from 8-bit RGB */
+            diff = compare(dst, ref, dst_stride, tests[i].dst, DST_W, DST_H);
+            if (diff > 4)
+                printf("%s -> %s: max difference %.1f\n", src_name, dst_name, diff);
+            else
+                printf("%s -> %s: ok\n", src_name, dst_name);
+        }
+
+        sws_freeContext(c);
+        c = NULL;
+        av_freep(&src[0]);
+        av_freep(&dst[0]);
+        av_freep(&ref[0]);
+    }
+    ret = 0;
+
+end:
+    sws_freeContext(c);
+    sws_freeContext(c_default);
+    av_freep(&src[0]);
+    av_freep(&dst[0]);
+    av_freep(&ref[0]);
+    return ret;
+}
@@ -0,0 +1,147 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* check that scaling with several threads matches the single threaded output */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/imgutils.h"
+#include "libavutil/lfg.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+
+#define SRC_W 352
+#define SRC_H 288
+
+static const enum AVPixelFormat src_fmts[] = {
+    AV_PIX_FMT_YUV420P, AV_PIX_FMT_RGB24,
+};
+
+static const enum AVPixelFormat dst_fmts[] = {
+    AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUVA420P,
+    AV_PIX_FMT_NV12,    AV_PIX_FMT_YUYV422, AV_PIX_FMT_RGB24,
+    AV_PIX_FMT_BGRA,    AV_PIX_FMT_GRAY16LE, AV_PIX_FMT_YUV420P10LE,
+};
+
+static const struct {
+    int w, h;
+    int flags;
+} scales[] = {
+    { 333, 201, SWS_BICUBIC },
+    { 640, 480, SWS_BILINEAR },
+    { 175, 150, SWS_LANCZOS | SWS_ACCURATE_RND | SWS_BITEXACT },
+};
+
+static struct SwsContext *alloc_context(enum AVPixelFormat src_fmt,
+                                        enum AVPixelFormat dst_fmt,
+                                        int w, int h, int flags, int threads)
+{
+    struct SwsContext *c = sws_alloc_context();
+
+    if (!c)
+        return NULL;
+    av_opt_set_int(c, "srcw",       SRC_W,   0);
+    av_opt_set_int(c, "srch",       SRC_H,   0);
+    av_opt_set_int(c, "src_format", src_fmt, 0);
+    av_opt_set_int(c, "dstw",       w,       0);
+    av_opt_set_int(c, "dsth",       h,       0);
+    av_opt_set_int(c, "dst_format", dst_fmt, 0);
+    av_opt_set_int(c, "sws_flags",  flags,   0);
+    av_opt_set_int(c, "threads",    threads, 0);
+    if (sws_init_context(c, NULL, NULL) < 0) {
+        sws_freeContext(c);
+        return NULL;
+    }
+    return c;
+}
+
+/* scale with the given number of threads into a buffer without line padding,
+ * so that writing past the end of a line reaches the next one */
+static int scale(enum AVPixelFormat src_fmt, uint8_t *src[4], int src_stride[4],
+                 enum AVPixelFormat dst_fmt, int w, int h, int flags,
+                 int threads, uint8_t *dst[4], int dst_stride[4])
+{
+    struct SwsContext *c = alloc_context(src_fmt, dst_fmt, w, h, flags, threads);
+    int ret;
+
+    if (!c)
+        return -1;
+    ret = av_image_alloc(dst, dst_stride, w, h, dst_fmt, 1);
+    if (ret >= 0)
+        ret = sws_scale(c, (const uint8_t * const *)src, src_stride, 0, SRC_H,
+                        dst, dst_stride);
+    sws_freeContext(c);
+    return ret;
+}
+
+int main(void)
+{
+    uint8_t *src[4] = { NULL }, *dst[4] = { NULL }, *dst_ref[4] = { NULL };
+    int src_stride[4], dst_stride[4];
+    int f, d, i, j, ret = 1;
+    AVLFG lfg;
+
+    /* the tightly packed destination lines are deliberately unaligned */
+    av_log_set_level(AV_LOG_ERROR);
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(src_fmts); f++) {
+        int size;
+
+        if (av_image_alloc(src, src_stride, SRC_W, SRC_H, src_fmts[f], 32) < 0)
+            goto end;
+        size = av_image_get_buffer_size(src_fmts[f], SRC_W, SRC_H, 32);
+        for (j = 0; j < size; j++)
+            src[0][j] = av_lfg_get(&lfg);
+
+        for (d = 0; d < FF_ARRAY_ELEMS(dst_fmts); d++) {
+            for (i = 0; i < FF_ARRAY_ELEMS(scales); i++) {
+                const int w = scales[i].w, h = scales[i].h;
+
+                if (scale(src_fmts[f], src, src_stride, dst_fmts[d], w, h,
+                          scales[i].flags, 1, dst_ref, dst_stride) < 0 ||
+                    scale(src_fmts[f], src, src_stride, dst_fmts[d], w, h,
+                          scales[i].flags, 4, dst, dst_stride) < 0) {
+                    printf("%s -> %dx%d %s: scaling failed\n",
+                           av_get_pix_fmt_name(src_fmts[f]), w, h,
+                           av_get_pix_fmt_name(dst_fmts[d]));
+                    goto end;
+                }
+
+                size = av_image_get_buffer_size(dst_fmts[d], w, h, 1);
+                printf("%s -> %dx%d %s: %s\n", av_get_pix_fmt_name(src_fmts[f]),
+                       w, h, av_get_pix_fmt_name(dst_fmts[d]),
+                       memcmp(dst[0], dst_ref[0], size) ? "mismatch" : "ok");
+                av_freep(&dst[0]);
+                av_freep(&dst_ref[0]);
+            }
+        }
+        av_freep(&src[0]);
+    }
+    ret = 0;
+
+end:
+    av_freep(&src[0]);
+    av_freep(&dst[0]);
+    av_freep(&dst_ref[0]);
+    return ret;
+}
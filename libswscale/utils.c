@@ -256,6 +256,12 @@ static const FormatEntry format_entries[AV_PIX_FMT_NB] = {
     [AV_PIX_FMT_P010BE]      = { 1, 1 },
     [AV_PIX_FMT_P016LE]      = { 1, 0 },
     [AV_PIX_FMT_P016BE]      = { 1, 0 },
+    [AV_PIX_FMT_GBRPF32LE]   = { 1, 1, 1 },
+    [AV_PIX_FMT_GBRPF32BE]   = { 1, 1, 1 },
+    [AV_PIX_FMT_GBRAPF32LE]  = { 1, 1, 1 },
+    [AV_PIX_FMT_GBRAPF32BE]  = { 1, 1, 1 },
+    [AV_PIX_FMT_GRAYF32LE]   = { 1, 1, 1 },
+    [AV_PIX_FMT_GRAYF32BE]   = { 1, 1, 1 },
 };
 
 int sws_isSupportedInput(enum AVPixelFormat pix_fmt)
@@ -318,12 +324,12 @@ static const ScaleAlgorithm scale_algorithms[] = {
     { SWS_X,             "experimental",                    8 },
 };
 
-static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
-                              int *outFilterSize, int xInc, int srcW,
-                              int dstW, int filterAlign, int one,
-                              int flags, int cpu_flags,
-                              SwsVector *srcFilter, SwsVector *dstFilter,
-                              double param[2], int srcPos, int dstPos)
+static av_cold int compute_filter(int16_t **outFilter, int32_t **filterPos,
+                                  int *outFilterSize, int xInc, int srcW,
+                                  int dstW, int filterAlign, int one,
+                                  int flags, int cpu_flags,
+                                  SwsVector *srcFilter, SwsVector *dstFilter,
+                                  double param[2], int srcPos, int dstPos)
 {
     int i;
     int filterSize;
@@ -715,6 +721,45 @@ fail:
     return ret;
 }
 
+/* Filters without user vectors only depend on their parameters, and are
+ * shared through the filter cache. */
+static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
+                              int *outFilterSize, int xInc, int srcW,
+                              int dstW, int filterAlign, int one,
+                              int flags, int cpu_flags,
+                              SwsVector *srcFilter, SwsVector *dstFilter,
+                              double param[2], int srcPos, int dstPos)
+{
+    SwsFilterKey key = {
+        .xInc        = xInc,
+        .srcW        = srcW,
+        .dstW        = dstW,
+        .filterAlign = filterAlign,
+        .one         = one,
+        .flags       = flags & ~SWS_PRINT_INFO,
+        .cpu_flags   = cpu_flags,
+        .param       = { param[0], param[1] },
+        .srcPos      = srcPos,
+        .dstPos      = dstPos,
+    };
+    int ret;
+
+    if (srcFilter || dstFilter)
+        return compute_filter(outFilter, filterPos, outFilterSize, xInc,
+                              srcW, dstW, filterAlign, one, flags, cpu_flags,
+                              srcFilter, dstFilter, param, srcPos, dstPos);
+
+    if (ff_sws_filter_cache_get(&key, outFilter, filterPos, outFilterSize) >= 0)
+        return 0;
+
+    ret = compute_filter(outFilter, filterPos, outFilterSize, xInc,
+                         srcW, dstW, filterAlign, one, flags, cpu_flags,
+                         NULL, NULL, param, srcPos, dstPos);
+    if (ret >= 0)
+        ff_sws_filter_cache_put(&key, *outFilter, *filterPos, *outFilterSize);
+    return ret;
+}
+
 static void fill_rgb2yuv_table(SwsContext *c, const int table[4], int dstRange)
 {
     int64_t W, V, Z, Cy, Cu, Cv;
@@ -851,7 +896,15 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
 {
     const AVPixFmtDescriptor *desc_dst;
     const AVPixFmtDescriptor *desc_src;
-    int need_reinit = 0;
+    int i, need_reinit = 0;
+
+    for (i = 0; i < c->nb_slice_ctx; i++) {
+        int ret = sws_setColorspaceDetails(c->slice_ctx[i], inv_table, srcRange,
+                                           table, dstRange,
+                                           brightness, contrast, saturation);
+        if (ret < 0)
+            return ret;
+    }
 
     handle_formats(c);
     desc_dst = av_pix_fmt_desc_get(c->dstFormat);
@@ -1024,6 +1077,8 @@ static int handle_jpeg(enum AVPixelFormat *format)
     case AV_PIX_FMT_GRAY12BE:
     case AV_PIX_FMT_GRAY16LE:
     case AV_PIX_FMT_GRAY16BE:
+    case AV_PIX_FMT_GRAYF32LE:
+    case AV_PIX_FMT_GRAYF32BE:
     case AV_PIX_FMT_YA16BE:
     case AV_PIX_FMT_YA16LE:
         return 1;
@@ -1076,20 +1131,6 @@ SwsContext *sws_alloc_context(void)
     return c;
 }
 
-static uint16_t * alloc_gamma_tbl(double e)
-{
-    int i = 0;
-    uint16_t * tbl;
-    tbl = (uint16_t*)av_malloc(sizeof(uint16_t) * 1 << 16);
-    if (!tbl)
-        return NULL;
-
-    for (i = 0; i < 65536; ++i) {
-        tbl[i] = pow(i / 65535.0, e) * 65535.0;
-    }
-    return tbl;
-}
-
 static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
 {
     switch(fmt) {
@@ -1148,8 +1189,123 @@ static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
     }
 }
 
-av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
-                             SwsFilter *dstFilter)
+/* whether the components of a format can be read and written by the float
+ * scaler: each in a plane of its own, of 9 to 16 bits or float */
+static av_cold int float_scaler_format(const AVPixFmtDescriptor *desc)
+{
+    int planes = 0;
+    int i;
+
+    if (desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM |
+                       AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BAYER))
+        return 0;
+    if (!(desc->flags & AV_PIX_FMT_FLAG_PLANAR) && desc->nb_components > 1)
+        return 0;
+    for (i = 0; i < desc->nb_components; i++) {
+        const AVComponentDescriptor *comp = &desc->comp[i];
+        if (comp->step != (comp->depth + 7) / 8 || comp->shift || comp->offset ||
+            comp->depth != desc->comp[0].depth)
+            return 0;
+        planes |= 1 << comp->plane;
+    }
+    if (planes != (1 << desc->nb_components) - 1)
+        return 0;
+
+    return (desc->flags & AV_PIX_FMT_FLAG_FLOAT) ||
+           (desc->comp[0].depth > 8 && desc->comp[0].depth <= 16);
+}
+
+/* whether the scaling is done by the float scaler: it has to be enabled with
+ * the float_scale option, and both formats need the same planes and chroma
+ * subsampling, their depth and endianness may differ */
+static av_cold int use_float_scaler(SwsContext *c)
+{
+    const AVPixFmtDescriptor *src = av_pix_fmt_desc_get(c->srcFormat);
+    const AVPixFmtDescriptor *dst = av_pix_fmt_desc_get(c->dstFormat);
+    int i;
+
+    if (!c->float_scale)
+        return 0;
+    if (!float_scaler_format(src) || !float_scaler_format(dst) ||
+        src->nb_components != dst->nb_components ||
+        src->log2_chroma_w != dst->log2_chroma_w ||
+        src->log2_chroma_h != dst->log2_chroma_h ||
+        (src->flags & AV_PIX_FMT_FLAG_RGB) != (dst->flags & AV_PIX_FMT_FLAG_RGB))
+        goto unsupported;
+    for (i = 0; i < src->nb_components; i++)
+        if (src->comp[i].plane != dst->comp[i].plane)
+            goto unsupported;
+
+    return 1;
+unsupported:
+    av_log(c, AV_LOG_VERBOSE, "float scaler unsupported for %s -> %s\n",
+           src->name, dst->name);
+    return 0;
+}
+
+static av_cold int init_float_scaler(SwsContext *c, SwsFilter *srcFilter,
+                                     SwsFilter *dstFilter)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    int flags = c->flags;
+    int i, ret;
+
+    c->float_nb_planes = desc->nb_components;
+    for (i = 0; i < c->float_nb_planes; i++) {
+        SwsFloatPlane *p = &c->float_planes[i];
+        int chroma = (i == 1 || i == 2) && !(desc->flags & AV_PIX_FMT_FLAG_RGB);
+        int log2_w = chroma ? desc->log2_chroma_w : 0;
+        int log2_h = chroma ? desc->log2_chroma_h : 0;
+        int plane_flags = (flags & SWS_BICUBLIN) ?
+                          (flags | (chroma ? SWS_BILINEAR : SWS_BICUBIC)) : flags;
+        int16_t *filter = NULL;
+        int32_t *filter_pos = NULL;
+        int filter_size, inc;
+
+        p->src_w  = AV_CEIL_RSHIFT(c->srcW, log2_w);
+        p->src_h  = AV_CEIL_RSHIFT(c->srcH, log2_h);
+        p->dst_w  = AV_CEIL_RSHIFT(c->dstW, log2_w);
+        p->dst_h  = AV_CEIL_RSHIFT(c->dstH, log2_h);
+        p->log2_h = log2_h;
+
+        inc = (((int64_t)p->src_w << 16) + (p->dst_w >> 1)) / p->dst_w;
+        ret = initFilter(&filter, &filter_pos, &filter_size, inc,
+                         p->src_w, p->dst_w, 1, 1 << 14, plane_flags, 0,
+                         chroma ? srcFilter->chrH : srcFilter->lumH,
+                         chroma ? dstFilter->chrH : dstFilter->lumH, c->param,
+                         get_local_pos(c, log2_w, chroma ? c->src_h_chr_pos : 0, 0),
+                         get_local_pos(c, log2_w, chroma ? c->dst_h_chr_pos : 0, 0));
+        if (ret >= 0)
+            ret = ff_sws_float_filter_init(&p->h_filter, &p->h_filter_pos,
+                                           &p->h_filter_size, filter, filter_pos,
+                                           filter_size, p->dst_w, 1 << 14, 1);
+        av_freep(&filter);
+        av_freep(&filter_pos);
+        if (ret < 0)
+            return ret;
+
+        inc = (((int64_t)p->src_h << 16) + (p->dst_h >> 1)) / p->dst_h;
+        ret = initFilter(&filter, &filter_pos, &filter_size, inc,
+                         p->src_h, p->dst_h, 1, 1 << 14, plane_flags, 0,
+                         chroma ? srcFilter->chrV : srcFilter->lumV,
+                         chroma ? dstFilter->chrV : dstFilter->lumV, c->param,
+                         get_local_pos(c, log2_h, chroma ? c->src_v_chr_pos : 0, 1),
+                         get_local_pos(c, log2_h, chroma ? c->dst_v_chr_pos : 0, 1));
+        if (ret >= 0)
+            ret = ff_sws_float_filter_init(&p->v_filter, &p->v_filter_pos,
+                                           &p->v_filter_size, filter, filter_pos,
+                                           filter_size, p->dst_h, 1 << 14, 0);
+        av_freep(&filter);
+        av_freep(&filter_pos);
+        if (ret < 0)
+            return ret;
+    }
+
+    return ff_sws_init_float_scaler(c);
+}
+
+static av_cold int context_init_single(SwsContext *c, SwsFilter *srcFilter,
+                                       SwsFilter *dstFilter)
 {
     int i;
     int usesVFilter, usesHFilter;
@@ -1166,7 +1322,6 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     const AVPixFmtDescriptor *desc_src;
     const AVPixFmtDescriptor *desc_dst;
     int ret = 0;
-    enum AVPixelFormat tmpFmt;
 
     cpu_flags = av_get_cpu_flags();
     flags     = c->flags;
@@ -1385,6 +1540,8 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
         srcFormat != AV_PIX_FMT_GBRP14BE  && srcFormat != AV_PIX_FMT_GBRP14LE &&
         srcFormat != AV_PIX_FMT_GBRP16BE  && srcFormat != AV_PIX_FMT_GBRP16LE &&
         srcFormat != AV_PIX_FMT_GBRAP16BE  && srcFormat != AV_PIX_FMT_GBRAP16LE &&
+        srcFormat != AV_PIX_FMT_GBRPF32BE  && srcFormat != AV_PIX_FMT_GBRPF32LE  &&
+        srcFormat != AV_PIX_FMT_GBRAPF32BE && srcFormat != AV_PIX_FMT_GBRAPF32LE &&
         ((dstW >> c->chrDstHSubSample) <= (srcW >> 1) ||
          (flags & SWS_FAST_BILINEAR)))
         c->chrSrcHSubSample = 1;
@@ -1405,6 +1562,11 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
         c->dstBpc = 8;
     if (isAnyRGB(srcFormat) || srcFormat == AV_PIX_FMT_PAL8)
         c->srcBpc = 16;
+    /* float formats are read and written through the 16-bit intermediate */
+    if (isFloat(srcFormat))
+        c->srcBpc = 16;
+    if (isFloat(dstFormat))
+        c->dstBpc = 16;
     if (c->dstBpc == 16)
         dst_stride <<= 1;
 
@@ -1446,66 +1608,71 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
         }
     }
 
-    // hardcoded for now
-    c->gamma_value = 2.2;
-    tmpFmt = AV_PIX_FMT_RGBA64LE;
-
-
-    if (!unscaled && c->gamma_flag && (srcFormat != tmpFmt || dstFormat != tmpFmt)) {
-        SwsContext *c2;
-        c->cascaded_context[0] = NULL;
+    if (!unscaled && c->gamma_flag) {
+        /* 8-bit formats can only carry 8-bit gamma encoded components */
+        int src_depth8 = desc_src->comp[0].depth <= 8;
+        int dst_depth8 = desc_dst->comp[0].depth <= 8;
+        enum AVPixelFormat linearFmt = isALPHA(srcFormat) && isALPHA(dstFormat) ?
+                                       AV_PIX_FMT_YUVA444P16 : AV_PIX_FMT_YUV444P16;
+
+        ff_sws_init_gamma_tables();
+        c->gamma_cascade   = 1;
+        c->gamma_srcFormat = src_depth8 ? AV_PIX_FMT_RGBA : AV_PIX_FMT_RGBA64;
+        c->gamma_dstFormat = dst_depth8 ? AV_PIX_FMT_RGBA : AV_PIX_FMT_RGBA64;
+
+        if (srcFormat != c->gamma_srcFormat) {
+            ret = av_image_alloc(c->gamma_tmp, c->gamma_tmpStride,
+                                 srcW, srcH, c->gamma_srcFormat, 64);
+            if (ret < 0)
+                return ret;
+            c->cascaded_context[0] = sws_getContext(srcW, srcH, srcFormat,
+                                                    srcW, srcH, c->gamma_srcFormat,
+                                                    flags, NULL, NULL, c->param);
+            if (!c->cascaded_context[0])
+                return -1;
+        }
 
+        /* the planes hold linear R, G, B and A, each scaled on its own */
         ret = av_image_alloc(c->cascaded_tmp, c->cascaded_tmpStride,
-                            srcW, srcH, tmpFmt, 64);
+                             srcW, srcH, linearFmt, 64);
         if (ret < 0)
             return ret;
-
-        c->cascaded_context[0] = sws_getContext(srcW, srcH, srcFormat,
-                                                srcW, srcH, tmpFmt,
-                                                flags, NULL, NULL, c->param);
-        if (!c->cascaded_context[0]) {
-            return -1;
-        }
-
-        c->cascaded_context[1] = sws_getContext(srcW, srcH, tmpFmt,
-                                                dstW, dstH, tmpFmt,
+        ret = av_image_alloc(c->cascaded1_tmp, c->cascaded1_tmpStride,
+                             dstW, dstH, linearFmt, 64);
+        if (ret < 0)
+            return ret;
+        c->cascaded_context[1] = sws_getContext(srcW, srcH, linearFmt,
+                                                dstW, dstH, linearFmt,
                                                 flags, srcFilter, dstFilter, c->param);
-
         if (!c->cascaded_context[1])
             return -1;
 
-        c2 = c->cascaded_context[1];
-        c2->is_internal_gamma = 1;
-        c2->gamma     = alloc_gamma_tbl(    c->gamma_value);
-        c2->inv_gamma = alloc_gamma_tbl(1.f/c->gamma_value);
-        if (!c2->gamma || !c2->inv_gamma)
-            return AVERROR(ENOMEM);
-
-        // is_internal_flag is set after creating the context
-        // to properly create the gamma convert FilterDescriptor
-        // we have to re-initialize it
-        ff_free_filters(c2);
-        if (ff_init_filters(c2) < 0) {
-            sws_freeContext(c2);
-            return -1;
-        }
-
-        c->cascaded_context[2] = NULL;
-        if (dstFormat != tmpFmt) {
-            ret = av_image_alloc(c->cascaded1_tmp, c->cascaded1_tmpStride,
-                                dstW, dstH, tmpFmt, 64);
+        if (dstFormat != c->gamma_dstFormat) {
+            ret = av_image_alloc(c->gamma1_tmp, c->gamma1_tmpStride,
+                                 dstW, dstH, c->gamma_dstFormat, 64);
             if (ret < 0)
                 return ret;
-
-            c->cascaded_context[2] = sws_getContext(dstW, dstH, tmpFmt,
-                                                dstW, dstH, dstFormat,
-                                                flags, NULL, NULL, c->param);
+            c->cascaded_context[2] = sws_getContext(dstW, dstH, c->gamma_dstFormat,
+                                                    dstW, dstH, dstFormat,
+                                                    flags, NULL, NULL, c->param);
             if (!c->cascaded_context[2])
                 return -1;
         }
         return 0;
     }
 
+    if (!unscaled && use_float_scaler(c)) {
+        ret = init_float_scaler(c, srcFilter, dstFilter);
+        if (ret != RETCODE_USE_CASCADE) {
+            if (ret >= 0 && (flags & SWS_PRINT_INFO))
+                av_log(c, AV_LOG_INFO, "using float scaler for %s -> %s\n",
+                       av_get_pix_fmt_name(srcFormat), av_get_pix_fmt_name(dstFormat));
+            return ret;
+        }
+        /* too large filters, go through the cascaded scaling */
+        ff_sws_free_float_scaler(c);
+    }
+
     if (isBayer(srcFormat)) {
         if (!unscaled ||
             (dstFormat != AV_PIX_FMT_RGB24 && dstFormat != AV_PIX_FMT_YUV420P)) {
@@ -1830,6 +1997,81 @@ fail: // FIXME replace things by appropriate error codes
     return -1;
 }
 
+static av_cold void free_slice_contexts(SwsContext *c)
+{
+    int i;
+
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        sws_freeContext(c->slice_ctx[i]);
+    av_freep(&c->slice_ctx);
+    c->nb_slice_ctx = 0;
+    avpriv_threadpool_client_free(&c->slice_pool);
+}
+
+av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
+                             SwsFilter *dstFilter)
+{
+    SwsContext **slice_ctx = NULL;
+    int i, ret, nb_slice_ctx = 0;
+
+    if (HAVE_THREADS && c->nb_threads != 1 && c->dstH > 0) {
+        nb_slice_ctx = c->nb_threads ? c->nb_threads : av_cpu_count();
+        /* do not bother with slices of less than 16 lines */
+        nb_slice_ctx = FFMIN(nb_slice_ctx, FFMAX(c->dstH / 16, 1));
+    }
+
+    /* The slice contexts are set up from the options as given by the user,
+     * before the context initialization adjusts them. */
+    if (nb_slice_ctx > 1) {
+        slice_ctx = av_mallocz_array(nb_slice_ctx, sizeof(*slice_ctx));
+        if (!slice_ctx)
+            return AVERROR(ENOMEM);
+        for (i = 0; i < nb_slice_ctx; i++) {
+            slice_ctx[i] = sws_alloc_context();
+            if (!slice_ctx[i] || av_opt_copy(slice_ctx[i], c) < 0) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+            slice_ctx[i]->nb_threads = 1;
+        }
+    }
+
+    ret = context_init_single(c, srcFilter, dstFilter);
+    if (ret < 0 || !slice_ctx)
+        goto fail;
+
+    /* Only the generic scaler computes each output line independently of the
+     * previous ones; error diffusion dithering carries state across lines. */
+    if (!c->desc || c->cascaded_context[0] || c->dither == SWS_DITHER_ED) {
+        ret = 0;
+        goto fail;
+    }
+
+    for (i = 0; i < nb_slice_ctx; i++) {
+        ret = context_init_single(slice_ctx[i], srcFilter, dstFilter);
+        if (ret < 0)
+            goto fail;
+    }
+
+    ret = avpriv_threadpool_client_alloc(&c->slice_pool, nb_slice_ctx);
+    if (ret < 0) {
+        ret = ret == AVERROR(ENOSYS) ? 0 : ret;
+        goto fail;
+    }
+
+    c->slice_ctx    = slice_ctx;
+    c->nb_slice_ctx = nb_slice_ctx;
+    return 0;
+
+fail:
+    if (slice_ctx) {
+        for (i = 0; i < nb_slice_ctx; i++)
+            sws_freeContext(slice_ctx[i]);
+        av_free(slice_ctx);
+    }
+    return ret;
+}
+
 SwsContext *sws_alloc_set_opts(int srcW, int srcH, enum AVPixelFormat srcFormat,
                                int dstW, int dstH, enum AVPixelFormat dstFormat,
                                int flags, const double *param)
@@ -2320,17 +2562,21 @@ void sws_freeContext(SwsContext *c)
     av_freep(&c->yuvTable);
     av_freep(&c->formatConvBuffer);
 
+    free_slice_contexts(c);
+
     sws_freeContext(c->cascaded_context[0]);
     sws_freeContext(c->cascaded_context[1]);
     sws_freeContext(c->cascaded_context[2]);
     memset(c->cascaded_context, 0, sizeof(c->cascaded_context));
     av_freep(&c->cascaded_tmp[0]);
     av_freep(&c->cascaded1_tmp[0]);
-
-    av_freep(&c->gamma);
-    av_freep(&c->inv_gamma);
+    av_freep(&c->slice_bounce);
+    av_freep(&c->cache_opts);
+    av_freep(&c->gamma_tmp[0]);
+    av_freep(&c->gamma1_tmp[0]);
 
     ff_free_filters(c);
+    ff_sws_free_float_scaler(c);
 
     av_free(c);
 }
@@ -2347,6 +2593,7 @@ struct SwsContext *sws_getCachedContext(struct SwsContext *context, int srcW,
                                              SWS_PARAM_DEFAULT };
     int64_t src_h_chr_pos = -513, dst_h_chr_pos = -513,
             src_v_chr_pos = -513, dst_v_chr_pos = -513;
+    int64_t threads = 1;
 
     if (!param)
         param = default_param;
@@ -2366,11 +2613,30 @@ struct SwsContext *sws_getCachedContext(struct SwsContext *context, int srcW,
         av_opt_get_int(context, "src_v_chr_pos", 0, &src_v_chr_pos);
         av_opt_get_int(context, "dst_h_chr_pos", 0, &dst_h_chr_pos);
         av_opt_get_int(context, "dst_v_chr_pos", 0, &dst_v_chr_pos);
-        sws_freeContext(context);
+        av_opt_get_int(context, "threads",       0, &threads);
+        ff_sws_context_cache_put(context);
         context = NULL;
     }
 
     if (!context) {
+        SwsContextKey key = {
+            .srcW      = srcW,
+            .srcH      = srcH,
+            .srcFormat = srcFormat,
+            .dstW      = dstW,
+            .dstH      = dstH,
+            .dstFormat = dstFormat,
+            .flags     = flags,
+            .param     = { param[0], param[1] },
+            .chr_pos   = { src_h_chr_pos, src_v_chr_pos,
+                           dst_h_chr_pos, dst_v_chr_pos },
+            .threads   = threads,
+        };
+
+        if (!srcFilter && !dstFilter &&
+            (context = ff_sws_context_cache_get(&key)))
+            return context;
+
         if (!(context = sws_alloc_context()))
             return NULL;
         context->srcW      = srcW;
@@ -2387,11 +2653,17 @@ struct SwsContext *sws_getCachedContext(struct SwsContext *context, int srcW,
         av_opt_set_int(context, "src_v_chr_pos", src_v_chr_pos, 0);
         av_opt_set_int(context, "dst_h_chr_pos", dst_h_chr_pos, 0);
         av_opt_set_int(context, "dst_v_chr_pos", dst_v_chr_pos, 0);
+        av_opt_set_int(context, "threads",       threads,       0);
 
         if (sws_init_context(context, srcFilter, dstFilter) < 0) {
             sws_freeContext(context);
             return NULL;
         }
+
+        context->cache_key = key;
+        context->cacheable = !srcFilter && !dstFilter &&
+                             av_opt_serialize(context, 0, 0, &context->cache_opts,
+                                              '=', ':') >= 0;
     }
     return context;
 }
@@ -28,10 +28,52 @@
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/dict.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/thread.h" // not public
 
-uint8_t *slice_byte_buffer;
-uint8_t slice_byte_buffer_size;
-int draw_horiz_band_called;
+#define MAX_DRAWN_FRAMES 16
+
+/* With frame threading, the decoding threads draw the bands of several
+ * frames at the same time, so the bands are collected per frame, by the
+ * address of its first plane, which the output frame shares. */
+typedef struct DrawnFrame {
+    const uint8_t *data;
+    uint8_t *buf;
+} DrawnFrame;
+
+static DrawnFrame drawn_frames[MAX_DRAWN_FRAMES];
+static int slice_byte_buffer_size;
+static int too_many_drawn_frames;
+static AVMutex drawn_frames_lock;
+
+static DrawnFrame *find_drawn_frame(const uint8_t *data)
+{
+    int i;
+
+    for (i = 0; i < MAX_DRAWN_FRAMES; i++)
+        if (drawn_frames[i].data == data)
+            return &drawn_frames[i];
+    return NULL;
+}
+
+static DrawnFrame *get_drawn_frame(const uint8_t *data)
+{
+    DrawnFrame *df = find_drawn_frame(data);
+
+    if (!df) {
+        df = find_drawn_frame(NULL);
+        if (!df)
+            return NULL;
+        if (!df->buf) {
+            df->buf = av_mallocz(slice_byte_buffer_size);
+            if (!df->buf)
+                return NULL;
+        }
+        df->data = data;
+    }
+    return df;
+}
 
 static void draw_horiz_band(AVCodecContext *ctx, const AVFrame *fr, int offset[4],
                             int slice_position, int type, int height)
@@ -41,8 +83,17 @@ static void draw_horiz_band(AVCodecContext *ctx, const AVFrame *fr, int offset[4
     int chroma_w, chroma_h;
     int shift_slice_position;
     int shift_height;
+    uint8_t *slice_byte_buffer;
+    DrawnFrame *df;
 
-    draw_horiz_band_called = 1;
+    ff_mutex_lock(&drawn_frames_lock);
+    df = get_drawn_frame(fr->data[0]);
+    if (!df) {
+        too_many_drawn_frames = 1;
+        ff_mutex_unlock(&drawn_frames_lock);
+        return;
+    }
+    slice_byte_buffer = df->buf;
 
     pix_fmt_desc = av_pix_fmt_desc_get(ctx->pix_fmt);
     chroma_w = -((-ctx->width) >> pix_fmt_desc->log2_chroma_w);
@@ -62,9 +113,10 @@ static void draw_horiz_band(AVCodecContext *ctx, const AVFrame *fr, int offset[4
         memcpy(slice_byte_buffer + ctx->width * ctx->height + chroma_w * shift_height + chroma_w * shift_slice_position + i * chroma_w,
                fr->data[2] + offset[2] + i * fr->linesize[2], chroma_w);
     }
+    ff_mutex_unlock(&drawn_frames_lock);
 }
 
-static int video_decode(const char *input_filename)
+static int video_decode(const char *input_filename, AVDictionary **opts)
 {
     AVCodec *codec = NULL;
     AVCodecContext *ctx= NULL;
@@ -73,14 +125,20 @@ static int video_decode(const char *input_filename)
     AVFrame *fr = NULL;
     AVPacket pkt;
     AVFormatContext *fmt_ctx = NULL;
+    const AVPixFmtDescriptor *desc;
     int number_of_written_bytes;
     int video_stream;
     int got_frame = 0;
     int byte_buffer_size;
     int result;
     int end_of_stream = 0;
+    DrawnFrame *df;
+    int i;
 
-    draw_horiz_band_called = 0;
+    if (ff_mutex_init(&drawn_frames_lock, NULL)) {
+        av_log(NULL, AV_LOG_ERROR, "Can't initialize mutex\n");
+        return -1;
+    }
 
     result = avformat_open_input(&fmt_ctx, input_filename, NULL, NULL);
     if (result < 0) {
@@ -123,7 +181,7 @@ static int video_decode(const char *input_filename)
     ctx->draw_horiz_band = draw_horiz_band;
     ctx->thread_count = 1;
 
-    result = avcodec_open2(ctx, codec, NULL);
+    result = avcodec_open2(ctx, codec, opts);
     if (result < 0) {
         av_log(ctx, AV_LOG_ERROR, "Can't open decoder\n");
         return result;
@@ -135,8 +193,11 @@ static int video_decode(const char *input_filename)
         return AVERROR(ENOMEM);
     }
 
-    if (strcmp(codec->name, "flv") && strcmp(codec->name, "mpeg4") && strcmp(codec->name, "huffyuv")) {
-        av_log(NULL, AV_LOG_ERROR, "Wrong codec\n");
+    /* draw_horiz_band() only copies 8 bit planar YUV */
+    desc = av_pix_fmt_desc_get(ctx->pix_fmt);
+    if (!desc || desc->nb_components != 3 || !(desc->flags & AV_PIX_FMT_FLAG_PLANAR) ||
+        desc->flags & AV_PIX_FMT_FLAG_RGB || desc->comp[0].depth > 8) {
+        av_log(NULL, AV_LOG_ERROR, "Unsupported pixel format\n");
         return -1;
     }
 
@@ -147,12 +208,6 @@ static int video_decode(const char *input_filename)
         return AVERROR(ENOMEM);
     }
 
-    slice_byte_buffer = av_malloc(byte_buffer_size);
-    if (!slice_byte_buffer) {
-        av_log(NULL, AV_LOG_ERROR, "Can't allocate buffer\n");
-        return AVERROR(ENOMEM);
-    }
-    memset(slice_byte_buffer, 0, byte_buffer_size);
     slice_byte_buffer_size = byte_buffer_size;
 
     av_init_packet(&pkt);
@@ -181,15 +236,27 @@ static int video_decode(const char *input_filename)
                     av_log(NULL, AV_LOG_ERROR, "Can't copy image to buffer\n");
                     return number_of_written_bytes;
                 }
-                if (draw_horiz_band_called == 0) {
+                ff_mutex_lock(&drawn_frames_lock);
+                if (too_many_drawn_frames) {
+                    ff_mutex_unlock(&drawn_frames_lock);
+                    av_log(NULL, AV_LOG_ERROR, "Can't collect the bands of a frame\n");
+                    return -1;
+                }
+                df = find_drawn_frame(fr->data[0]);
+                if (!df) {
+                    ff_mutex_unlock(&drawn_frames_lock);
                     av_log(NULL, AV_LOG_ERROR, "draw_horiz_band haven't been called!\n");
                     return -1;
                 }
                 if (av_adler32_update(0, (const uint8_t*)byte_buffer, number_of_written_bytes) !=
-                    av_adler32_update(0, (const uint8_t*)slice_byte_buffer, number_of_written_bytes)) {
+                    av_adler32_update(0, (const uint8_t*)df->buf, number_of_written_bytes)) {
+                    ff_mutex_unlock(&drawn_frames_lock);
                     av_log(NULL, AV_LOG_ERROR, "Decoded frames with and without draw_horiz_band are not the same!\n");
                     return -1;
                 }
+                /* each output frame must be drawn */
+                df->data = NULL;
+                ff_mutex_unlock(&drawn_frames_lock);
             }
             av_packet_unref(&pkt);
             av_init_packet(&pkt);
@@ -202,21 +269,34 @@ static int video_decode(const char *input_filename)
     avformat_close_input(&fmt_ctx);
     avcodec_free_context(&ctx);
     av_freep(&byte_buffer);
-    av_freep(&slice_byte_buffer);
+    for (i = 0; i < MAX_DRAWN_FRAMES; i++)
+        av_freep(&drawn_frames[i].buf);
+    ff_mutex_destroy(&drawn_frames_lock);
     return 0;
 }
 
 int main(int argc, char **argv)
 {
+    AVDictionary *opts = NULL;
+    int ret;
+
     if (argc < 2)
     {
-        av_log(NULL, AV_LOG_ERROR, "Incorrect input: expected %s <name of a video file>\nNote that test works only for huffyuv, flv and mpeg4 decoders\n", argv[0]);
+        av_log(NULL, AV_LOG_ERROR, "Incorrect input: expected %s <name of a video file> [<threads> <thread_type>]\n"
+               "Note that test works only for 8 bit planar YUV and decoders which do not reorder frames\n", argv[0]);
         return 1;
     }
 
+    if (argc > 2)
+        av_dict_set(&opts, "threads", argv[2], 0);
+    if (argc > 3)
+        av_dict_set(&opts, "thread_type", argv[3], 0);
+
     av_register_all();
 
-    if (video_decode(argv[1]) != 0)
+    ret = video_decode(argv[1], &opts);
+    av_dict_free(&opts);
+    if (ret != 0)
         return 1;
 
     return 0;
@@ -28,8 +28,9 @@
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/dict.h"
 
-static int video_decode_example(const char *input_filename)
+static int video_decode_example(const char *input_filename, AVDictionary **opts)
 {
     AVCodec *codec = NULL;
     AVCodecContext *ctx= NULL;
@@ -84,7 +85,7 @@ static int video_decode_example(const char *input_filename)
         return result;
     }
 
-    result = avcodec_open2(ctx, codec, NULL);
+    result = avcodec_open2(ctx, codec, opts);
     if (result < 0) {
         av_log(ctx, AV_LOG_ERROR, "Can't open decoder\n");
         return result;
@@ -152,15 +153,26 @@ static int video_decode_example(const char *input_filename)
 
 int main(int argc, char **argv)
 {
+    AVDictionary *opts = NULL;
+    int ret;
+
     if (argc < 2)
     {
         av_log(NULL, AV_LOG_ERROR, "Incorrect input\n");
         return 1;
     }
 
+    /* optional threading setup, the output must not depend on it */
+    if (argc > 2)
+        av_dict_set(&opts, "threads", argv[2], 0);
+    if (argc > 3)
+        av_dict_set(&opts, "thread_type", argv[3], 0);
+
     av_register_all();
 
-    if (video_decode_example(argv[1]) != 0)
+    ret = video_decode_example(argv[1], &opts);
+    av_dict_free(&opts);
+    if (ret != 0)
         return 1;
 
     return 0;
@@ -0,0 +1,267 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#include "checkasm.h"
+
+#define MAX_WIDTH            512
+#define MAX_TEST_FILTER_SIZE 40
+#define MAX_VFILTER_SIZE     16
+#define DST_SIZE             (MAX_WIDTH * 2 + 64)
+
+/* widths that are and are not multiples of the SIMD loop steps */
+static const int widths[] = { 8, 16, 24, 48, 128, 144, 256, 512 };
+
+/* a context for the generic scaler with the given output format, whose
+ * function pointers are then set up again with ff_getSwsFunc() */
+static SwsContext *alloc_context(enum AVPixelFormat dst_fmt)
+{
+    return sws_getContext(MAX_WIDTH / 2, 16, AV_PIX_FMT_YUV420P,
+                          MAX_WIDTH, 32, dst_fmt,
+                          SWS_BILINEAR | SWS_ACCURATE_RND, NULL, NULL, NULL);
+}
+
+static void check_hscale(void)
+{
+    static const int filter_sizes[] = { 4, 8, 12, 16, 32, 40 };
+    static const int dst_bpc[] = { 8, 16 };
+    LOCAL_ALIGNED_32(uint8_t, src, [MAX_WIDTH + MAX_TEST_FILTER_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst0, [MAX_WIDTH]);
+    LOCAL_ALIGNED_32(int32_t, dst1, [MAX_WIDTH]);
+    LOCAL_ALIGNED_32(int16_t, filter, [MAX_WIDTH * MAX_TEST_FILTER_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, filter_pos, [MAX_WIDTH]);
+    SwsContext *c = alloc_context(AV_PIX_FMT_YUV420P);
+    int i, j, b, f, w;
+
+    /* the output is either int16_t or int32_t */
+    declare_func_emms(AV_CPU_FLAG_MMX, void, SwsContext *c, int16_t *dst, int dstW,
+                      const uint8_t *src, const int16_t *filter,
+                      const int32_t *filterPos, int filterSize);
+
+    if (!c) {
+        fail();
+        return;
+    }
+
+    for (i = 0; i < MAX_WIDTH + MAX_TEST_FILTER_SIZE; i++)
+        src[i] = rnd();
+
+    for (b = 0; b < FF_ARRAY_ELEMS(dst_bpc); b++) {
+        for (f = 0; f < FF_ARRAY_ELEMS(filter_sizes); f++) {
+            for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                int filter_size = filter_sizes[f];
+                int dst_w = widths[w];
+
+                /* the filters are aligned to 8 on other architectures */
+                if (!ARCH_X86 && filter_size & 7)
+                    continue;
+
+                for (i = 0; i < dst_w; i++) {
+                    filter_pos[i] = rnd() % MAX_WIDTH;
+                    /* negative coefficients, and a large one to reach the
+                     * clipping of the output */
+                    for (j = 0; j < filter_size; j++)
+                        filter[i * filter_size + j] = -((1 << 14) / (filter_size - 1));
+                    filter[i * filter_size + rnd() % filter_size] = (1 << 15) - 1;
+                }
+
+                c->srcBpc = 8;
+                c->dstBpc = dst_bpc[b];
+                c->hLumFilterSize = c->hChrFilterSize = filter_size;
+                c->dstW = c->chrDstW = dst_w;
+                ff_getSwsFunc(c);
+
+                if (check_func(c->hcScale, "hscale_8_to_%d_fs_%d_w_%d",
+                               c->dstBpc <= 14 ? 15 : 19, filter_size, dst_w)) {
+                    memset(dst0, 0, MAX_WIDTH * sizeof(*dst0));
+                    memset(dst1, 0, MAX_WIDTH * sizeof(*dst1));
+
+                    call_ref(c, (int16_t *)dst0, dst_w, src, filter, filter_pos, filter_size);
+                    call_new(c, (int16_t *)dst1, dst_w, src, filter, filter_pos, filter_size);
+                    if (memcmp(dst0, dst1, dst_w * (c->dstBpc <= 14 ? 2 : 4)))
+                        fail();
+                    bench_new(c, (int16_t *)dst1, dst_w, src, filter, filter_pos, filter_size);
+                }
+            }
+        }
+    }
+
+    sws_freeContext(c);
+}
+
+static void check_yuv2plane1(void)
+{
+    static const enum AVPixelFormat formats[] = {
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P9LE,
+        AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P16LE,
+    };
+    LOCAL_ALIGNED_32(int32_t, src, [MAX_WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_SIZE]);
+    LOCAL_ALIGNED_8(uint8_t, dither, [8]);
+    int i, fmt, w, offset, misalign;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const int16_t *src, uint8_t *dst, int dstW,
+                      const uint8_t *dither, int offset);
+
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd();
+
+    for (fmt = 0; fmt < FF_ARRAY_ELEMS(formats); fmt++) {
+        SwsContext *c = alloc_context(formats[fmt]);
+        int bits;
+
+        if (!c) {
+            fail();
+            return;
+        }
+        bits = av_pix_fmt_desc_get(formats[fmt])->comp[0].depth;
+
+        /* 15 bits in int16_t, 19 bits in int32_t for 16-bit output; the
+         * range leaves room for the rounding of the saturating adds */
+        if (bits == 16) {
+            for (i = 0; i < MAX_WIDTH; i++)
+                src[i] = (int32_t)(rnd() & 0xfffff) - 0x40000;
+        } else {
+            int16_t *src16 = (int16_t *)src;
+            for (i = 0; i < MAX_WIDTH * 2; i++)
+                src16[i] = (int)(rnd() & 0x7fff) - 0x100;
+        }
+
+        /* the SIMD versions have separate loops for unaligned output */
+        for (misalign = 0; misalign <= 1; misalign++) {
+            int pixel_size = bits > 8 ? 2 : 1;
+            uint8_t *out0 = dst0 + misalign * pixel_size;
+            uint8_t *out1 = dst1 + misalign * pixel_size;
+
+            for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                for (offset = 0; offset <= 3; offset += 3) {
+                    int dst_w = widths[w];
+
+                    if (check_func(c->yuv2plane1, "yuv2plane1_%d_w_%d_off_%d%s", bits,
+                                   dst_w, offset, misalign ? "_unaligned" : "")) {
+                        memset(dst0, 0, DST_SIZE);
+                        memset(dst1, 0, DST_SIZE);
+
+                        call_ref((const int16_t *)src, out0, dst_w, dither, offset);
+                        call_new((const int16_t *)src, out1, dst_w, dither, offset);
+                        if (memcmp(out0, out1, dst_w * pixel_size))
+                            fail();
+                        bench_new((const int16_t *)src, out1, dst_w, dither, offset);
+                    }
+                }
+            }
+        }
+
+        sws_freeContext(c);
+    }
+}
+
+static void check_yuv2planeX(void)
+{
+    static const enum AVPixelFormat formats[] = {
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P9LE, AV_PIX_FMT_YUV420P10LE,
+    };
+    static const int filter_sizes[] = { 2, 4, 8, 16 };
+    LOCAL_ALIGNED_32(int16_t, src_pixels, [MAX_VFILTER_SIZE * MAX_WIDTH]);
+    LOCAL_ALIGNED_32(int16_t, filter, [MAX_VFILTER_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_SIZE]);
+    LOCAL_ALIGNED_8(uint8_t, dither, [8]);
+    const int16_t *src[MAX_VFILTER_SIZE];
+    int i, j, fmt, f, w, offset, misalign;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const int16_t *filter, int filterSize,
+                      const int16_t **src, uint8_t *dst, int dstW,
+                      const uint8_t *dither, int offset);
+
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd();
+    for (i = 0; i < MAX_VFILTER_SIZE * MAX_WIDTH; i++)
+        src_pixels[i] = rnd() & 0x7fff;
+    for (i = 0; i < MAX_VFILTER_SIZE; i++)
+        src[i] = src_pixels + i * MAX_WIDTH;
+
+    for (fmt = 0; fmt < FF_ARRAY_ELEMS(formats); fmt++) {
+        SwsContext *c = alloc_context(formats[fmt]);
+        int bits;
+
+        if (!c) {
+            fail();
+            return;
+        }
+        bits = av_pix_fmt_desc_get(formats[fmt])->comp[0].depth;
+
+        for (f = 0; f < FF_ARRAY_ELEMS(filter_sizes); f++) {
+            int filter_size = filter_sizes[f];
+            int sum = 0;
+
+            /* 12-bit coefficients summing to 1 << 12, some of them negative */
+            for (j = 0; j < filter_size - 1; j++) {
+                filter[j] = (int)(rnd() % 2048) - 512;
+                sum += filter[j];
+            }
+            filter[filter_size - 1] = 4096 - sum;
+
+            for (misalign = 0; misalign <= 1; misalign++) {
+                int pixel_size = bits > 8 ? 2 : 1;
+                uint8_t *out0 = dst0 + misalign * pixel_size;
+                uint8_t *out1 = dst1 + misalign * pixel_size;
+
+                for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                    for (offset = 0; offset <= 3; offset += 3) {
+                        int dst_w = widths[w];
+
+                        if (check_func(c->yuv2planeX, "yuv2planeX_%d_fs_%d_w_%d_off_%d%s",
+                                       bits, filter_size, dst_w, offset,
+                                       misalign ? "_unaligned" : "")) {
+                            memset(dst0, 0, DST_SIZE);
+                            memset(dst1, 0, DST_SIZE);
+
+                            call_ref(filter, filter_size, src, out0, dst_w, dither, offset);
+                            call_new(filter, filter_size, src, out1, dst_w, dither, offset);
+                            if (memcmp(out0, out1, dst_w * pixel_size))
+                                fail();
+                            bench_new(filter, filter_size, src, out1, dst_w, dither, offset);
+                        }
+                    }
+                }
+            }
+        }
+
+        sws_freeContext(c);
+    }
+}
+
+void checkasm_check_sw_scale(void)
+{
+    check_hscale();
+    report("hscale");
+    check_yuv2plane1();
+    report("yuv2plane1");
+    check_yuv2planeX();
+    report("yuv2planeX");
+}
@@ -243,6 +243,7 @@ pixfmts(){
     filter_args=$1
     prefilter_chain=$2
     nframes=${3:-1}
+    extra_args=$4
 
     showfiltfmts="$target_exec $target_path/libavfilter/tests/filtfmts"
     scale_exclude_fmts=${outfile}_scale_exclude_fmts
@@ -261,7 +262,7 @@ pixfmts(){
     outertest=$test
     for pix_fmt in $pix_fmts; do
         test=$pix_fmt
-        video_filter "${prefilter_chain}format=$pix_fmt,$filter=$filter_args" -pix_fmt $pix_fmt -frames:v $nframes
+        video_filter "${prefilter_chain}format=$pix_fmt,$filter=$filter_args" -pix_fmt $pix_fmt -frames:v $nframes $extra_args
     done
 
     rm $in_fmts $scale_in_fmts $scale_out_fmts $scale_exclude_fmts
@@ -10,10 +10,57 @@ fate-api-band: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/mpeg4/re
 fate-api-band: CMP = null
 fate-api-band: REF = /dev/null
 
+# bands drawn by the decoders with loop filters, without threads and with
+# slice or frame threads, must match the output frames
+FATE_API_BAND-$(call DEMDEC, H264, H264) += fate-api-band-h264
+fate-api-band-h264: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/h264-conformance/SVA_NL2_E.264
+
+FATE_API_BAND-$(call DEMDEC, H264, H264) += fate-api-band-h264-slice-threads
+fate-api-band-h264-slice-threads: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/h264-conformance/BA1_FT_C.264 4 slice
+
+FATE_API_BAND-$(call DEMDEC, H264, H264) += fate-api-band-h264-frame-threads
+fate-api-band-h264-frame-threads: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/h264-conformance/SVA_NL2_E.264 4 frame
+
+FATE_API_BAND-$(call DEMDEC, HEVC, HEVC) += fate-api-band-hevc
+fate-api-band-hevc: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/hevc-conformance/CONFWIN_A_Sony_1.bit
+
+FATE_API_BAND-$(call DEMDEC, HEVC, HEVC) += fate-api-band-hevc-slice-threads
+fate-api-band-hevc-slice-threads: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/hevc-conformance/CONFWIN_A_Sony_1.bit 4 slice
+
+FATE_API_BAND-$(call DEMDEC, HEVC, HEVC) += fate-api-band-hevc-frame-threads
+fate-api-band-hevc-frame-threads: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/hevc-conformance/CONFWIN_A_Sony_1.bit 4 frame
+
+FATE_API_BAND-$(call DEMDEC, IVF, VP8) += fate-api-band-vp8
+fate-api-band-vp8: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/vp8-test-vectors-r1/vp80-00-comprehensive-001.ivf
+
+FATE_API_BAND-$(call DEMDEC, IVF, VP8) += fate-api-band-vp8-frame-threads
+fate-api-band-vp8-frame-threads: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/vp8-test-vectors-r1/vp80-00-comprehensive-001.ivf 4 frame
+
+FATE_API_BAND-$(call DEMDEC, MATROSKA, VP9) += fate-api-band-vp9
+fate-api-band-vp9: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/vp9-test-vectors/vp90-2-00-quantizer-00.webm
+
+FATE_API_BAND-$(call DEMDEC, MATROSKA, VP9) += fate-api-band-vp9-slice-threads
+fate-api-band-vp9-slice-threads: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/vp9-test-vectors/vp90-2-tiling-pedestrian.webm 4 slice
+
+FATE_API_BAND-$(call DEMDEC, MATROSKA, VP9) += fate-api-band-vp9-frame-threads
+fate-api-band-vp9-frame-threads: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/vp9-test-vectors/vp90-2-tiling-pedestrian.webm 4 frame
+
+$(FATE_API_BAND-yes): $(APITESTSDIR)/api-band-test$(EXESUF)
+$(FATE_API_BAND-yes): CMP = null
+$(FATE_API_BAND-yes): REF = /dev/null
+FATE_API_SAMPLES_LIBAVFORMAT-yes += $(FATE_API_BAND-yes)
+
 FATE_API_SAMPLES_LIBAVFORMAT-$(call DEMDEC, H264, H264) += fate-api-h264
 fate-api-h264: $(APITESTSDIR)/api-h264-test$(EXESUF)
 fate-api-h264: CMD = run $(APITESTSDIR)/api-h264-test $(TARGET_SAMPLES)/h264-conformance/SVA_NL2_E.264
 
+# low delay frame threads must return the same frames and timestamps as a
+# single thread
+FATE_API_SAMPLES_LIBAVFORMAT-$(call DEMDEC, H264, H264) += fate-api-h264-low-delay-threads
+fate-api-h264-low-delay-threads: $(APITESTSDIR)/api-h264-test$(EXESUF)
+fate-api-h264-low-delay-threads: CMD = run $(APITESTSDIR)/api-h264-test $(TARGET_SAMPLES)/h264-conformance/SVA_NL2_E.264 4 frame_low_delay
+fate-api-h264-low-delay-threads: REF = $(SRC_PATH)/tests/ref/fate/api-h264
+
 FATE_API_LIBAVFORMAT-$(call DEMDEC, FLV, FLV) += fate-api-seek
 fate-api-seek: $(APITESTSDIR)/api-seek-test$(EXESUF) fate-lavf-flv_fmt
 fate-api-seek: CMD = run $(APITESTSDIR)/api-seek-test $(TARGET_PATH)/tests/data/lavf/lavf.flv 0 720
@@ -8,6 +8,10 @@ fate-filter-owdenoise-sample: CMP = oneoff
 FATE_FILTER_SAMPLES-$(call ALLYES, PERMS_FILTER DELOGO_FILTER RM_DEMUXER RV30_DECODER) += fate-filter-delogo
 fate-filter-delogo: CMD = framecrc -i $(TARGET_SAMPLES)/real/rv30.rm -vf perms=random,delogo=show=0:x=290:y=25:w=26:h=16 -an
 
+FATE_FILTER_SAMPLES-$(call ALLYES, PERMS_FILTER DELOGO_FILTER RM_DEMUXER RV30_DECODER) += fate-filter-delogo-threads
+fate-filter-delogo-threads: CMD = framecrc -filter_threads 4 -i $(TARGET_SAMPLES)/real/rv30.rm -vf perms=random,delogo=show=0:x=290:y=25:w=26:h=16 -an
+fate-filter-delogo-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-delogo
+
 FATE_YADIF += fate-filter-yadif-mode0
 fate-filter-yadif-mode0: CMD = framecrc -flags bitexact -idct simple -i $(TARGET_SAMPLES)/mpeg2/mpeg2_field_encoding.ts -frames:v 30 -vf yadif=0
 
@@ -98,6 +102,17 @@ fate-filter-colorchannelmixer: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf format=r
 FATE_FILTER_VSYNTH-$(CONFIG_DRAWBOX_FILTER) += fate-filter-drawbox
 fate-filter-drawbox: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf drawbox=224:24:88:72:red@0.5
 
+FATE_FILTER_VSYNTH-$(CONFIG_DRAWBOX_FILTER) += fate-filter-drawbox-threads
+fate-filter-drawbox-threads: CMD = framecrc -filter_threads 4 -c:v pgmyuv -i $(SRC) -vf drawbox=224:24:88:72:red@0.5
+fate-filter-drawbox-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-drawbox
+
+FATE_FILTER_VSYNTH-$(CONFIG_EQ_FILTER) += fate-filter-eq
+fate-filter-eq: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf eq=contrast=1.5:brightness=-0.1:saturation=1.3:gamma=1.2:gamma_r=0.9
+
+FATE_FILTER_VSYNTH-$(CONFIG_EQ_FILTER) += fate-filter-eq-threads
+fate-filter-eq-threads: CMD = framecrc -filter_threads 4 -c:v pgmyuv -i $(SRC) -vf eq=contrast=1.5:brightness=-0.1:saturation=1.3:gamma=1.2:gamma_r=0.9
+fate-filter-eq-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-eq
+
 FATE_FILTER_VSYNTH-$(CONFIG_FADE_FILTER) += fate-filter-fade
 fate-filter-fade: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf fade=in:5:15,fade=out:30:15
 
@@ -120,6 +135,10 @@ fate-filter-gradfun: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf gradfun
 FATE_FILTER_VSYNTH-$(CONFIG_HQDN3D_FILTER) += fate-filter-hqdn3d
 fate-filter-hqdn3d: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf hqdn3d
 
+FATE_FILTER_VSYNTH-$(CONFIG_HQDN3D_FILTER) += fate-filter-hqdn3d-threads
+fate-filter-hqdn3d-threads: CMD = framecrc -filter_threads 4 -c:v pgmyuv -i $(SRC) -vf hqdn3d
+fate-filter-hqdn3d-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-hqdn3d
+
 FATE_FILTER_VSYNTH-$(CONFIG_INTERLACE_FILTER) += fate-filter-interlace
 fate-filter-interlace: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf interlace
 
@@ -129,6 +148,10 @@ fate-filter-interlace-complex: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf interlac
 FATE_FILTER_VSYNTH-$(call ALLYES, NEGATE_FILTER PERMS_FILTER) += fate-filter-negate
 fate-filter-negate: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf perms=random,negate
 
+FATE_FILTER_VSYNTH-$(call ALLYES, NEGATE_FILTER PERMS_FILTER) += fate-filter-negate-threads
+fate-filter-negate-threads: CMD = framecrc -filter_threads 4 -c:v pgmyuv -i $(SRC) -vf perms=random,negate
+fate-filter-negate-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-negate
+
 FATE_FILTER_VSYNTH-$(CONFIG_HISTOGRAM_FILTER) += fate-filter-histogram-levels
 fate-filter-histogram-levels: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf histogram -flags +bitexact -sws_flags +accurate_rnd+bitexact
 
@@ -182,15 +205,40 @@ FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_F
 fate-filter-overlay_rgb: tests/data/filtergraphs/overlay_rgb
 fate-filter-overlay_rgb: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_rgb
 
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_rgb-threads
+fate-filter-overlay_rgb-threads: tests/data/filtergraphs/overlay_rgb
+fate-filter-overlay_rgb-threads: CMD = framecrc -filter_complex_threads 4 -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_rgb
+fate-filter-overlay_rgb-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-overlay_rgb
+
 FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_yuv420
 fate-filter-overlay_yuv420: tests/data/filtergraphs/overlay_yuv420
 fate-filter-overlay_yuv420: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuv420
 
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_yuv420-threads
+fate-filter-overlay_yuv420-threads: tests/data/filtergraphs/overlay_yuv420
+fate-filter-overlay_yuv420-threads: CMD = framecrc -filter_complex_threads 4 -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuv420
+fate-filter-overlay_yuv420-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-overlay_yuv420
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_yuv420-branch
+fate-filter-overlay_yuv420-branch: tests/data/filtergraphs/overlay_yuv420
+fate-filter-overlay_yuv420-branch: CMD = framecrc -filter_thread_type branch -filter_complex_threads 4 -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuv420
+fate-filter-overlay_yuv420-branch: REF = $(SRC_PATH)/tests/ref/fate/filter-overlay_yuv420
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_yuv420-pipeline
+fate-filter-overlay_yuv420-pipeline: tests/data/filtergraphs/overlay_yuv420
+fate-filter-overlay_yuv420-pipeline: CMD = framecrc -filter_thread_type pipeline -filter_complex_threads 4 -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuv420
+fate-filter-overlay_yuv420-pipeline: REF = $(SRC_PATH)/tests/ref/fate/filter-overlay_yuv420
+
 FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_nv12
 fate-filter-overlay_nv12: tests/data/filtergraphs/overlay_nv12
 fate-filter-overlay_nv12: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_nv12
 fate-filter-overlay_nv12: REF = $(SRC_PATH)/tests/ref/fate/filter-overlay_yuv420
 
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_nv12-threads
+fate-filter-overlay_nv12-threads: tests/data/filtergraphs/overlay_nv12
+fate-filter-overlay_nv12-threads: CMD = framecrc -filter_complex_threads 4 -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_nv12
+fate-filter-overlay_nv12-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-overlay_yuv420
+
 FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_nv21
 fate-filter-overlay_nv21: tests/data/filtergraphs/overlay_nv21
 fate-filter-overlay_nv21: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_nv21
@@ -204,6 +252,33 @@ FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_F
 fate-filter-overlay_yuv444: tests/data/filtergraphs/overlay_yuv444
 fate-filter-overlay_yuv444: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuv444
 
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER COLORCHANNELMIXER_FILTER) += fate-filter-overlay_yuv420_alpha
+fate-filter-overlay_yuv420_alpha: tests/data/filtergraphs/overlay_yuv420_alpha
+fate-filter-overlay_yuv420_alpha: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuv420_alpha
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER COLORCHANNELMIXER_FILTER) += fate-filter-overlay_yuv420_alpha-threads
+fate-filter-overlay_yuv420_alpha-threads: tests/data/filtergraphs/overlay_yuv420_alpha
+fate-filter-overlay_yuv420_alpha-threads: CMD = framecrc -filter_complex_threads 4 -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuv420_alpha
+fate-filter-overlay_yuv420_alpha-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-overlay_yuv420_alpha
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER COLORCHANNELMIXER_FILTER) += fate-filter-overlay_yuva420
+fate-filter-overlay_yuva420: tests/data/filtergraphs/overlay_yuva420
+fate-filter-overlay_yuva420: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuva420
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER COLORCHANNELMIXER_FILTER) += fate-filter-overlay_yuva420-threads
+fate-filter-overlay_yuva420-threads: tests/data/filtergraphs/overlay_yuva420
+fate-filter-overlay_yuva420-threads: CMD = framecrc -filter_complex_threads 4 -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuva420
+fate-filter-overlay_yuva420-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-overlay_yuva420
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER COLORCHANNELMIXER_FILTER) += fate-filter-overlay_rgba
+fate-filter-overlay_rgba: tests/data/filtergraphs/overlay_rgba
+fate-filter-overlay_rgba: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_rgba
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER COLORCHANNELMIXER_FILTER) += fate-filter-overlay_rgba-threads
+fate-filter-overlay_rgba-threads: tests/data/filtergraphs/overlay_rgba
+fate-filter-overlay_rgba-threads: CMD = framecrc -filter_complex_threads 4 -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_rgba
+fate-filter-overlay_rgba-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-overlay_rgba
+
 FATE_FILTER_VSYNTH-$(CONFIG_PHASE_FILTER) += fate-filter-phase
 fate-filter-phase: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf phase
 
@@ -343,6 +418,10 @@ FATE_FILTER_VSYNTH-$(CONFIG_TRIM_FILTER) += $(FATE_TRIM)
 FATE_FILTER_VSYNTH-$(CONFIG_UNSHARP_FILTER) += fate-filter-unsharp
 fate-filter-unsharp: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf unsharp=11:11:-1.5:11:11:-1.5
 
+FATE_FILTER_VSYNTH-$(CONFIG_UNSHARP_FILTER) += fate-filter-unsharp-threads
+fate-filter-unsharp-threads: CMD = framecrc -filter_threads 4 -c:v pgmyuv -i $(SRC) -vf unsharp=11:11:-1.5:11:11:-1.5
+fate-filter-unsharp-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-unsharp
+
 FATE_FILTER_SAMPLES-$(call ALLYES, SMJPEG_DEMUXER MJPEG_DECODER PERMS_FILTER HQDN3D_FILTER) += fate-filter-hqdn3d-sample
 fate-filter-hqdn3d-sample: tests/data/filtergraphs/hqdn3d
 fate-filter-hqdn3d-sample: CMD = framecrc -idct simple -i $(TARGET_SAMPLES)/smjpeg/scenwin.mjpg -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/hqdn3d -an
@@ -447,6 +526,9 @@ fate-filter-idet: CMD = framecrc -flags bitexact -idct simple -i $(SRC) -vf idet
 FATE_FILTER_VSYNTH-$(CONFIG_PAD_FILTER) += fate-filter-pad
 fate-filter-pad: CMD = video_filter "pad=iw*1.5:ih*1.5:iw*0.3:ih*0.2"
 
+FATE_FILTER_VSYNTH-$(CONFIG_PAD_FILTER) += fate-filter-pad-threads
+fate-filter-pad-threads: CMD = video_filter "pad=iw*1.5:ih*1.5:iw*0.3:ih*0.2" -filter_threads 4
+
 FATE_FILTER_PP = fate-filter-pp fate-filter-pp1 fate-filter-pp2 fate-filter-pp3 fate-filter-pp4 fate-filter-pp5 fate-filter-pp6
 FATE_FILTER_VSYNTH-$(CONFIG_PP_FILTER) += $(FATE_FILTER_PP)
 $(FATE_FILTER_PP): fate-vsynth1-mpeg4-qprd
@@ -600,6 +682,10 @@ fate-filter-pixfmts-kerndeint: CMD = pixfmts "" "tinterlace=interleave_top,"
 FATE_FILTER_PIXFMTS-$(CONFIG_LUT_FILTER) += fate-filter-pixfmts-lut
 fate-filter-pixfmts-lut: CMD = pixfmts "c0=2*val:c1=2*val:c2=val/2:c3=negval+40"
 
+FATE_FILTER_PIXFMTS-$(CONFIG_LUT_FILTER) += fate-filter-pixfmts-lut_threads
+fate-filter-pixfmts-lut_threads: CMD = pixfmts "c0=2*val:c1=2*val:c2=val/2:c3=negval+40" "" 1 "-filter_threads 4"
+fate-filter-pixfmts-lut_threads: REF = $(SRC_PATH)/tests/ref/fate/filter-pixfmts-lut
+
 FATE_FILTER_PIXFMTS-$(CONFIG_NULL_FILTER) += fate-filter-pixfmts-null
 fate-filter-pixfmts-null:  CMD = pixfmts
 
@@ -685,6 +771,13 @@ FATE_METADATA_FILTER-$(call ALLYES, $(AVF_PHASE_METER_DEPS)) += fate-filter-meta
 fate-filter-metadata-avf-aphase-meter-out-of-phase: SRC = $(TARGET_SAMPLES)/filter/out-of-phase-1000hz.flac
 fate-filter-metadata-avf-aphase-meter-out-of-phase: CMD = run $(FILTER_METADATA_COMMAND) "amovie='$(SRC)',aphasemeter=video=0"
 
+SIGNALSTATS_METADATA_DEPS = FFPROBE AVDEVICE LAVFI_INDEV TESTSRC_FILTER FORMAT_FILTER SCALE_FILTER SIGNALSTATS_FILTER
+FATE_METADATA_FILTER_LAVFI-$(call ALLYES, $(SIGNALSTATS_METADATA_DEPS)) += fate-filter-metadata-signalstats-yuv
+fate-filter-metadata-signalstats-yuv: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;testsrc=s=64x64:d=0.2,format=yuv420p,signalstats=stat=tout+vrep+brng"
+
+FATE_METADATA_FILTER_LAVFI-$(call ALLYES, $(SIGNALSTATS_METADATA_DEPS)) += fate-filter-metadata-signalstats-yuv16
+fate-filter-metadata-signalstats-yuv16: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;testsrc=s=64x64:d=0.2,format=yuv420p10,signalstats"
+
 tests/data/file4560-override2rotate0.mov: TAG = GEN
 tests/data/file4560-override2rotate0.mov: ffmpeg$(PROGSSUF)$(EXESUF) | tests/data
 	$(M)$(TARGET_EXEC) $(TARGET_PATH)/$< \
@@ -695,9 +788,10 @@ fate-filter-meta-4560-rotate0: tests/data/file4560-override2rotate0.mov
 fate-filter-meta-4560-rotate0: CMD = framecrc -flags +bitexact -c:a aac_fixed -i $(TARGET_PATH)/tests/data/file4560-override2rotate0.mov
 
 FATE_SAMPLES_FFPROBE += $(FATE_METADATA_FILTER-yes)
+FATE_FFPROBE += $(FATE_METADATA_FILTER_LAVFI-yes)
 FATE_SAMPLES_FFMPEG += $(FATE_FILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_FILTER-yes)
 
 fate-vfilter: $(FATE_FILTER-yes) $(FATE_FILTER_SAMPLES-yes) $(FATE_FILTER_VSYNTH-yes)
 
-fate-filter: fate-afilter fate-vfilter $(FATE_METADATA_FILTER-yes)
+fate-filter: fate-afilter fate-vfilter $(FATE_METADATA_FILTER-yes) $(FATE_METADATA_FILTER_LAVFI-yes)
@@ -222,6 +222,30 @@ $(foreach N,$(HEVC_SAMPLES_422_10BIN),$(eval $(call FATE_HEVC_TEST_422_10BIN,$(N
 $(foreach N,$(HEVC_SAMPLES_444_8BIT),$(eval $(call FATE_HEVC_TEST_444_8BIT,$(N))))
 $(foreach N,$(HEVC_SAMPLES_444_12BIT),$(eval $(call FATE_HEVC_TEST_444_12BIT,$(N))))
 
+# slice threading: pipelined loop filters for slice segments without WPP,
+# one job per CTB row with WPP
+HEVC_SAMPLES_SLICE_THREADS =    \
+    DBLK_A_SONY_3               \
+    DBLK_E_VIXS_2               \
+    DSLICE_A_HHI_5              \
+    ENTP_A_Qualcomm_1           \
+    PICSIZE_A_Bossen_1          \
+    SAO_A_MediaTek_4            \
+    SAO_D_Samsung_5             \
+    SLICES_A_Rovi_3             \
+    STRUCT_B_Samsung_6          \
+    TILES_A_Cisco_2             \
+    TILES_B_Cisco_1             \
+    WPP_B_ericsson_MAIN_2       \
+
+define FATE_HEVC_TEST_SLICE_THREADS
+FATE_HEVC += fate-hevc-conformance-slice-threads-$(1)
+fate-hevc-conformance-slice-threads-$(1): CMD = framecrc -flags unaligned -thread_type slice -threads 4 -vsync drop -i $(TARGET_SAMPLES)/hevc-conformance/$(1).bit
+fate-hevc-conformance-slice-threads-$(1): REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-$(1)
+endef
+
+$(foreach N,$(HEVC_SAMPLES_SLICE_THREADS),$(eval $(call FATE_HEVC_TEST_SLICE_THREADS,$(N))))
+
 fate-hevc-paramchange-yuv420p-yuv420p10: CMD = framecrc -vsync 0 -i $(TARGET_SAMPLES)/hevc/paramchange_yuv420p_yuv420p10.hevc -sws_flags area+accurate_rnd+bitexact
 FATE_HEVC += fate-hevc-paramchange-yuv420p-yuv420p10
 
@@ -1095,4 +1095,14 @@ fate-swr-audioconvert: FUZZ = 0
 
 FATE_SWR += $(FATE_SWR_AUDIOCONVERT-yes)
 FATE_FFMPEG += $(FATE_SWR)
-fate-swr: $(FATE_SWR)
+
+FATE_LIBSWRESAMPLE += fate-swr-low_delay
+fate-swr-low_delay: libswresample/tests/low_delay$(EXESUF)
+fate-swr-low_delay: CMD = run libswresample/tests/low_delay
+
+FATE_LIBSWRESAMPLE += fate-swr-shared_filter
+fate-swr-shared_filter: libswresample/tests/shared_filter$(EXESUF)
+fate-swr-shared_filter: CMD = run libswresample/tests/shared_filter
+
+FATE-$(CONFIG_SWRESAMPLE) += $(FATE_LIBSWRESAMPLE)
+fate-swr: $(FATE_SWR) $(FATE_LIBSWRESAMPLE)
@@ -1,7 +1,23 @@
+FATE_LIBSWSCALE += fate-sws-cache
+fate-sws-cache: libswscale/tests/cache$(EXESUF)
+fate-sws-cache: CMD = run libswscale/tests/cache
+
+FATE_LIBSWSCALE += fate-sws-float-scale
+fate-sws-float-scale: libswscale/tests/float_scale$(EXESUF)
+fate-sws-float-scale: CMD = run libswscale/tests/float_scale
+
+FATE_LIBSWSCALE += fate-sws-gamma
+fate-sws-gamma: libswscale/tests/gamma$(EXESUF)
+fate-sws-gamma: CMD = run libswscale/tests/gamma
+
 FATE_LIBSWSCALE += fate-sws-pixdesc-query
 fate-sws-pixdesc-query: libswscale/tests/pixdesc_query$(EXESUF)
 fate-sws-pixdesc-query: CMD = run libswscale/tests/pixdesc_query
 
+FATE_LIBSWSCALE += fate-sws-threads
+fate-sws-threads: libswscale/tests/threads$(EXESUF)
+fate-sws-threads: CMD = run libswscale/tests/threads
+
 FATE_LIBSWSCALE += $(FATE_LIBSWSCALE-yes)
 FATE-$(CONFIG_SWSCALE) += $(FATE_LIBSWSCALE)
 fate-libswscale: $(FATE_LIBSWSCALE)
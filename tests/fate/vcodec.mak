@@ -456,3 +456,12 @@ fate-vsynth2: $(FATE_VSYNTH2)
 fate-vsynth_lena: $(FATE_VSYNTH_LENA)
 fate-vsynth3: $(FATE_VSYNTH3)
 fate-vcodec:  fate-vsynth1 fate-vsynth_lena fate-vsynth2 fate-vsynth3
+
+# slice threaded encoding inserts a restart marker after each MCU row, the
+# slice threaded decoder splits the scans at these markers
+FATE_MJPEG_SLICE_THREADS-$(call ENCDEC, MJPEG, AVI) += fate-mjpeg-slice-threads
+fate-mjpeg-slice-threads: tests/data/vsynth1.yuv
+fate-mjpeg-slice-threads: CMD = transcode "rawvideo -s 352x288 -pix_fmt yuv420p" tests/data/vsynth1.yuv avi "-c mjpeg -qscale 9 -pix_fmt yuvj420p -threads 4 -thread_type slice"
+fate-mjpeg-slice-threads: THREADS = 4
+fate-mjpeg-slice-threads: THREAD_TYPE = slice
+FATE_AVCONV += $(FATE_MJPEG_SLICE_THREADS-yes)
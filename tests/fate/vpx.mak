@@ -156,6 +156,14 @@ $(eval $(call FATE_VP9_SUITE,trac4359))
 endef
 
 $(eval $(call FATE_VP9_FULL))
+
+# tile threading, with several tile columns in tiling-pedestrian
+VP9_SLICE_THREADS = 00-quantizer-00 00-quantizer-63 03-size-226x226 03-deltaq \
+                    06-bilinear 09-lf_deltas 10-show-existing-frame 16-intra-only \
+                    2pass-akiyo parallelmode-akiyo segmentation-aq-akiyo \
+                    segmentation-sf-akiyo tiling-pedestrian trac3849 trac4359
+$(foreach T,$(VP9_SLICE_THREADS),$(eval $(call FATE_VP9_SUITE,$(T),-slice,-thread_type slice -threads 4)))
+
 FATE_VP9-$(CONFIG_IVF_DEMUXER) += fate-vp9-05-resize
 fate-vp9-05-resize: CMD = framemd5 -i $(TARGET_SAMPLES)/vp9-test-vectors/vp90-2-05-resize.ivf -s 352x288 -sws_flags bitexact+bilinear
 fate-vp9-05-resize: REF = $(SRC_PATH)/tests/ref/fate/vp9-05-resize
@@ -0,0 +1,104 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Compare the cost of attaching side data and metadata to a frame with
+ * separate allocations and with av_frame_alloc_side_data_arena().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "libavutil/common.h"
+#include "libavutil/dict.h"
+#include "libavutil/frame.h"
+#include "libavutil/time.h"
+
+#define NB_SIDE_DATA 4
+#define NB_METADATA  16
+#define ARENA_SIZE   4096
+#define NB_PASSES    5
+
+static const int side_data_size[NB_SIDE_DATA] = { 24, 40, 128, 256 };
+
+static int fill_frame(AVFrame *frame, int arena)
+{
+    char key[32], value[32];
+    int i, ret;
+
+    if (arena && (ret = av_frame_alloc_side_data_arena(frame, ARENA_SIZE)) < 0)
+        return ret;
+
+    for (i = 0; i < NB_SIDE_DATA; i++)
+        if (!av_frame_new_side_data(frame, i, side_data_size[i]))
+            return AVERROR(ENOMEM);
+
+    for (i = 0; i < NB_METADATA; i++) {
+        snprintf(key,   sizeof(key),   "lavfi.bench.key%d", i);
+        snprintf(value, sizeof(value), "%d.%06d", i, i * 7919);
+        if ((ret = av_dict_set(&frame->metadata, key, value, 0)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int64_t run(AVFrame *frame, int arena, int nb_runs)
+{
+    int64_t start = av_gettime_relative();
+    int i;
+
+    for (i = 0; i < nb_runs; i++) {
+        if (fill_frame(frame, arena) < 0) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        av_frame_unref(frame);
+    }
+
+    return av_gettime_relative() - start;
+}
+
+int main(int argc, char **argv)
+{
+    AVFrame *frame = av_frame_alloc();
+    int nb_runs = argc > 1 ? atoi(argv[1]) : 20000;
+    int64_t t_heap, t_arena;
+    int i;
+
+    if (!frame || nb_runs <= 0)
+        return 1;
+
+    /* warm up the allocator, then keep the best of interleaved passes */
+    run(frame, 0, nb_runs / 10 + 1);
+    run(frame, 1, nb_runs / 10 + 1);
+
+    t_heap = t_arena = INT64_MAX;
+    for (i = 0; i < NB_PASSES; i++) {
+        t_heap  = FFMIN(t_heap,  run(frame, 0, nb_runs));
+        t_arena = FFMIN(t_arena, run(frame, 1, nb_runs));
+    }
+
+    printf("%d side data and %d metadata entries per frame, %d frames\n",
+           NB_SIDE_DATA, NB_METADATA, nb_runs);
+    printf("separate allocations: %8.1f ns/frame\n", t_heap  * 1000.0 / nb_runs);
+    printf("arena:                %8.1f ns/frame\n", t_arena * 1000.0 / nb_runs);
+
+    av_frame_free(&frame);
+    return 0;
+}